@@ -0,0 +1,172 @@
+#define _GNU_SOURCE
+/*
+ * adaptive_bench.c - Check every gaps_for_size() table entry against Evolved
+ *
+ * Usage: ./adaptive_bench [perms_dir] [threads] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                         [--verify]
+ *
+ * Each entry of gaps_size_table() (gaps_adaptive.h) is sorted against
+ * Evolved on the same permutations at three sizes of its range: the low
+ * end, the geometric midpoint and 90% of the high end. A size where the
+ * two apply the same gaps is reported as identical. An entry passes when
+ * no size is significantly worse and the pooled relative difference over
+ * its sizes is a significant improvement (paired t-test, p < 0.05).
+ * Improvement is (Evolved - entry) / Evolved, as in full_bench: positive
+ * means the entry makes fewer comparisons.
+ *
+ * Use a seed the tables were not tuned on (they were tuned on generated
+ * trials from 0x5EED0001); the published master seed works:
+ *
+ *   ./adaptive_bench --generate-seed 0xC0FFEE1234 --trials 300
+ *
+ * Exits with status 1 if any entry fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "shellsort.h"
+#include "gaps_adaptive.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "stats.h"
+
+#define SIZES_PER_ENTRY 3
+
+/* Per-trial comparisons of a and b on the same trials */
+static void evaluate_pair(const perm_dataset_t *ds, const gap_sequence_t *a,
+                          const gap_sequence_t *b, const scratch_pool_t *scratch, int threads,
+                          uint64_t *comps_a, uint64_t *comps_b) {
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (uint64_t t = 0; t < ds->trials; t++) {
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
+        comps_a[t] = shellsort(arr, ds->N, a);
+        dataset_copy_trial(ds, t, arr);
+        comps_b[t] = shellsort(arr, ds->N, b);
+    }
+}
+
+/* 1 if a and b apply the same passes on n elements */
+static int same_passes(const gap_sequence_t *a, const gap_sequence_t *b, uint64_t n) {
+    size_t na = 0, nb = 0;
+    while (na < a->num_gaps && a->gaps[na] < n) na++;
+    while (nb < b->num_gaps && b->gaps[nb] < n) nb++;
+    return na == nb && memcmp(a->gaps, b->gaps, na * sizeof(uint64_t)) == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *perms_dir = "results/perms";
+    int threads = 16;
+
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+    if (argc > 1) perms_dir = argv[1];
+    if (argc > 2) threads = atoi(argv[2]);
+    source.perms_dir = perms_dir;
+
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+
+    size_t num_entries;
+    const gaps_table_entry_t *table = gaps_size_table(&num_entries);
+
+    printf("Size-Adaptive Table vs Evolved\n");
+    printf("==============================\n\n");
+    printf("%-12s %-12s | %-10s | %-14s | %-14s | %-10s | %-9s\n",
+           "Entry", "dist", "N", "Entry", "Evolved", "Improv. %", "p");
+    printf("--------------------------|------------|----------------|"
+           "----------------|------------|----------\n");
+
+    int failures = 0;
+    for (size_t e = 0; e < num_entries; e++) {
+        const gaps_table_entry_t *entry = &table[e];
+        dist_t dist = { entry->dist, entry->dist_param };
+        char label[64];
+        dist_label(&dist, label, sizeof(label));
+
+        uint64_t sizes[SIZES_PER_ENTRY] = {
+            entry->min_n,
+            (uint64_t)sqrt((double)entry->min_n * (double)entry->max_n),
+            entry->max_n / 10 * 9,
+        };
+
+        welford_t rel;
+        welford_init(&rel);
+        int worse = 0, compared = 0;
+
+        for (int s = 0; s < SIZES_PER_ENTRY; s++) {
+            uint64_t N = sizes[s];
+            gap_sequence_t tuned, evolved;
+            gaps_table_sequence(&tuned, entry, N);
+            gaps_evolved(&evolved, N);
+
+            if (same_passes(&tuned, &evolved, N)) {
+                printf("%-12s %-12s | %-10lu | %-14s | %-14s | %-10s | %-9s\n",
+                       entry->name, label, (unsigned long)N, "", "", "identical", "");
+                continue;
+            }
+
+            source.dist = dist;
+            perm_dataset_t ds;
+            if (dataset_open(&source, N, ELEM_I32, &ds) < 0) {
+                printf("Failed to load N=%lu\n", (unsigned long)N);
+                failures++;
+                continue;
+            }
+
+            scratch_pool_t scratch;
+            uint64_t *comps_t = malloc(ds.trials * sizeof(uint64_t));
+            uint64_t *comps_e = malloc(ds.trials * sizeof(uint64_t));
+            if (!comps_t || !comps_e ||
+                scratch_pool_init(&scratch, threads, N * sizeof(int32_t)) < 0) {
+                fprintf(stderr, "Error: Out of memory at N=%lu\n", (unsigned long)N);
+                free(comps_t);
+                free(comps_e);
+                free_dataset(&ds);
+                failures++;
+                continue;
+            }
+
+            evaluate_pair(&ds, &tuned, &evolved, &scratch, threads, comps_t, comps_e);
+            paired_result_t pr = paired_test_u64(comps_t, comps_e, ds.trials);
+
+            welford_t ew;
+            welford_init(&ew);
+            for (uint64_t t = 0; t < ds.trials; t++) welford_add(&ew, (double)comps_e[t]);
+            for (uint64_t t = 0; t < ds.trials; t++) {
+                welford_add(&rel, ((double)comps_t[t] - (double)comps_e[t]) / ew.mean);
+            }
+
+            double improvement = -pr.mean_diff / ew.mean * 100.0;
+            printf("%-12s %-12s | %-10lu | %14.2f | %14.2f | %+9.4f%% | %.2e\n",
+                   entry->name, label, (unsigned long)N, ew.mean + pr.mean_diff, ew.mean,
+                   improvement, pr.p_value);
+
+            if (pr.mean_diff > 0 && pr.p_value < 0.05) worse = 1;
+            compared++;
+
+            scratch_pool_free(&scratch);
+            free(comps_t);
+            free(comps_e);
+            free_dataset(&ds);
+        }
+
+        paired_result_t pooled = paired_test_welford(&rel);
+        int pass = !worse && compared > 0 && pooled.mean_diff < 0 && pooled.p_value < 0.05;
+        printf("%-12s %-12s   pooled improvement %+.4f%% (p = %.2e): %s\n\n", entry->name, label,
+               -pooled.mean_diff * 100.0, pooled.p_value, pass ? "PASS" : "FAIL");
+        if (!pass) failures++;
+    }
+
+    printf("%zu entries, %d failed\n", num_entries, failures);
+    return failures ? 1 : 0;
+}
@@ -1,5 +1,16 @@
 /*
  * all_baselines_bench.c - Benchmark evolved vs ALL baselines
+ *
+ * Usage: ./all_baselines_bench [perms_dir] [threads] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                              [--verify] [--trial-major] [--gpu]
+ *
+ * --trial-major has each worker load a trial once and sort it with all seven
+ * sequences while it is in cache, instead of streaming the whole dataset
+ * once per sequence; the means are the same either way.
+ *
+ * --gpu (builds with -DSHELLSORT_GPU, see shellsort_gpu.h) uploads each
+ * size once and scores all seven sequences on the device; the counts are
+ * the ones shellsort() gives, so the tables are unchanged.
  */
 #define _GNU_SOURCE
 #include <stdio.h>
@@ -15,51 +26,102 @@
 #include "rng.h"
 #include "shellsort.h"
 #include "gaps_baselines.h"
+#include "dataset.h"
+#include "scratch.h"
+#ifdef SHELLSORT_GPU
+#include "shellsort_gpu.h"
+#endif
 
-#define MAGIC 0x5045524D47454E31ULL
-
-typedef struct {
-    uint64_t N;
-    uint64_t trials;
-    int32_t *data;
-} perm_dataset_t;
-
-static int load_dataset(const char *dir, uint64_t N, perm_dataset_t *ds) {
-    char path[1024];
-    snprintf(path, sizeof(path), "%s/perm_%lu.bin", dir, (unsigned long)N);
-    FILE *f = fopen(path, "rb");
-    if (!f) return -1;
-    uint64_t magic;
-    fread(&magic, sizeof(magic), 1, f);
-    if (magic != MAGIC) { fclose(f); return -1; }
-    fread(&ds->N, sizeof(ds->N), 1, f);
-    fread(&ds->trials, sizeof(ds->trials), 1, f);
-    uint64_t seed;
-    fread(&seed, sizeof(seed), 1, f);
-    size_t total = ds->trials * ds->N;
-    ds->data = malloc(total * sizeof(int32_t));
-    fread(ds->data, sizeof(int32_t), total, f);
-    fclose(f);
-    return 0;
-}
-
-static double benchmark(const perm_dataset_t *ds, const gap_sequence_t *seq, int threads) {
+static double benchmark(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                        const scratch_pool_t *scratch, int threads) {
     uint64_t total = 0;
     #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:total)
     for (uint64_t t = 0; t < ds->trials; t++) {
-        int32_t *arr = malloc(ds->N * sizeof(int32_t));
-        memcpy(arr, &ds->data[t * ds->N], ds->N * sizeof(int32_t));
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
         total += shellsort(arr, ds->N, seq);
-        free(arr);
     }
     return (double)total / ds->trials;
 }
 
+/* All sequences at once, trial-major: means[i] for seqs[i]. Returns 0, or -1 if out of memory */
+static int benchmark_trial_major(const perm_dataset_t *ds, const gap_sequence_t *seqs,
+                                 int num_seqs, const scratch_pool_t *scratch, int threads,
+                                 double *means) {
+    uint64_t *totals = calloc((size_t)num_seqs, sizeof(uint64_t));
+    if (!totals) {
+        fprintf(stderr, "Error: Failed to allocate totals for N=%lu\n", (unsigned long)ds->N);
+        return -1;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (uint64_t t = 0; t < ds->trials; t++) {
+        int32_t *arr = scratch_get(scratch);
+        const int32_t *src = dataset_load_trial(ds, t, arr + ds->N);
+        for (int i = 0; i < num_seqs; i++) {
+            memcpy(arr, src, ds->N * sizeof(int32_t));
+            uint64_t comps = shellsort(arr, ds->N, &seqs[i]);
+            #pragma omp atomic
+            totals[i] += comps;
+        }
+    }
+
+    for (int i = 0; i < num_seqs; i++) means[i] = (double)totals[i] / ds->trials;
+    free(totals);
+    return 0;
+}
+
+#ifdef SHELLSORT_GPU
+/* All sequences on the GPU: means[i] for seqs[i], or -1 on a device error */
+static int benchmark_gpu(const perm_dataset_t *ds, const gap_sequence_t *seqs, int num_seqs,
+                         double *means) {
+    uint64_t *comps = malloc((size_t)num_seqs * ds->trials * sizeof(uint64_t));
+    gpu_dataset_t *g = comps ? gpu_dataset_upload(ds) : NULL;
+    if (!g || gpu_evaluate(g, seqs, (size_t)num_seqs, comps) < 0) {
+        gpu_dataset_free(g);
+        free(comps);
+        return -1;
+    }
+
+    for (int i = 0; i < num_seqs; i++) {
+        uint64_t total = 0;
+        for (uint64_t t = 0; t < ds->trials; t++) total += comps[(size_t)i * ds->trials + t];
+        means[i] = (double)total / ds->trials;
+    }
+    gpu_dataset_free(g);
+    free(comps);
+    return 0;
+}
+#endif
+
 int main(int argc, char **argv) {
     const char *perms_dir = "results/perms";
     int threads = 16;
+    int trial_major = 0;
+    int use_gpu = 0;
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+    int out = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trial-major") == 0) {
+            trial_major = 1;
+        } else if (strcmp(argv[i], "--gpu") == 0) {
+            use_gpu = 1;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    argc = out;
     if (argc > 1) perms_dir = argv[1];
     if (argc > 2) threads = atoi(argv[2]);
+    source.perms_dir = perms_dir;
+
+#ifndef SHELLSORT_GPU
+    if (use_gpu) {
+        fprintf(stderr, "Error: --gpu needs a build with -DSHELLSORT_GPU (see shellsort_gpu.h)\n");
+        return 1;
+    }
+#endif
     
 #ifdef _OPENMP
     omp_set_num_threads(threads);
@@ -77,10 +139,17 @@ int main(int argc, char **argv) {
     
     for (int s = 0; s < num_sizes; s++) {
         perm_dataset_t ds;
-        if (load_dataset(perms_dir, sizes[s], &ds) < 0) {
+        if (dataset_open(&source, sizes[s], ELEM_I32, &ds) < 0) {
             printf("Failed to load N=%lu\n", sizes[s]);
             continue;
         }
+
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, threads,
+                              sizes[s] * sizeof(int32_t) + dataset_load_scratch(&ds)) < 0) {
+            free_dataset(&ds);
+            continue;
+        }
         
         gap_sequence_t seqs[7];
         gaps_ciura(&seqs[0], sizes[s]);
@@ -92,8 +161,28 @@ int main(int argc, char **argv) {
         gaps_evolved(&seqs[6], sizes[s]);
         
         printf("N = %lu (%lu trials)\n", sizes[s], ds.trials);
-        for (int i = 0; i < 7; i++) {
-            results[i][s] = benchmark(&ds, &seqs[i], threads);
+        if (use_gpu) {
+#ifdef SHELLSORT_GPU
+            double means[7] = {0};
+            if (benchmark_gpu(&ds, seqs, 7, means) < 0) {
+                scratch_pool_free(&scratch);
+                free_dataset(&ds);
+                return 1;
+            }
+            for (int i = 0; i < 7; i++) results[i][s] = means[i];
+#endif
+        } else if (trial_major) {
+            double means[7] = {0};
+            if (benchmark_trial_major(&ds, seqs, 7, &scratch, threads, means) < 0) {
+                scratch_pool_free(&scratch);
+                free_dataset(&ds);
+                return 1;
+            }
+            for (int i = 0; i < 7; i++) results[i][s] = means[i];
+        } else {
+            for (int i = 0; i < 7; i++) {
+                results[i][s] = benchmark(&ds, &seqs[i], &scratch, threads);
+            }
         }
         /* Print after all benchmarks complete so we have evolved result */
         for (int i = 0; i < 7; i++) {
@@ -102,7 +191,8 @@ int main(int argc, char **argv) {
                    names[i], results[i][s], i == 6 ? 0.0 : vs_evolved);
         }
         printf("\n");
-        free(ds.data);
+        scratch_pool_free(&scratch);
+        free_dataset(&ds);
     }
     
     /* Summary table */
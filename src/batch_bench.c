@@ -0,0 +1,191 @@
+#define _GNU_SOURCE
+/*
+ * batch_bench.c - Arrays per second for shellsort_batch() vs one call per array
+ *
+ * Usage: ./batch_bench [--lengths n1,n2,...] [--batches b1,b2,...] [--elements E]
+ *                      [--reps R] [--seed <hex>]
+ *
+ * For every array length, E elements' worth of random permutations
+ * (rng_permutation() trials of the master seed, as permgen would write
+ * them) are sorted with Evolved twice: once with a shellsort() call per
+ * array, and once per batch size with shellsort_batch() over consecutive
+ * groups of that many arrays. Each timing is the best of R runs, with the
+ * inputs restored untimed between runs. The comparison totals of the two
+ * must be equal; the tool exits with status 1 if they ever differ.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "rng.h"
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "cli.h"
+#include "timing.h"
+
+#define MAX_LIST 32
+#define DEFAULT_ELEMENTS (1u << 22)
+#define DEFAULT_REPS 5
+#define DEFAULT_SEED 0xC0FFEE1234ULL
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--lengths n1,n2,...] [--batches b1,b2,...] [--elements E]\n"
+                    "       [--reps R] [--seed <hex>]\n", prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --lengths <list>  Array lengths (default: 16,64,256,1024,4096)\n");
+    fprintf(stderr, "  --batches <list>  Arrays per shellsort_batch() call (default: 1,8,64,1024)\n");
+    fprintf(stderr, "  --elements E      Elements sorted per length and timing (default: %u)\n",
+            DEFAULT_ELEMENTS);
+    fprintf(stderr, "  --reps R          Timed runs per measurement, best kept (default: %d)\n",
+            DEFAULT_REPS);
+    fprintf(stderr, "  --seed <hex>      Master seed of the permutations (default: 0x%llX)\n",
+            (unsigned long long)DEFAULT_SEED);
+}
+
+/* Best-of-reps seconds to sort arrays one shellsort() call at a time */
+static double time_per_call(int32_t *const *arrays, const int32_t *input, size_t n,
+                            size_t count, const gap_sequence_t *seq, int reps,
+                            uint64_t *comparisons) {
+    double best = 0;
+    for (int r = 0; r < reps; r++) {
+        memcpy(arrays[0], input, count * n * sizeof(int32_t));
+        uint64_t total = 0;
+        double t0 = timing_wall_seconds();
+        for (size_t k = 0; k < count; k++) {
+            total += shellsort(arrays[k], n, seq);
+        }
+        double dt = timing_wall_seconds() - t0;
+        if (r == 0 || dt < best) best = dt;
+        *comparisons = total;
+    }
+    return best;
+}
+
+/* Best-of-reps seconds to sort arrays batch at a time with shellsort_batch() */
+static double time_batched(int32_t *const *arrays, const size_t *lengths, const int32_t *input,
+                           size_t n, size_t count, size_t batch, const gap_sequence_t *seq,
+                           int reps, uint64_t *comparisons) {
+    double best = 0;
+    for (int r = 0; r < reps; r++) {
+        memcpy(arrays[0], input, count * n * sizeof(int32_t));
+        uint64_t total = 0;
+        double t0 = timing_wall_seconds();
+        for (size_t k = 0; k < count; k += batch) {
+            size_t len = count - k < batch ? count - k : batch;
+            total += shellsort_batch(arrays + k, lengths + k, len, seq);
+        }
+        double dt = timing_wall_seconds() - t0;
+        if (r == 0 || dt < best) best = dt;
+        *comparisons = total;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    uint64_t lengths_list[MAX_LIST] = {16, 64, 256, 1024, 4096};
+    size_t num_lengths = 5;
+    uint64_t batches[MAX_LIST] = {1, 8, 64, 1024};
+    size_t num_batches = 4;
+    uint64_t elements = DEFAULT_ELEMENTS;
+    int reps = DEFAULT_REPS;
+    uint64_t seed = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lengths") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 1, lengths_list, MAX_LIST, &num_lengths) < 0) {
+                fprintf(stderr, "Error: Invalid lengths list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--batches") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 1, batches, MAX_LIST, &num_batches) < 0) {
+                fprintf(stderr, "Error: Invalid batches list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--elements") == 0 && i + 1 < argc) {
+            elements = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 16);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (elements == 0 || reps < 1) {
+        fprintf(stderr, "Error: --elements and --reps must be positive\n");
+        return 1;
+    }
+
+    printf("Shellsort Batch Benchmark\n");
+    printf("=========================\n");
+    printf("SIMD lanes: %d\n", shellsort_simd_lanes());
+    printf("Master seed: 0x%lX, %lu elements per length, best of %d\n\n",
+           (unsigned long)seed, (unsigned long)elements, reps);
+    printf("%-8s %-8s | %14s | %14s | %8s\n", "N", "batch", "per-call arr/s", "batch arr/s",
+           "speedup");
+    printf("------------------|----------------|----------------|---------\n");
+
+    int mismatches = 0;
+    for (size_t li = 0; li < num_lengths; li++) {
+        size_t n = (size_t)lengths_list[li];
+        size_t count = (size_t)((elements + n - 1) / n);
+
+        int32_t *input = malloc(count * n * sizeof(int32_t));
+        int32_t *data = malloc(count * n * sizeof(int32_t));
+        int32_t **arrays = malloc(count * sizeof(int32_t *));
+        size_t *lengths = malloc(count * sizeof(size_t));
+        if (!input || !data || !arrays || !lengths) {
+            fprintf(stderr, "Error: Out of memory at N=%zu\n", n);
+            free(input);
+            free(data);
+            free(arrays);
+            free(lengths);
+            return 1;
+        }
+
+        for (size_t k = 0; k < count; k++) {
+            rng_permutation(input + k * n, n, seed, k);
+            arrays[k] = data + k * n;
+            lengths[k] = n;
+        }
+
+        gap_sequence_t seq;
+        gaps_evolved(&seq, n);
+
+        uint64_t ref_comps;
+        double t_call = time_per_call(arrays, input, n, count, &seq, reps, &ref_comps);
+        double call_rate = (double)count / t_call;
+
+        for (size_t bi = 0; bi < num_batches; bi++) {
+            uint64_t comps;
+            double t_batch = time_batched(arrays, lengths, input, n, count, (size_t)batches[bi],
+                                          &seq, reps, &comps);
+            double batch_rate = (double)count / t_batch;
+            printf("%-8zu %-8lu | %14.0f | %14.0f | %7.2fx%s\n", n, (unsigned long)batches[bi],
+                   call_rate, batch_rate, batch_rate / call_rate,
+                   comps == ref_comps ? "" : "  COUNT MISMATCH");
+            if (comps != ref_comps) mismatches++;
+        }
+
+        free(input);
+        free(data);
+        free(arrays);
+        free(lengths);
+    }
+
+    if (mismatches) {
+        fprintf(stderr, "Error: %d batch runs counted differently from shellsort()\n",
+                mismatches);
+        return 1;
+    }
+    return 0;
+}
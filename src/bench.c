@@ -3,9 +3,48 @@
  * bench.c - Benchmark harness for Shellsort gap sequences
  *
  * Runs all sequences against pre-generated permutation datasets.
- * Uses OpenMP for parallelization over trials.
+ * Uses OpenMP for parallelization over every (sequence, trial) pair of a
+ * size at once (see benchmark_size()).
  *
- * Usage: ./bench --perms <dir> --out <dir> [--threads N]
+ * Usage: ./bench --perms <dir> --out <dir> [--threads N] [--kernel counting|fast|simd|blocked|fixed|parallel]
+ *        [--type i32|i64|u32|f32|f64|kv] [--layout aos|soa]
+ *        [--generate-seed <hex> --sizes n1,n2,... [--trials T] [--rng-scheme v1|v2]]
+ *        [--per-pass [--perf]] [--dist <mode>[,<mode>...]] [--verify] [--trial-major]
+ *        [--engine insertion|binary|network[:<max gap>]]
+ *        [--telemetry <file>[.prom] [--telemetry-interval S]]
+ *
+ * With --generate-seed no dataset files are read: each worker rebuilds trial
+ * t in its own buffer with the same derivation permgen uses, so results are
+ * identical to running against permgen output for that seed.
+ *
+ * --per-pass adds a second, untimed shellsort_pass_stats() run of every
+ * trial and writes bench_<timestamp>_passes.csv with the mean comparisons,
+ * moves, cycles and (with --perf) cache and branch misses of each gap.
+ *
+ * --dist runs every size once per input distribution (dist.h), reading
+ * the matching permgen --dist files or generating them, and tags each
+ * row with a dist column.
+ *
+ * --verify checks every trial against the dataset's .sum digests the first
+ * time a worker copies it, outside the timed region, and stops on a
+ * mismatch instead of reporting counts from corrupt data.
+ *
+ * --trial-major reads each trial once per size instead of once per
+ * sequence (see benchmark_size()); use it at large N, where every pass
+ * over the dataset comes from DRAM.
+ *
+ * --engine swaps the algorithm of the small-gap passes (pass_engine_t in
+ * shellsort.h); comparisons and moves are still counted, and each row
+ * records the engine used.
+ *
+ * --kernel parallel times single-array latency instead of throughput:
+ * trials run one after another, each sorted by shellsort_parallel_stats()
+ * on all --threads threads.
+ *
+ * --telemetry publishes live progress (telemetry.h) while sizes run:
+ * sorts done, comparison and sort rates, bytes loaded, per-thread
+ * utilization and the ETA of the dataset in progress, as text or, for a
+ * .prom path, Prometheus text exposition.
  */
 
 #include <stdio.h>
@@ -26,26 +65,62 @@
 #include "rng.h"
 #include "shellsort.h"
 #include "gaps_baselines.h"
+#include "dataset.h"
+#include "stats.h"
+#include "scratch.h"
+#include "telemetry.h"
+#include "cli.h"
+#include "timing.h"
 
-#define MAGIC 0x5045524D47454E31ULL
 #define MAX_SIZES 32
 #define MAX_SEQUENCES 64
+#define MAX_DISTS 16
+
+/* Baselines plus the Evolved sequence */
+#define NUM_BENCH_SEQS (NUM_BASELINES + 1)
+
+/* Which kernel the timed region runs */
+typedef enum {
+    KERNEL_COUNTING,         /* shellsort_stats(): counts as it sorts */
+    KERNEL_FAST,             /* shellsort_fast(): counts from a separate untimed run */
+    KERNEL_SIMD,             /* shellsort_simd_stats(): vector kernel, exact counts */
+    KERNEL_BLOCKED,          /* shellsort_blocked_stats(): L2-tiled large gaps, exact counts */
+    KERNEL_FIXED,            /* shellsort_<seq>(): compile-time gaps, counts from untimed run */
+    KERNEL_PARALLEL          /* shellsort_parallel_stats(): one trial at a time on all threads */
+} bench_kernel_t;
+
+static const char *kernel_name(bench_kernel_t k) {
+    switch (k) {
+        case KERNEL_COUNTING: return "counting";
+        case KERNEL_FAST:     return "fast";
+        case KERNEL_SIMD:     return "simd";
+        case KERNEL_BLOCKED:  return "blocked";
+        case KERNEL_FIXED:    return "fixed";
+        case KERNEL_PARALLEL: return "parallel";
+    }
+    return "unknown";
+}
 
 typedef struct {
     char perms_dir[512];
     char out_dir[512];
     int threads;
+    bench_kernel_t kernel;
+    elem_type_t elem_type;   /* Dataset element type (perm_<N>_<type>.bin) */
+    int kv_soa;              /* ELEM_KV: sort as struct-of-arrays */
+    dataset_source_t source; /* perms_dir or --generate-seed */
     uint64_t sizes[MAX_SIZES];
     size_t num_sizes;
+    int per_pass;            /* Also write the per-gap breakdown */
+    int perf;                /* Per-pass hardware counters via perf_event_open */
+    int trial_major;         /* Load each trial once and run every sequence on it */
+    pass_engine_t engine;    /* Per-gap pass algorithms (counting and fast kernels) */
+    dist_t dists[MAX_DISTS]; /* Input distributions, each run separately */
+    size_t num_dists;
+    char telemetry_path[1024]; /* Live status file, "" = off */
+    double telemetry_interval; /* Seconds between status writes */
 } config_t;
 
-typedef struct {
-    uint64_t N;
-    uint64_t trials;
-    uint64_t master_seed;
-    int32_t *data;  /* trials * N elements */
-} perm_dataset_t;
-
 typedef struct {
     char sequence_name[64];
     uint64_t N;
@@ -67,7 +142,13 @@ typedef struct {
 } bench_result_t;
 
 static void print_usage(const char *prog) {
-    fprintf(stderr, "Usage: %s --perms <dir> --out <dir> [--threads N] [--sizes n1,n2,...]\n", prog);
+    fprintf(stderr, "Usage: %s --perms <dir> --out <dir> [--threads N] [--sizes n1,n2,...]\n"
+                    "       [--kernel counting|fast|simd|blocked|fixed|parallel]\n"
+                    "       [--type i32|i64|u32|f32|f64|kv] [--layout aos|soa]\n"
+                    "       [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]\n"
+                    "       [--per-pass [--perf]] [--dist <mode>[,<mode>...]] [--verify]\n"
+                    "       [--trial-major] [--engine insertion|binary|network[:<max gap>]]\n",
+            prog);
     fprintf(stderr, "\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  --perms <dir>     Directory containing permutation files\n");
@@ -75,18 +156,56 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  --threads N       Number of OpenMP threads (default: all)\n");
     fprintf(stderr, "  --sizes <list>    Comma-separated list of N values to benchmark\n");
     fprintf(stderr, "                    (default: auto-detect from perms dir)\n");
+    fprintf(stderr, "  --kernel <name>   Kernel to time: counting (default), fast, simd\n");
+    fprintf(stderr, "                    blocked, fixed or parallel\n");
+    fprintf(stderr, "                    (fast/fixed time the uninstrumented kernel; counts\n");
+    fprintf(stderr, "                    still come from an untimed shellsort_stats() run.\n");
+    fprintf(stderr, "                    fixed skips sequences without a specialized kernel;\n");
+    fprintf(stderr, "                    parallel sorts one trial at a time on every thread)\n");
+    fprintf(stderr, "  --type <name>     Element type of the dataset (default: i32); other\n");
+    fprintf(stderr, "                    types read perm_<N>_<type>.bin, counting kernel only\n");
+    fprintf(stderr, "  --layout <name>   Record layout for --type kv: aos (default) or soa\n");
+    fprintf(stderr, "  --generate-seed <hex>\n");
+    fprintf(stderr, "                    Rebuild permutations from this master seed instead of\n");
+    fprintf(stderr, "                    reading --perms (requires --sizes)\n");
+    fprintf(stderr, "  --trials T        Trials per size with --generate-seed (default: %d)\n",
+            DATASET_DEFAULT_TRIALS);
+    fprintf(stderr, "  --rng-scheme <v>  Permutation stream for --generate-seed: v1 (default,\n");
+    fprintf(stderr, "                    matches permgen files) or v2 (faster, see rng.h)\n");
+    fprintf(stderr, "  --per-pass        Also write per-gap comparisons, moves and cycles to\n");
+    fprintf(stderr, "                    bench_<timestamp>_passes.csv (extra untimed run, i32)\n");
+    fprintf(stderr, "  --perf            With --per-pass, add cache and branch misses per gap\n");
+    fprintf(stderr, "                    (perf_event_open; 0 where unavailable)\n");
+    fprintf(stderr, "  --dist <list>     Input distributions to run, comma-separated (default:\n");
+    fprintf(stderr, "                    uniform): uniform, sorted[:f], swaps[:k], runs[:r],\n");
+    fprintf(stderr, "                    reversed, organ-pipe, dups[:k], zipf[:s] (see permgen)\n");
+    fprintf(stderr, "  --verify          Check each trial against the permgen .sum digests as\n");
+    fprintf(stderr, "                    it is first loaded; stop on a corrupt trial\n");
+    fprintf(stderr, "  --trial-major     Load each trial once and run every sequence on it while\n");
+    fprintf(stderr, "                    it is in cache, instead of one sequence at a time\n");
+    fprintf(stderr, "  --engine <e>[:G]  Algorithm for passes with gap <= G (default 1): insertion\n");
+    fprintf(stderr, "                    (default), binary (galloping binary insertion) or network\n");
+    fprintf(stderr, "                    (8-element min/max networks, then insertion); i32,\n");
+    fprintf(stderr, "                    counting or fast kernel\n");
+    fprintf(stderr, "  --telemetry <file> Write live progress to file every few seconds (text,\n");
+    fprintf(stderr, "                    or Prometheus text exposition for a .prom path)\n");
+    fprintf(stderr, "  --telemetry-interval S\n");
+    fprintf(stderr, "                    Seconds between telemetry writes (default: %.0f)\n",
+            TELEMETRY_DEFAULT_INTERVAL);
 }
 
-static int parse_uint64_list(const char *str, uint64_t *out, size_t max, size_t *count) {
+static int parse_dist_list(const char *str, dist_t *out, size_t max, size_t *count) {
     *count = 0;
     char *copy = strdup(str);
     if (!copy) return -1;
 
-    char *tok = strtok(copy, ",");
-    while (tok && *count < max) {
-        out[*count] = strtoull(tok, NULL, 0);
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        if (*count >= max || dist_parse(tok, &out[*count]) < 0) {
+            fprintf(stderr, "Error: Invalid distribution '%s'\n", tok);
+            free(copy);
+            return -1;
+        }
         (*count)++;
-        tok = strtok(NULL, ",");
     }
 
     free(copy);
@@ -95,6 +214,7 @@ static int parse_uint64_list(const char *str, uint64_t *out, size_t max, size_t
 
 static int parse_args(int argc, char **argv, config_t *cfg) {
     memset(cfg, 0, sizeof(*cfg));
+    cfg->engine = pass_engine_default();
     cfg->threads = 0;  /* 0 = use all available */
 
     for (int i = 1; i < argc; i++) {
@@ -105,10 +225,74 @@ static int parse_args(int argc, char **argv, config_t *cfg) {
         } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
             cfg->threads = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
-            if (parse_uint64_list(argv[++i], cfg->sizes, MAX_SIZES, &cfg->num_sizes) < 0) {
+            if (parse_uint64_list(argv[++i], 2, cfg->sizes, MAX_SIZES, &cfg->num_sizes) < 0) {
                 fprintf(stderr, "Error: Invalid sizes list\n");
                 return -1;
             }
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            const char *k = argv[++i];
+            if (strcmp(k, "counting") == 0) {
+                cfg->kernel = KERNEL_COUNTING;
+            } else if (strcmp(k, "fast") == 0) {
+                cfg->kernel = KERNEL_FAST;
+            } else if (strcmp(k, "simd") == 0) {
+                cfg->kernel = KERNEL_SIMD;
+            } else if (strcmp(k, "blocked") == 0) {
+                cfg->kernel = KERNEL_BLOCKED;
+            } else if (strcmp(k, "fixed") == 0) {
+                cfg->kernel = KERNEL_FIXED;
+            } else if (strcmp(k, "parallel") == 0) {
+                cfg->kernel = KERNEL_PARALLEL;
+            } else {
+                fprintf(stderr, "Error: Unknown kernel '%s'\n", k);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            if (elem_type_parse(argv[++i], &cfg->elem_type) < 0) {
+                fprintf(stderr, "Error: Unknown element type '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            const char *l = argv[++i];
+            if (strcmp(l, "aos") == 0) {
+                cfg->kv_soa = 0;
+            } else if (strcmp(l, "soa") == 0) {
+                cfg->kv_soa = 1;
+            } else {
+                fprintf(stderr, "Error: Unknown layout '%s'\n", l);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--generate-seed") == 0 && i + 1 < argc) {
+            cfg->source.generate = 1;
+            cfg->source.seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            cfg->source.trials = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--rng-scheme") == 0 && i + 1 < argc) {
+            if ((cfg->source.rng_scheme = rng_scheme_parse(argv[++i])) < 0) {
+                fprintf(stderr, "Error: Unknown RNG scheme '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--per-pass") == 0) {
+            cfg->per_pass = 1;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            cfg->perf = 1;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            cfg->source.verify = 1;
+        } else if (strcmp(argv[i], "--trial-major") == 0) {
+            cfg->trial_major = 1;
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            if (pass_engine_parse(argv[++i], &cfg->engine) < 0) {
+                fprintf(stderr, "Error: Unknown pass engine '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            strncpy(cfg->telemetry_path, argv[++i], sizeof(cfg->telemetry_path) - 1);
+        } else if (strcmp(argv[i], "--telemetry-interval") == 0 && i + 1 < argc) {
+            cfg->telemetry_interval = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+            if (parse_dist_list(argv[++i], cfg->dists, MAX_DISTS, &cfg->num_dists) < 0) {
+                return -1;
+            }
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             print_usage(argv[0]);
             exit(0);
@@ -118,179 +302,375 @@ static int parse_args(int argc, char **argv, config_t *cfg) {
         }
     }
 
-    if (cfg->perms_dir[0] == '\0' || cfg->out_dir[0] == '\0') {
-        fprintf(stderr, "Error: --perms and --out are required\n");
+    if ((cfg->perms_dir[0] == '\0' && !cfg->source.generate) || cfg->out_dir[0] == '\0') {
+        fprintf(stderr, "Error: --out and one of --perms or --generate-seed are required\n");
         return -1;
     }
 
-    return 0;
-}
-
-static int load_dataset(const char *perms_dir, uint64_t N, perm_dataset_t *ds) {
-    char path[1024];
-    snprintf(path, sizeof(path), "%s/perm_%lu.bin", perms_dir, (unsigned long)N);
-
-    FILE *f = fopen(path, "rb");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+    if (cfg->source.generate && cfg->num_sizes == 0) {
+        fprintf(stderr, "Error: --generate-seed requires --sizes\n");
         return -1;
     }
 
-    /* Read header */
-    uint64_t magic;
-    if (fread(&magic, sizeof(magic), 1, f) != 1 || magic != MAGIC) {
-        fprintf(stderr, "Error: Invalid magic in %s\n", path);
-        fclose(f);
-        return -1;
+    cfg->source.perms_dir = cfg->perms_dir;
+    if (cfg->source.trials == 0) cfg->source.trials = DATASET_DEFAULT_TRIALS;
+    if (cfg->source.generate && cfg->source.rng_scheme == 0) {
+        cfg->source.rng_scheme = RNG_SCHEME_V1;
+    }
+    if (cfg->num_dists == 0) {
+        cfg->dists[0] = dist_uniform();
+        cfg->num_dists = 1;
     }
 
-    if (fread(&ds->N, sizeof(ds->N), 1, f) != 1 ||
-        fread(&ds->trials, sizeof(ds->trials), 1, f) != 1 ||
-        fread(&ds->master_seed, sizeof(ds->master_seed), 1, f) != 1) {
-        fprintf(stderr, "Error: Failed to read header from %s\n", path);
-        fclose(f);
+    if (cfg->elem_type != ELEM_I32 && cfg->kernel != KERNEL_COUNTING) {
+        fprintf(stderr, "Error: --type %s only supports --kernel counting\n",
+                elem_type_name(cfg->elem_type));
         return -1;
     }
 
-    if (ds->N != N) {
-        fprintf(stderr, "Error: N mismatch in %s (expected %lu, got %lu)\n",
-                path, (unsigned long)N, (unsigned long)ds->N);
-        fclose(f);
+    if (cfg->engine.small != PASS_INSERTION &&
+        (cfg->elem_type != ELEM_I32 ||
+         (cfg->kernel != KERNEL_COUNTING && cfg->kernel != KERNEL_FAST) || cfg->per_pass)) {
+        fprintf(stderr, "Error: --engine requires --type i32, --kernel counting or fast, "
+                "and no --per-pass\n");
         return -1;
     }
 
-    /* Allocate and read data */
-    size_t total = ds->trials * ds->N;
-    ds->data = malloc(total * sizeof(int32_t));
-    if (!ds->data) {
-        fprintf(stderr, "Error: Failed to allocate %zu bytes for dataset\n",
-                total * sizeof(int32_t));
-        fclose(f);
+    if (cfg->per_pass && cfg->elem_type != ELEM_I32) {
+        fprintf(stderr, "Error: --per-pass only supports --type i32\n");
         return -1;
     }
-
-    if (fread(ds->data, sizeof(int32_t), total, f) != total) {
-        fprintf(stderr, "Error: Failed to read data from %s\n", path);
-        free(ds->data);
-        fclose(f);
+    if (cfg->perf && !cfg->per_pass) {
+        fprintf(stderr, "Error: --perf requires --per-pass\n");
         return -1;
     }
 
-    fclose(f);
     return 0;
 }
 
-static void free_dataset(perm_dataset_t *ds) {
-    free(ds->data);
-    ds->data = NULL;
+/* Element-type label for output: the type name, or kv-aos / kv-soa */
+static const char *layout_name(const config_t *cfg) {
+    if (cfg->elem_type == ELEM_KV) return cfg->kv_soa ? "kv-soa" : "kv-aos";
+    return elem_type_name(cfg->elem_type);
 }
 
-static void benchmark_sequence(const perm_dataset_t *ds, const gap_sequence_t *seq,
-                               bench_result_t *result, int num_threads) {
+/*
+ * Copy a loaded non-int32 trial (src) into buf (N elements) and sort it
+ * with the typed counting kernel. Returns the sort time in microseconds.
+ */
+static double typed_trial(const perm_dataset_t *ds, const void *src, void *buf,
+                          const gap_sequence_t *seq, int kv_soa, sort_stats_t *stats) {
     uint64_t N = ds->N;
-    uint64_t trials = ds->trials;
+    double t_start;
+
+    if (ds->elem_type == ELEM_KV && kv_soa) {
+        /* Split records into keys[] and values[] outside the timed region */
+        const kv_pair_t *kv = src;
+        int64_t *keys = buf;
+        uint64_t *values = (uint64_t *)(keys + N);
+        for (uint64_t i = 0; i < N; i++) {
+            keys[i] = kv[i].key;
+            values[i] = kv[i].value;
+        }
+        t_start = timing_wall_seconds();
+        *stats = shellsort_kv_soa_stats(keys, values, N, seq);
+        return (timing_wall_seconds() - t_start) * 1e6;
+    }
 
-    strncpy(result->sequence_name, seq->name, sizeof(result->sequence_name) - 1);
-    result->N = N;
-    result->trials = trials;
+    memcpy(buf, src, N * ds->elem_size);
+    t_start = timing_wall_seconds();
 
-    /* Allocate per-trial statistics */
-    uint64_t *comp_counts = malloc(trials * sizeof(uint64_t));
-    uint64_t *move_counts = malloc(trials * sizeof(uint64_t));
-    double *runtimes_us = malloc(trials * sizeof(double));
-    if (!comp_counts || !move_counts || !runtimes_us) {
-        fprintf(stderr, "Error: Failed to allocate arrays\n");
-        free(comp_counts);
-        free(move_counts);
-        free(runtimes_us);
-        return;
+    switch (ds->elem_type) {
+        case ELEM_I64: *stats = shellsort_typed_stats((int64_t *)buf, N, seq); break;
+        case ELEM_U32: *stats = shellsort_typed_stats((uint32_t *)buf, N, seq); break;
+        case ELEM_F32: *stats = shellsort_typed_stats((float *)buf, N, seq); break;
+        case ELEM_F64: *stats = shellsort_typed_stats((double *)buf, N, seq); break;
+        case ELEM_KV:  *stats = shellsort_typed_stats((kv_pair_t *)buf, N, seq); break;
+        default:       *stats = shellsort_typed_stats((int32_t *)buf, N, seq); break;
     }
 
-    /* Parallel loop over trials with per-trial timing */
-    #pragma omp parallel for schedule(static) num_threads(num_threads)
-    for (uint64_t t = 0; t < trials; t++) {
-        /* Copy permutation to local array */
-        int32_t *arr = malloc(N * sizeof(int32_t));
-        if (!arr) continue;
+    return (timing_wall_seconds() - t_start) * 1e6;
+}
 
-        memcpy(arr, &ds->data[t * N], N * sizeof(int32_t));
+/* Per-trial samples of one sequence, filled by benchmark_size() */
+typedef struct {
+    uint64_t *comp_counts;
+    uint64_t *move_counts;
+    double *runtimes_us;
+} trial_samples_t;
 
-#ifdef _OPENMP
-        double t_start = omp_get_wtime();
-#else
-        clock_t t_start = clock();
-#endif
+/*
+ * Sort trial t (already loaded at src, see dataset_load_trial()) with seq
+ * in buf, timing only the kernel, and record its counts and runtime in
+ * slot t of out. src is left untouched so the next sequence can reuse it.
+ */
+static void run_trial(const perm_dataset_t *ds, uint64_t t, const void *src, void *buf,
+                      const gap_sequence_t *seq, const fixed_kernel_t *fixed,
+                      bench_kernel_t kernel, const pass_engine_t *engine, int kv_soa,
+                      int sort_threads, const trial_samples_t *out) {
+    uint64_t N = ds->N;
+    sort_stats_t stats;
 
-        /* Sort and collect stats */
-        sort_stats_t stats = shellsort_stats(arr, N, seq);
+    if (ds->elem_type != ELEM_I32) {
+        out->runtimes_us[t] = typed_trial(ds, src, buf, seq, kv_soa, &stats);
+        out->comp_counts[t] = stats.comparisons;
+        out->move_counts[t] = stats.moves;
+        return;
+    }
 
-#ifdef _OPENMP
-        runtimes_us[t] = (omp_get_wtime() - t_start) * 1e6;
-#else
-        runtimes_us[t] = (double)(clock() - t_start) / CLOCKS_PER_SEC * 1e6;
-#endif
+    /* Copy the permutation into this thread's scratch buffer */
+    int32_t *arr = buf;
+    memcpy(arr, src, N * sizeof(int32_t));
+
+    double t_start = timing_wall_seconds();
 
-        comp_counts[t] = stats.comparisons;
-        move_counts[t] = stats.moves;
+    if (engine) {
+        /* Non-default pass engine (counting or fast kernel) */
+        if (kernel == KERNEL_COUNTING) {
+            stats = shellsort_engine_stats(arr, N, seq, engine);
+            out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+        } else {
+            shellsort_engine(arr, N, seq, engine);
+            out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+            memcpy(arr, src, N * sizeof(int32_t));
+            stats = shellsort_engine_stats(arr, N, seq, engine);
+        }
+    } else if (kernel == KERNEL_COUNTING) {
+        /* Sort and collect stats */
+        stats = shellsort_stats(arr, N, seq);
+        out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+    } else if (kernel == KERNEL_SIMD) {
+        stats = shellsort_simd_stats(arr, N, seq);
+        out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+    } else if (kernel == KERNEL_BLOCKED) {
+        stats = shellsort_blocked_stats(arr, N, seq, 0);
+        out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+    } else if (kernel == KERNEL_PARALLEL) {
+        stats = shellsort_parallel_stats(arr, N, seq, sort_threads);
+        out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
+    } else {
+        if (kernel == KERNEL_FIXED) {
+            fixed->sort(arr, N);
+        } else {
+            shellsort_fast(arr, N, seq);
+        }
+        out->runtimes_us[t] = (timing_wall_seconds() - t_start) * 1e6;
 
-        free(arr);
+        /* Same trial again, untimed, for the comparison/move columns */
+        memcpy(arr, src, N * sizeof(int32_t));
+        stats = shellsort_stats(arr, N, seq);
     }
 
-    /* Compute comparison statistics */
-    result->total_comparisons = 0;
-    result->min_comparisons = (double)comp_counts[0];
-    result->max_comparisons = (double)comp_counts[0];
+    out->comp_counts[t] = stats.comparisons;
+    out->move_counts[t] = stats.moves;
+}
+
+/* Reduce one sequence's per-trial samples (in trial order) into result */
+static void reduce_samples(const gap_sequence_t *seq, uint64_t N, uint64_t trials,
+                           const trial_samples_t *samples, bench_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    strncpy(result->sequence_name, seq->name, sizeof(result->sequence_name) - 1);
+    result->N = N;
+    result->trials = trials;
+
+    /* Compute statistics (sample variance, see stats.h) */
+    welford_t comp_w, move_w, time_w;
+    welford_init(&comp_w);
+    welford_init(&move_w);
+    welford_init(&time_w);
 
     for (uint64_t t = 0; t < trials; t++) {
-        result->total_comparisons += comp_counts[t];
-        if ((double)comp_counts[t] < result->min_comparisons) result->min_comparisons = (double)comp_counts[t];
-        if ((double)comp_counts[t] > result->max_comparisons) result->max_comparisons = (double)comp_counts[t];
+        result->total_comparisons += samples->comp_counts[t];
+        result->total_moves += samples->move_counts[t];
+        welford_add(&comp_w, (double)samples->comp_counts[t]);
+        welford_add(&move_w, (double)samples->move_counts[t]);
+        welford_add(&time_w, samples->runtimes_us[t]);
     }
 
     result->mean_comparisons = (double)result->total_comparisons / (double)trials;
+    result->stddev = welford_stddev(&comp_w);
+    result->stderr_val = welford_stderr(&comp_w);
+    result->min_comparisons = comp_w.min;
+    result->max_comparisons = comp_w.max;
 
-    /* Compute comparison stddev */
-    double sum_sq = 0;
-    for (uint64_t t = 0; t < trials; t++) {
-        double diff = (double)comp_counts[t] - result->mean_comparisons;
-        sum_sq += diff * diff;
-    }
-    result->stddev = sqrt(sum_sq / (double)trials);
-    result->stderr_val = result->stddev / sqrt((double)trials);
+    result->mean_moves = (double)result->total_moves / (double)trials;
+    result->moves_stddev = welford_stddev(&move_w);
 
-    /* Compute move statistics */
-    result->total_moves = 0;
-    for (uint64_t t = 0; t < trials; t++) {
-        result->total_moves += move_counts[t];
+    result->mean_runtime_us = time_w.mean;
+    result->runtime_stddev_us = welford_stddev(&time_w);
+    result->runtime_stderr_us = welford_stderr(&time_w);
+}
+
+/*
+ * Benchmark every sequence in seqs[0..num_seqs) on ds in a single parallel
+ * region. The (sequence, trial) pairs form one flat task list handed out
+ * with schedule(dynamic, 1), so threads that finish a cheap sequence move
+ * straight on to the next one instead of waiting at a per-sequence
+ * barrier, and small sizes with few trials still keep every core busy.
+ * Samples land in per-sequence slots and are reduced in trial order, so
+ * the counts are the same as running the sequences one at a time.
+ *
+ * With trial_major a task is a whole trial instead: it is loaded once and
+ * sorted by every sequence in turn while it is still in cache, so the
+ * dataset is streamed from memory (or decoded / regenerated) once rather
+ * than once per sequence. Counts are identical either way.
+ *
+ * The parallel kernel runs the tasks one at a time instead, and each sort
+ * uses all num_threads threads.
+ *
+ * Each scratch buffer holds N elements to sort followed by
+ * dataset_load_scratch() bytes for the loaded trial.
+ *
+ * Every finished task is added to the calling thread's telemetry slot
+ * (tel may be NULL).
+ *
+ * Returns 0, or -1 if the sample arrays cannot be allocated.
+ */
+static int benchmark_size(const perm_dataset_t *ds, const gap_sequence_t *const *seqs,
+                          size_t num_seqs, const scratch_pool_t *scratch, bench_kernel_t kernel,
+                          const pass_engine_t *engine, int kv_soa, int trial_major,
+                          bench_result_t *results, int num_threads, telemetry_t *tel) {
+    uint64_t trials = ds->trials;
+    uint64_t tasks = (uint64_t)num_seqs * trials;
+
+    uint64_t *comp_counts = malloc((tasks ? tasks : 1) * sizeof(uint64_t));
+    uint64_t *move_counts = malloc((tasks ? tasks : 1) * sizeof(uint64_t));
+    double *runtimes_us = malloc((tasks ? tasks : 1) * sizeof(double));
+    trial_samples_t *samples = malloc((num_seqs ? num_seqs : 1) * sizeof(trial_samples_t));
+    const fixed_kernel_t **fixed = malloc((num_seqs ? num_seqs : 1) * sizeof(*fixed));
+    if (!comp_counts || !move_counts || !runtimes_us || !samples || !fixed) {
+        fprintf(stderr, "Error: Failed to allocate arrays\n");
+        free(comp_counts);
+        free(move_counts);
+        free(runtimes_us);
+        free(samples);
+        free(fixed);
+        return -1;
     }
-    result->mean_moves = (double)result->total_moves / (double)trials;
 
-    /* Compute move stddev */
-    sum_sq = 0;
-    for (uint64_t t = 0; t < trials; t++) {
-        double diff = (double)move_counts[t] - result->mean_moves;
-        sum_sq += diff * diff;
+    for (size_t i = 0; i < num_seqs; i++) {
+        samples[i].comp_counts = comp_counts + i * trials;
+        samples[i].move_counts = move_counts + i * trials;
+        samples[i].runtimes_us = runtimes_us + i * trials;
+        fixed[i] = shellsort_fixed_lookup(seqs[i]->name);
     }
-    result->moves_stddev = sqrt(sum_sq / (double)trials);
 
-    /* Compute runtime statistics */
-    double runtime_sum = 0;
-    for (uint64_t t = 0; t < trials; t++) {
-        runtime_sum += runtimes_us[t];
+    size_t work_bytes = ds->N * ds->elem_size;
+    int task_threads = kernel == KERNEL_PARALLEL ? 1 : num_threads;
+    if (trial_major) {
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(task_threads)
+        for (uint64_t t = 0; t < trials; t++) {
+            telemetry_slot_t *ts = telemetry_thread_slot(tel);
+            telemetry_begin(ts);
+            char *buf = scratch_get(scratch);
+            const void *src = dataset_load_trial(ds, t, buf + work_bytes);
+            uint64_t comps = 0;
+            for (size_t i = 0; i < num_seqs; i++) {
+                run_trial(ds, t, src, buf, seqs[i], fixed[i], kernel, engine, kv_soa,
+                          num_threads, &samples[i]);
+                comps += samples[i].comp_counts[t];
+            }
+            telemetry_end(ts, 1, num_seqs, ds->N, comps, dataset_trial_bytes(ds, t));
+        }
+    } else {
+        /* Sequence-major order: consecutive tasks share a gap table */
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(task_threads)
+        for (uint64_t k = 0; k < tasks; k++) {
+            size_t i = (size_t)(k / trials);
+            uint64_t t = k % trials;
+            telemetry_slot_t *ts = telemetry_thread_slot(tel);
+            telemetry_begin(ts);
+            char *buf = scratch_get(scratch);
+            const void *src = dataset_load_trial(ds, t, buf + work_bytes);
+            run_trial(ds, t, src, buf, seqs[i], fixed[i], kernel, engine, kv_soa,
+                      num_threads, &samples[i]);
+            /* Each trial is loaded once per sequence; count it as a trial only once */
+            telemetry_end(ts, i == 0, 1, ds->N, samples[i].comp_counts[t],
+                          dataset_trial_bytes(ds, t));
+        }
     }
-    result->mean_runtime_us = runtime_sum / (double)trials;
 
-    sum_sq = 0;
-    for (uint64_t t = 0; t < trials; t++) {
-        double diff = runtimes_us[t] - result->mean_runtime_us;
-        sum_sq += diff * diff;
+    for (size_t i = 0; i < num_seqs; i++) {
+        reduce_samples(seqs[i], ds->N, trials, &samples[i], &results[i]);
     }
-    result->runtime_stddev_us = sqrt(sum_sq / (double)trials);
-    result->runtime_stderr_us = result->runtime_stddev_us / sqrt((double)trials);
 
     free(comp_counts);
     free(move_counts);
     free(runtimes_us);
+    free(samples);
+    free(fixed);
+    return 0;
+}
+
+/*
+ * Per-gap breakdown of seq over every trial, one untimed
+ * shellsort_pass_stats() run each. Writes one CSV row per pass.
+ */
+static int per_pass_sequence(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                             const scratch_pool_t *scratch, int use_perf, int num_threads,
+                             FILE *csv, int *perf_events) {
+    uint64_t N = ds->N;
+    uint64_t trials = ds->trials;
+    pass_stats_t *passes = malloc(trials * MAX_GAPS * sizeof(pass_stats_t));
+    if (!passes) {
+        fprintf(stderr, "Error: Failed to allocate per-pass stats\n");
+        return -1;
+    }
+
+    size_t num_passes = shellsort_num_passes(N, seq);
+    int events = 2;
+    char dist[64];
+    dist_label(&ds->dist, dist, sizeof(dist));
+
+    #pragma omp parallel num_threads(num_threads) reduction(min:events)
+    {
+        /* Counters follow the thread that opened them */
+        perf_counters_t perf = {-1, -1};
+        if (use_perf) events = perf_counters_open(&perf);
+
+        #pragma omp for schedule(static)
+        for (uint64_t t = 0; t < trials; t++) {
+            int32_t *arr = scratch_get(scratch);
+            dataset_copy_trial(ds, t, arr);
+            shellsort_pass_stats(arr, N, seq, &passes[t * MAX_GAPS], use_perf ? &perf : NULL);
+        }
+
+        perf_counters_close(&perf);
+    }
+    if (use_perf) *perf_events = events;
+
+    uint64_t total_comparisons = 0;
+    for (uint64_t t = 0; t < trials; t++) {
+        for (size_t p = 0; p < num_passes; p++) {
+            total_comparisons += passes[t * MAX_GAPS + p].comparisons;
+        }
+    }
+
+    for (size_t p = 0; p < num_passes; p++) {
+        uint64_t comps = 0, moves = 0, cycles = 0, cache = 0, branch = 0, max_disp = 0;
+        for (uint64_t t = 0; t < trials; t++) {
+            const pass_stats_t *ps = &passes[t * MAX_GAPS + p];
+            comps += ps->comparisons;
+            moves += ps->moves;
+            cycles += ps->cycles;
+            cache += ps->cache_misses;
+            branch += ps->branch_misses;
+            if (ps->max_displacement > max_disp) max_disp = ps->max_displacement;
+        }
+        fprintf(csv, "%s,%s,%lu,%lu,%zu,%lu,%.2f,%.6f,%.2f,%lu,%.0f,%.0f,%.0f\n",
+                seq->name, dist, (unsigned long)N, (unsigned long)trials, p,
+                (unsigned long)passes[p].gap,
+                (double)comps / (double)trials,
+                total_comparisons ? (double)comps / (double)total_comparisons : 0.0,
+                (double)moves / (double)trials,
+                (unsigned long)max_disp,
+                (double)cycles / (double)trials,
+                (double)cache / (double)trials,
+                (double)branch / (double)trials);
+    }
+
+    free(passes);
+    return 0;
 }
 
 static void get_system_info(char *buf, size_t len) {
@@ -302,6 +682,16 @@ static void get_system_info(char *buf, size_t len) {
     }
 }
 
+/*
+ * Announce every (size, distribution) run from `from` on to telemetry, at
+ * `trials` per sequence; main() revises each run once it is loaded
+ */
+static void announce_runs(telemetry_t *tel, const config_t *cfg, size_t from, uint64_t trials) {
+    for (size_t run = from; run < cfg->num_sizes * cfg->num_dists; run++) {
+        telemetry_expect(tel, NUM_BENCH_SEQS * trials, cfg->sizes[run / cfg->num_dists]);
+    }
+}
+
 static void get_cpu_info(char *buf, size_t len) {
     FILE *f = fopen("/proc/cpuinfo", "r");
     if (!f) {
@@ -354,8 +744,12 @@ int main(int argc, char **argv) {
         uint64_t common_sizes[] = {1000, 2000, 10000, 20000, 100000, 200000, 1000000, 2000000};
         for (size_t i = 0; i < sizeof(common_sizes) / sizeof(common_sizes[0]); i++) {
             char path[1024];
-            snprintf(path, sizeof(path), "%s/perm_%lu.bin", cfg.perms_dir, (unsigned long)common_sizes[i]);
-            if (access(path, F_OK) == 0) {
+            char packed[1024];
+            dataset_path_dist(path, sizeof(path), cfg.perms_dir, common_sizes[i], cfg.elem_type,
+                              &cfg.dists[0]);
+            dataset_path_packed(packed, sizeof(packed), cfg.perms_dir, common_sizes[i],
+                                &cfg.dists[0]);
+            if (access(path, F_OK) == 0 || access(packed, F_OK) == 0) {
                 cfg.sizes[cfg.num_sizes++] = common_sizes[i];
             }
         }
@@ -364,6 +758,9 @@ int main(int argc, char **argv) {
             return 1;
         }
     }
+    for (size_t i = 0; i < cfg.num_sizes; i++) {
+        if (elem_type_check_n(cfg.elem_type, cfg.sizes[i]) < 0) return 1;
+    }
 
     /* Create output directory */
     mkdir(cfg.out_dir, 0755);
@@ -387,10 +784,41 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    /* Per-gap breakdown, only with --per-pass */
+    char pass_path[1024];
+    FILE *pass_csv = NULL;
+    if (cfg.per_pass) {
+        snprintf(pass_path, sizeof(pass_path), "%s/bench_%s_passes.csv", cfg.out_dir, timestamp);
+        pass_csv = fopen(pass_path, "w");
+        if (!pass_csv) {
+            fprintf(stderr, "Error: Cannot open %s: %s\n", pass_path, strerror(errno));
+            fclose(csv);
+            return 1;
+        }
+        fprintf(pass_csv, "sequence_name,dist,N,trials,pass,gap,mean_comparisons,comp_share,"
+                "mean_moves,max_displacement,mean_cycles,mean_cache_misses,"
+                "mean_branch_misses\n");
+    }
+    int perf_events = 2;
+
+    /* Live progress; the parallel kernel keeps one task in flight */
+    telemetry_t *tel = NULL;
+    if (cfg.telemetry_path[0]) {
+        tel = telemetry_start(cfg.telemetry_path, "bench",
+                              cfg.kernel == KERNEL_PARALLEL ? 1 : num_threads,
+                              cfg.telemetry_interval);
+        if (!tel) {
+            fclose(csv);
+            if (pass_csv) fclose(pass_csv);
+            return 1;
+        }
+        printf("Telemetry: %s\n", cfg.telemetry_path);
+    }
+
     /* Write CSV header */
     fprintf(csv, "sequence_name,N,trials,mean_comparisons,comp_stddev,comp_stderr,"
             "mean_moves,moves_stddev,mean_runtime_us,runtime_stddev_us,runtime_stderr_us,"
-            "cpu,os,compiler,threads,timestamp\n");
+            "cpu,os,compiler,threads,timestamp,kernel,elem_type,dist,engine\n");
 
     printf("Shellsort Benchmark\n");
     printf("===================\n");
@@ -398,8 +826,35 @@ int main(int argc, char **argv) {
     printf("CPU: %s\n", cpu_info);
     printf("Compiler: %s\n", __VERSION__);
     printf("Threads: %d\n", num_threads);
-    printf("Perms dir: %s\n", cfg.perms_dir);
+    printf("Elements: %s\n", layout_name(&cfg));
+    char engine_label[64];
+    pass_engine_label(&cfg.engine, engine_label, sizeof(engine_label));
+    printf("Kernel: %s", kernel_name(cfg.kernel));
+    if (cfg.kernel == KERNEL_SIMD) {
+        printf(" (%d lanes, gap >= %d)", shellsort_simd_lanes(), SHELLSORT_SIMD_MIN_GAP);
+    } else if (cfg.kernel == KERNEL_BLOCKED) {
+        printf(" (cache budget %zu bytes)", shellsort_l2_bytes());
+    } else if (cfg.kernel == KERNEL_PARALLEL) {
+        printf(" (%d threads per sort, gap >= %d)", num_threads,
+               2 * SHELLSORT_PARALLEL_MIN_CHAINS);
+    }
+    printf("\n");
+    printf("Engine: %s\n", engine_label);
+    if (cfg.source.generate) {
+        printf("Perms: generated, master seed 0x%lX, rng scheme v%d\n",
+               (unsigned long)cfg.source.seed, cfg.source.rng_scheme);
+    } else {
+        printf("Perms dir: %s\n", cfg.perms_dir);
+    }
     printf("Output: %s\n", csv_path);
+    printf("Dists: ");
+    for (size_t d = 0; d < cfg.num_dists; d++) {
+        char label[64];
+        dist_label(&cfg.dists[d], label, sizeof(label));
+        printf("%s%s", label, d < cfg.num_dists - 1 ? ", " : "");
+    }
+    printf("\n");
+    if (pass_csv) printf("Per-pass: %s%s\n", pass_path, cfg.perf ? " (with perf counters)" : "");
     printf("Sizes: ");
     for (size_t i = 0; i < cfg.num_sizes; i++) {
         printf("%lu", (unsigned long)cfg.sizes[i]);
@@ -413,78 +868,163 @@ int main(int argc, char **argv) {
         if (cfg.sizes[i] > max_N) max_N = cfg.sizes[i];
     }
 
-    gap_sequence_t baselines[NUM_BASELINES];
+    gap_sequence_t baselines[NUM_BENCH_SEQS];
     gaps_all_baselines(baselines, max_N);
+    gaps_evolved(&baselines[NUM_BASELINES], max_N);
 
     printf("Baseline sequences:\n");
-    for (int i = 0; i < NUM_BASELINES; i++) {
+    for (int i = 0; i < NUM_BENCH_SEQS; i++) {
         printf("  ");
         gap_sequence_print(&baselines[i]);
     }
     printf("\n");
 
-    /* Benchmark each size */
-    for (size_t si = 0; si < cfg.num_sizes; si++) {
-        uint64_t N = cfg.sizes[si];
-        printf("=== N = %lu ===\n", (unsigned long)N);
+    /*
+     * Announce the whole run for the ETA. File datasets reveal their trial
+     * count on load, so the first one stands in for the rest until each is
+     * loaded and revised.
+     */
+    uint64_t planned = cfg.source.generate ? cfg.source.trials : 0;
+    if (planned) announce_runs(tel, &cfg, 0, planned);
+
+    /* Benchmark each (size, distribution) */
+    for (size_t run = 0; run < cfg.num_sizes * cfg.num_dists; run++) {
+        uint64_t N = cfg.sizes[run / cfg.num_dists];
+        char dist[64];
+        cfg.source.dist = cfg.dists[run % cfg.num_dists];
+        dist_label(&cfg.source.dist, dist, sizeof(dist));
+        printf("=== N = %lu, dist = %s ===\n", (unsigned long)N, dist);
 
         /* Load dataset */
         perm_dataset_t ds;
-        if (load_dataset(cfg.perms_dir, N, &ds) < 0) {
+        uint64_t announced = NUM_BENCH_SEQS * planned;
+        if (dataset_open(&cfg.source, N, cfg.elem_type, &ds) < 0) {
+            telemetry_revise(tel, announced, 0, N);
+            continue;
+        }
+        if (!planned) {
+            planned = ds.trials;
+            announce_runs(tel, &cfg, run, planned);
+            announced = NUM_BENCH_SEQS * planned;
+        }
+        if (ds.generated) {
+            printf("Generating %lu trials per sequence\n", (unsigned long)ds.trials);
+        } else {
+            printf("Loaded %lu trials\n", (unsigned long)ds.trials);
+        }
+
+        /* One pre-faulted buffer per thread, reused by every sequence */
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, num_threads,
+                              N * ds.elem_size + dataset_load_scratch(&ds)) < 0) {
+            telemetry_revise(tel, announced, 0, N);
+            free_dataset(&ds);
             continue;
         }
-        printf("Loaded %lu trials\n", (unsigned long)ds.trials);
 
         /* Generate sequences for this N */
-        gap_sequence_t seqs[NUM_BASELINES];
+        gap_sequence_t seqs[NUM_BENCH_SEQS];
         gaps_all_baselines(seqs, N);
+        gaps_evolved(&seqs[NUM_BASELINES], N);
 
-        /* Benchmark each sequence */
-        for (int i = 0; i < NUM_BASELINES; i++) {
+        /* Sequences this kernel can run at this N */
+        const gap_sequence_t *active[NUM_BENCH_SEQS];
+        size_t num_active = 0;
+        for (int i = 0; i < NUM_BENCH_SEQS; i++) {
             char reason[256];
             if (!gap_sequence_valid(&seqs[i], reason, sizeof(reason))) {
                 printf("  [SKIP] %s: %s\n", seqs[i].name, reason);
                 continue;
             }
 
-            bench_result_t result;
-            benchmark_sequence(&ds, &seqs[i], &result, num_threads);
+            if (cfg.kernel == KERNEL_FIXED) {
+                const fixed_kernel_t *fk = shellsort_fixed_lookup(seqs[i].name);
+                if (!fk || !shellsort_fixed_matches(fk, &seqs[i], N)) {
+                    printf("  [SKIP] %s: no specialized kernel for N=%lu\n",
+                           seqs[i].name, (unsigned long)N);
+                    continue;
+                }
+            }
+            active[num_active++] = &seqs[i];
+        }
+
+        /* Benchmark all of them in one parallel region */
+        bench_result_t results[NUM_BENCH_SEQS];
+        const pass_engine_t *engine =
+            (cfg.engine.small != PASS_INSERTION) ? &cfg.engine : NULL;
+        char phase[128];
+        snprintf(phase, sizeof(phase), "N=%lu dist=%s (%zu of %zu)", (unsigned long)N, dist,
+                 run + 1, cfg.num_sizes * cfg.num_dists);
+        telemetry_set_phase(tel, phase);
+        telemetry_revise(tel, announced, (uint64_t)num_active * ds.trials, N);
+        if (benchmark_size(&ds, active, num_active, &scratch, cfg.kernel, engine, cfg.kv_soa,
+                           cfg.trial_major, results, num_threads, tel) < 0) {
+            telemetry_revise(tel, (uint64_t)num_active * ds.trials, 0, N);
+            num_active = 0;
+        }
+
+        for (size_t i = 0; i < num_active; i++) {
+            const bench_result_t *result = &results[i];
 
             printf("  %-16s: comps=%.0f (±%.0f)  moves=%.0f  runtime=%.0f±%.0fμs\n",
-                   result.sequence_name,
-                   result.mean_comparisons,
-                   result.stderr_val,
-                   result.mean_moves,
-                   result.mean_runtime_us,
-                   result.runtime_stderr_us);
+                   result->sequence_name,
+                   result->mean_comparisons,
+                   result->stderr_val,
+                   result->mean_moves,
+                   result->mean_runtime_us,
+                   result->runtime_stderr_us);
 
             /* Write to CSV */
             fprintf(csv, "%s,%lu,%lu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,"
-                    "\"%s\",\"%s\",\"%s\",%d,%s\n",
-                    result.sequence_name,
-                    (unsigned long)result.N,
-                    (unsigned long)result.trials,
-                    result.mean_comparisons,
-                    result.stddev,
-                    result.stderr_val,
-                    result.mean_moves,
-                    result.moves_stddev,
-                    result.mean_runtime_us,
-                    result.runtime_stddev_us,
-                    result.runtime_stderr_us,
+                    "\"%s\",\"%s\",\"%s\",%d,%s,%s,%s,%s,%s\n",
+                    result->sequence_name,
+                    (unsigned long)result->N,
+                    (unsigned long)result->trials,
+                    result->mean_comparisons,
+                    result->stddev,
+                    result->stderr_val,
+                    result->mean_moves,
+                    result->moves_stddev,
+                    result->mean_runtime_us,
+                    result->runtime_stddev_us,
+                    result->runtime_stderr_us,
                     cpu_info,
                     sys_info,
                     __VERSION__,
                     num_threads,
-                    timestamp);
+                    timestamp,
+                    kernel_name(cfg.kernel),
+                    layout_name(&cfg),
+                    dist,
+                    engine_label);
+
+            if (pass_csv) {
+                int events = 2;
+                per_pass_sequence(&ds, active[i], &scratch, cfg.perf, num_threads, pass_csv,
+                                  &events);
+                if (events < perf_events) perf_events = events;
+            }
         }
 
+        if (ds.sums) {
+            printf("Verified %lu/%lu trials\n", (unsigned long)dataset_verified_count(&ds),
+                   (unsigned long)ds.trials);
+        }
+        scratch_pool_free(&scratch);
         free_dataset(&ds);
         printf("\n");
     }
 
+    telemetry_stop(tel);
     fclose(csv);
     printf("Results written to %s\n", csv_path);
+    if (pass_csv) {
+        fclose(pass_csv);
+        printf("Per-pass results written to %s\n", pass_path);
+        if (cfg.perf && perf_events < 2) {
+            printf("Note: some perf events were unavailable; their columns are 0\n");
+        }
+    }
 
     return 0;
 }
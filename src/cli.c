@@ -0,0 +1,28 @@
+#define _GNU_SOURCE
+/*
+ * cli.c - Option parsing shared by the tools (cli.h)
+ */
+
+#include "cli.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+int parse_uint64_list(const char *str, uint64_t min, uint64_t *out, size_t max, size_t *count) {
+    *count = 0;
+    char *copy = strdup(str);
+    if (!copy) return -1;
+
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        char *end;
+        uint64_t v = strtoull(tok, &end, 0);
+        if (*count >= max || end == tok || *end != '\0' || v < min) {
+            free(copy);
+            return -1;
+        }
+        out[(*count)++] = v;
+    }
+
+    free(copy);
+    return *count > 0 ? 0 : -1;
+}
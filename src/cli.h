@@ -0,0 +1,23 @@
+/*
+ * cli.h - Option parsing shared by the tools
+ *
+ * Every tool takes comma-separated number lists ("--sizes 1000,1000000").
+ * One parser keeps them strict alike: a token must be a whole number in
+ * strtoull() base 0 (decimal, 0x hex or 0 octal), so "10k" or "1e6" is an
+ * error instead of silently reading as 10 or 1.
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Parse a comma-separated list into out (at most max values), each at
+ * least min. Returns 0, or -1 if a token is not a number, is below min,
+ * the list is empty or has more than max values.
+ */
+int parse_uint64_list(const char *str, uint64_t min, uint64_t *out, size_t max, size_t *count);
+
+#endif /* CLI_H */
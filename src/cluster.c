@@ -0,0 +1,579 @@
+#define _GNU_SOURCE
+/*
+ * cluster.c - TCP coordinator/worker evaluation (see cluster.h)
+ *
+ * One exchange per chunk:
+ *
+ *   coordinator -> worker   job_header_t, then num_seqs wire_seq_t
+ *   worker -> coordinator   reply_header_t, then num_seqs * (trial_end -
+ *                           trial_begin) uint64 counts, sequence-major
+ *
+ * A reply with nonzero status carries no counts. The worker keeps the
+ * connection open for the next chunk until the coordinator hangs up.
+ */
+
+#include "cluster.h"
+#include "rng.h"
+#include "scratch.h"
+#include "timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define JOB_MAGIC   0x31424F4A4C454853ULL  /* "SHELJOB1" */
+#define REPLY_MAGIC 0x3150524C4C454853ULL  /* "SHELRPL1" */
+
+/* Sanity limit on sequences per chunk; evolve_live sends at most MAX_POP */
+#define MAX_JOB_SEQS 4096
+
+/* Keepalive: probe after this many idle seconds, then every interval, give up after count */
+#define KEEPALIVE_IDLE 60
+#define KEEPALIVE_INTERVAL 10
+#define KEEPALIVE_COUNT 6
+
+typedef struct {
+    uint64_t magic;
+    uint64_t n;
+    uint64_t master_seed;
+    uint64_t trial_begin;
+    uint64_t trial_end;      /* Exclusive */
+    uint32_t rng_scheme;
+    uint32_t dist_kind;
+    double dist_param;
+    uint32_t num_seqs;
+    uint32_t reserved;
+} job_header_t;
+
+typedef struct {
+    uint64_t num_gaps;
+    uint64_t gaps[MAX_GAPS]; /* Ascending, as in gap_sequence_t */
+} wire_seq_t;
+
+typedef struct {
+    uint64_t magic;
+    uint64_t status;         /* 0 = ok */
+    uint64_t count;          /* Counts that follow */
+} reply_header_t;
+
+/* ---- Socket helpers ------------------------------------------------------ */
+
+static int send_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t w = send(fd, p, len, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return -1;
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+/* Returns 0, 1 on a clean EOF before any byte, -1 on error or short read */
+static int recv_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    size_t got = 0;
+    while (got < len) {
+        ssize_t r = recv(fd, p + got, len - got, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r == 0 && got == 0) return 1;
+        if (r <= 0) return -1;
+        got += (size_t)r;
+    }
+    return 0;
+}
+
+/* Low latency and dead-peer detection for a connected socket */
+static void tune_socket(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+#ifdef TCP_KEEPIDLE
+    int idle = KEEPALIVE_IDLE, interval = KEEPALIVE_INTERVAL, count = KEEPALIVE_COUNT;
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+}
+
+/* Bound every send and recv on fd by seconds (0 = block indefinitely) */
+static void set_io_timeout(int fd, double seconds) {
+    struct timeval tv;
+    tv.tv_sec = (time_t)seconds;
+    tv.tv_usec = (suseconds_t)((seconds - (double)tv.tv_sec) * 1e6);
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static int connect_worker(const char *spec, cluster_worker_t *w) {
+    char host[128];
+    char port[8];
+
+    const char *colon = strrchr(spec, ':');
+    size_t host_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    if (host_len == 0 || host_len >= sizeof(host) ||
+        (colon && (colon[1] == '\0' || strlen(colon + 1) >= sizeof(port)))) {
+        fprintf(stderr, "Error: Bad worker address '%s'\n", spec);
+        return -1;
+    }
+    memcpy(host, spec, host_len);
+    host[host_len] = '\0';
+    if (colon) {
+        strcpy(port, colon + 1);
+    } else {
+        snprintf(port, sizeof(port), "%d", CLUSTER_DEFAULT_PORT);
+    }
+    snprintf(w->name, sizeof(w->name), "%s:%s", host, port);
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int rc = getaddrinfo(host, port, &hints, &res);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Cannot resolve worker %s: %s\n", w->name, gai_strerror(rc));
+        return -1;
+    }
+
+    w->fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            w->fd = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(res);
+
+    if (w->fd < 0) {
+        fprintf(stderr, "Error: Cannot connect to worker %s: %s\n", w->name, strerror(errno));
+        return -1;
+    }
+    tune_socket(w->fd);
+    return 0;
+}
+
+/* ---- Coordinator --------------------------------------------------------- */
+
+int cluster_connect(cluster_t *c, const char *list) {
+    memset(c, 0, sizeof(*c));
+    c->worker_timeout = CLUSTER_DEFAULT_TIMEOUT;
+
+    char *copy = strdup(list);
+    if (!copy) return -1;
+
+    int rc = 0;
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        if (c->num_workers >= CLUSTER_MAX_WORKERS) {
+            fprintf(stderr, "Error: More than %d workers\n", CLUSTER_MAX_WORKERS);
+            rc = -1;
+            break;
+        }
+        if (connect_worker(tok, &c->workers[c->num_workers]) < 0) {
+            rc = -1;
+            break;
+        }
+        c->num_workers++;
+    }
+    free(copy);
+
+    if (rc == 0 && c->num_workers == 0) {
+        fprintf(stderr, "Error: Empty worker list\n");
+        rc = -1;
+    }
+    if (rc < 0) cluster_close(c);
+    return rc;
+}
+
+void cluster_close(cluster_t *c) {
+    for (size_t i = 0; i < c->num_workers; i++) {
+        if (c->workers[i].fd >= 0) close(c->workers[i].fd);
+        c->workers[i].fd = -1;
+    }
+    c->num_workers = 0;
+}
+
+size_t cluster_live_workers(const cluster_t *c) {
+    size_t live = 0;
+    for (size_t i = 0; i < c->num_workers; i++) live += c->workers[i].fd >= 0;
+    return live;
+}
+
+static void drop_worker(cluster_worker_t *w, const char *why) {
+    fprintf(stderr, "Warning: Dropping worker %s (%s)\n", w->name, why);
+    close(w->fd);
+    w->fd = -1;
+}
+
+/* Send chunk [begin, end) of the job to w */
+/* Work in one chunk: sequences x trials x elements sorted */
+static double chunk_units(size_t count, uint64_t trials, uint64_t N) {
+    return (double)count * (double)trials * (double)N;
+}
+
+/*
+ * Seconds a chunk of units may take before its worker is dropped:
+ * CLUSTER_TIMEOUT_FACTOR times what it would take at the slowest rate any
+ * chunk has shown, never below worker_timeout. No deadline until a chunk
+ * has come back (chunk size at large N is unknown in advance), nor when
+ * worker_timeout is 0; keepalive still catches vanished peers then.
+ */
+static double chunk_allowance(const cluster_t *c, double units) {
+    if (c->worker_timeout <= 0 || c->slowest_rate <= 0) return 0.0;
+    double scaled = CLUSTER_TIMEOUT_FACTOR * c->slowest_rate * units;
+    return scaled > c->worker_timeout ? scaled : c->worker_timeout;
+}
+
+static int send_chunk(cluster_worker_t *w, job_header_t *hdr, const wire_seq_t *wire,
+                      uint64_t begin, uint64_t end) {
+    hdr->trial_begin = begin;
+    hdr->trial_end = end;
+    if (send_full(w->fd, hdr, sizeof(*hdr)) < 0 ||
+        send_full(w->fd, wire, hdr->num_seqs * sizeof(wire_seq_t)) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Receive w's counts for [begin, end) straight into comps */
+static int recv_chunk(cluster_worker_t *w, size_t count, uint64_t trials, uint64_t begin,
+                      uint64_t end, uint64_t *buf, uint64_t *comps) {
+    reply_header_t rep;
+    uint64_t span = end - begin;
+    if (recv_full(w->fd, &rep, sizeof(rep)) != 0 || rep.magic != REPLY_MAGIC ||
+        rep.status != 0 || rep.count != count * span ||
+        recv_full(w->fd, buf, rep.count * sizeof(uint64_t)) != 0) {
+        return -1;
+    }
+    for (size_t m = 0; m < count; m++) {
+        memcpy(comps + m * trials + begin, buf + m * span, span * sizeof(uint64_t));
+    }
+    return 0;
+}
+
+int cluster_evaluate(cluster_t *c, const perm_dataset_t *ds, const gap_sequence_t *const *seqs,
+                     size_t count, uint64_t *comps) {
+    if (!ds->generated || ds->elem_type != ELEM_I32) {
+        fprintf(stderr, "Error: Cluster evaluation needs a generated i32 dataset\n");
+        return -1;
+    }
+    uint64_t trials = ds->trials;
+    if (count == 0 || trials == 0) return 0;
+    if (count > MAX_JOB_SEQS) {
+        fprintf(stderr, "Error: More than %d sequences in one cluster request\n", MAX_JOB_SEQS);
+        return -1;
+    }
+
+    size_t live = cluster_live_workers(c);
+    if (live == 0) {
+        fprintf(stderr, "Error: No cluster workers left\n");
+        return -1;
+    }
+    uint64_t chunk = c->chunk_trials ? c->chunk_trials : trials / (4 * live);
+    if (chunk == 0) chunk = 1;
+    size_t num_chunks = (size_t)((trials + chunk - 1) / chunk);
+
+    job_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = JOB_MAGIC;
+    hdr.n = ds->N;
+    hdr.master_seed = ds->master_seed;
+    hdr.rng_scheme = (uint32_t)ds->rng_scheme;
+    hdr.dist_kind = (uint32_t)ds->dist.kind;
+    hdr.dist_param = ds->dist.param;
+    hdr.num_seqs = (uint32_t)count;
+
+    wire_seq_t *wire = calloc(count, sizeof(wire_seq_t));
+    uint64_t *buf = malloc(count * chunk * sizeof(uint64_t));
+    size_t *pending = malloc(num_chunks * sizeof(size_t));
+    long assigned[CLUSTER_MAX_WORKERS];
+    double sent_at[CLUSTER_MAX_WORKERS];     /* timing_wall_seconds() when assigned[i] was sent */
+    double units[CLUSTER_MAX_WORKERS];       /* chunk_units() of assigned[i] */
+    struct pollfd pfd[CLUSTER_MAX_WORKERS];
+    size_t pfd_worker[CLUSTER_MAX_WORKERS];
+    if (!wire || !buf || !pending) {
+        free(wire);
+        free(buf);
+        free(pending);
+        return -1;
+    }
+    for (size_t m = 0; m < count; m++) {
+        wire[m].num_gaps = seqs[m]->num_gaps;
+        memcpy(wire[m].gaps, seqs[m]->gaps, seqs[m]->num_gaps * sizeof(uint64_t));
+    }
+
+    /* Pending chunks are a stack, highest index on the bottom */
+    size_t num_pending = num_chunks;
+    for (size_t k = 0; k < num_chunks; k++) pending[k] = num_chunks - 1 - k;
+    for (size_t i = 0; i < c->num_workers; i++) {
+        assigned[i] = -1;
+        /* A reply that stalls halfway fails recv_full() instead of blocking */
+        if (c->workers[i].fd >= 0) set_io_timeout(c->workers[i].fd, c->worker_timeout);
+    }
+
+    size_t done = 0;
+    int rc = 0;
+    while (done < num_chunks) {
+        /* Hand a chunk to every idle worker */
+        for (size_t i = 0; i < c->num_workers && num_pending > 0; i++) {
+            cluster_worker_t *w = &c->workers[i];
+            if (w->fd < 0 || assigned[i] >= 0) continue;
+            size_t k = pending[--num_pending];
+            uint64_t begin = k * chunk, end = begin + chunk < trials ? begin + chunk : trials;
+            if (send_chunk(w, &hdr, wire, begin, end) < 0) {
+                drop_worker(w, "send failed");
+                pending[num_pending++] = k;
+                continue;
+            }
+            assigned[i] = (long)k;
+            sent_at[i] = timing_wall_seconds();
+            units[i] = chunk_units(count, end - begin, ds->N);
+            c->chunks_sent++;
+        }
+
+        /* Wait for a reply, but no longer than the earliest deadline */
+        size_t npfd = 0;
+        int wait_ms = -1;
+        double now = timing_wall_seconds();
+        for (size_t i = 0; i < c->num_workers; i++) {
+            if (c->workers[i].fd < 0 || assigned[i] < 0) continue;
+            pfd[npfd].fd = c->workers[i].fd;
+            pfd[npfd].events = POLLIN;
+            pfd_worker[npfd++] = i;
+            double allowed = chunk_allowance(c, units[i]);
+            if (allowed > 0) {
+                double left_ms = (sent_at[i] + allowed - now) * 1000.0 + 1.0;
+                int ms = left_ms < 0 ? 0 : left_ms > 1e9 ? 1000000000 : (int)left_ms;
+                if (wait_ms < 0 || ms < wait_ms) wait_ms = ms;
+            }
+        }
+        if (npfd == 0) {
+            fprintf(stderr, "Error: No cluster workers left (%zu of %zu chunks done)\n",
+                    done, num_chunks);
+            rc = -1;
+            break;
+        }
+
+        if (poll(pfd, npfd, wait_ms) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: poll: %s\n", strerror(errno));
+            rc = -1;
+            break;
+        }
+
+        for (size_t p = 0; p < npfd; p++) {
+            if (!(pfd[p].revents & (POLLIN | POLLERR | POLLHUP))) continue;
+            size_t i = pfd_worker[p];
+            size_t k = (size_t)assigned[i];
+            uint64_t begin = k * chunk, end = begin + chunk < trials ? begin + chunk : trials;
+            assigned[i] = -1;
+            if (recv_chunk(&c->workers[i], count, trials, begin, end, buf, comps) < 0) {
+                drop_worker(&c->workers[i], "bad or missing reply");
+                pending[num_pending++] = k;
+                c->chunks_retried++;
+                continue;
+            }
+            double rate = (timing_wall_seconds() - sent_at[i]) / units[i];
+            if (rate > c->slowest_rate) c->slowest_rate = rate;
+            done++;
+        }
+
+        /* A worker silent past its deadline is treated like a bad reply */
+        now = timing_wall_seconds();
+        for (size_t p = 0; p < npfd; p++) {
+            size_t i = pfd_worker[p];
+            double allowed = chunk_allowance(c, units[i]);
+            if (assigned[i] < 0 || allowed <= 0 || now < sent_at[i] + allowed) continue;
+            char why[64];
+            snprintf(why, sizeof(why), "no reply within %.0f s", allowed);
+            drop_worker(&c->workers[i], why);
+            pending[num_pending++] = (size_t)assigned[i];
+            assigned[i] = -1;
+            c->chunks_retried++;
+        }
+    }
+
+    free(wire);
+    free(buf);
+    free(pending);
+    return rc;
+}
+
+/* ---- Worker -------------------------------------------------------------- */
+
+static int reply_status(int fd, uint64_t status) {
+    reply_header_t rep = { REPLY_MAGIC, status, 0 };
+    return send_full(fd, &rep, sizeof(rep));
+}
+
+/* Serve chunks on fd until the coordinator hangs up */
+static void serve_connection(int fd, int threads) {
+    wire_seq_t *wire = NULL;
+    gap_sequence_t *seqs = NULL;
+    uint64_t *out = NULL;
+    size_t cap_seqs = 0, cap_out = 0;
+    scratch_pool_t scratch;
+    uint64_t scratch_n = 0;
+
+    for (;;) {
+        job_header_t hdr;
+        if (recv_full(fd, &hdr, sizeof(hdr)) != 0) break;
+
+        if (hdr.magic != JOB_MAGIC || hdr.n == 0 || hdr.trial_end <= hdr.trial_begin ||
+            hdr.num_seqs == 0 || hdr.num_seqs > MAX_JOB_SEQS ||
+            (hdr.rng_scheme != RNG_SCHEME_V1 && hdr.rng_scheme != RNG_SCHEME_V2) ||
+            hdr.dist_kind >= DIST_NUM_KINDS) {
+            fprintf(stderr, "eval_worker: malformed job, closing connection\n");
+            reply_status(fd, 1);
+            break;
+        }
+        uint64_t span = hdr.trial_end - hdr.trial_begin;
+        if (span > SIZE_MAX / sizeof(uint64_t) / hdr.num_seqs) {
+            fprintf(stderr, "eval_worker: job of %u sequences x %lu trials is too large, "
+                    "closing connection\n", hdr.num_seqs, (unsigned long)span);
+            reply_status(fd, 1);
+            break;
+        }
+
+        if (hdr.num_seqs > cap_seqs) {
+            free(wire);
+            free(seqs);
+            wire = malloc(hdr.num_seqs * sizeof(wire_seq_t));
+            seqs = malloc(hdr.num_seqs * sizeof(gap_sequence_t));
+            cap_seqs = wire && seqs ? hdr.num_seqs : 0;
+        }
+        size_t need_out = (size_t)(hdr.num_seqs * span);
+        if (need_out > cap_out) {
+            free(out);
+            out = malloc(need_out * sizeof(uint64_t));
+            cap_out = out ? need_out : 0;
+        }
+        if (hdr.n != scratch_n) {
+            if (scratch_n) scratch_pool_free(&scratch);
+            scratch_n = scratch_pool_init(&scratch, threads, hdr.n * sizeof(int32_t)) < 0
+                        ? 0 : hdr.n;
+        }
+        if (!cap_seqs || !cap_out || !scratch_n) {
+            fprintf(stderr, "eval_worker: out of memory at N=%lu\n", (unsigned long)hdr.n);
+            reply_status(fd, 2);
+            break;
+        }
+
+        if (recv_full(fd, wire, hdr.num_seqs * sizeof(wire_seq_t)) != 0) break;
+        int bad = 0;
+        for (uint32_t m = 0; m < hdr.num_seqs; m++) {
+            if (wire[m].num_gaps == 0 || wire[m].num_gaps > MAX_GAPS) bad = 1;
+            if (bad) break;
+            snprintf(seqs[m].name, sizeof(seqs[m].name), "job-%u", m);
+            seqs[m].num_gaps = (size_t)wire[m].num_gaps;
+            memcpy(seqs[m].gaps, wire[m].gaps, seqs[m].num_gaps * sizeof(uint64_t));
+        }
+        if (bad) {
+            fprintf(stderr, "eval_worker: malformed sequence, closing connection\n");
+            reply_status(fd, 1);
+            break;
+        }
+
+        perm_dataset_t ds;
+        dataset_generate(&ds, hdr.n, hdr.trial_end, hdr.master_seed, ELEM_I32,
+                         (int)hdr.rng_scheme);
+        ds.dist.kind = (dist_kind_t)hdr.dist_kind;
+        ds.dist.param = hdr.dist_param;
+
+        uint64_t work = hdr.num_seqs * span;
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for (uint64_t w = 0; w < work; w++) {
+            uint64_t m = w / span;
+            uint64_t t = hdr.trial_begin + w % span;
+            int32_t *arr = scratch_get(&scratch);
+            dataset_copy_trial(&ds, t, arr);
+            out[w] = shellsort(arr, ds.N, &seqs[m]);
+        }
+
+        reply_header_t rep = { REPLY_MAGIC, 0, work };
+        if (send_full(fd, &rep, sizeof(rep)) < 0 ||
+            send_full(fd, out, work * sizeof(uint64_t)) < 0) {
+            break;
+        }
+    }
+
+    if (scratch_n) scratch_pool_free(&scratch);
+    free(wire);
+    free(seqs);
+    free(out);
+}
+
+int cluster_worker_serve(int port, int threads) {
+    int lfd = socket(AF_INET6, SOCK_STREAM, 0);
+    int v6 = lfd >= 0;
+    if (!v6) lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    int one = 1, zero = 0;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    int rc;
+    if (v6) {
+        /* Dual-stack: accept IPv4 coordinators on the same socket */
+        setsockopt(lfd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+        struct sockaddr_in6 addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = htons((uint16_t)port);
+        rc = bind(lfd, (struct sockaddr *)&addr, sizeof(addr));
+    } else {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        rc = bind(lfd, (struct sockaddr *)&addr, sizeof(addr));
+    }
+    if (rc < 0 || listen(lfd, 4) < 0) {
+        fprintf(stderr, "Error: Cannot listen on port %d: %s\n", port, strerror(errno));
+        close(lfd);
+        return -1;
+    }
+    fprintf(stderr, "eval_worker: listening on port %d, %d threads\n", port, threads);
+
+    for (;;) {
+        struct sockaddr_storage peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(lfd, (struct sockaddr *)&peer, &peer_len);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "eval_worker: accept: %s\n", strerror(errno));
+            continue;
+        }
+        tune_socket(fd);
+
+        char host[NI_MAXHOST] = "?";
+        getnameinfo((struct sockaddr *)&peer, peer_len, host, sizeof(host), NULL, 0,
+                    NI_NUMERICHOST);
+        fprintf(stderr, "eval_worker: coordinator %s connected\n", host);
+        serve_connection(fd, threads);
+        fprintf(stderr, "eval_worker: coordinator %s disconnected\n", host);
+        close(fd);
+    }
+}
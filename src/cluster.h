@@ -0,0 +1,93 @@
+/*
+ * cluster.h - Sharding (sequence x trial) evaluation across machines
+ *
+ * A coordinator (evolve_live --workers) holds TCP connections to any
+ * number of workers (eval_worker). Each request to cluster_evaluate() is
+ * cut into chunks of consecutive trials; every chunk carries the master
+ * seed, N, distribution and all gap sequences, and the worker rebuilds
+ * those trials itself with the same derivation permgen uses
+ * (derive_seed(), dataset_generate()), so no dataset is ever shipped. A
+ * worker holds one chunk at a time and gets the next as soon as it
+ * answers, so faster nodes take more chunks.
+ *
+ * Results come back as per-(sequence, trial) comparison counts and are
+ * stored by index, so the totals do not depend on which worker ran which
+ * chunk or in what order chunks finished: they equal a local run exactly.
+ * A worker that disconnects, answers badly or misses its chunk's deadline
+ * is dropped and its chunk goes back in the queue; the request only fails
+ * once no worker is left. The deadline scales with the chunk's work:
+ * CLUSTER_TIMEOUT_FACTOR times the slowest per-element rate any chunk has
+ * shown so far, but at least worker_timeout seconds. Until a first chunk
+ * has come back there is no deadline.
+ * Sockets on both sides use TCP keepalive, so a peer that vanishes
+ * without a reset (power loss, suspend) is also noticed while idle.
+ *
+ * Messages are fixed-width integers in host byte order, so every node
+ * must share one byte order (x86-64 and AArch64 Linux all do); a mismatch
+ * fails the magic check.
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "shellsort.h"
+#include "dataset.h"
+
+/* Default TCP port of eval_worker */
+#define CLUSTER_DEFAULT_PORT 7431
+
+/* Most workers one coordinator connects to */
+#define CLUSTER_MAX_WORKERS 256
+
+/* Default floor, in seconds, of the per-chunk deadline */
+#define CLUSTER_DEFAULT_TIMEOUT 600.0
+
+/* A chunk may take this many times its work at the slowest rate seen */
+#define CLUSTER_TIMEOUT_FACTOR 10.0
+
+typedef struct {
+    int fd;                  /* -1 once dropped */
+    char name[144];          /* host:port, for messages */
+} cluster_worker_t;
+
+typedef struct {
+    cluster_worker_t workers[CLUSTER_MAX_WORKERS];
+    size_t num_workers;
+    uint64_t chunk_trials;   /* Trials per chunk (0 = trials / (4 * workers), at least 1) */
+    double worker_timeout;   /* Least seconds a chunk is allowed (0 = no deadline) */
+    double slowest_rate;     /* Slowest seconds per sequence x trial x element seen, 0 = none yet */
+    uint64_t chunks_sent;    /* Totals over the cluster's lifetime */
+    uint64_t chunks_retried;
+} cluster_t;
+
+/*
+ * Connect to every worker of a comma-separated "host[:port],..." list.
+ * worker_timeout starts at CLUSTER_DEFAULT_TIMEOUT. Returns 0, or -1
+ * (message on stderr) if any worker cannot be reached.
+ */
+int cluster_connect(cluster_t *c, const char *list);
+void cluster_close(cluster_t *c);
+
+/* Workers still connected */
+size_t cluster_live_workers(const cluster_t *c);
+
+/*
+ * Comparisons of seqs[i] on trial t of ds, exactly as shellsort() counts
+ * them, into comps[i * ds->trials + t]. ds must be a generated i32 dataset
+ * (dataset_generate(), --generate-seed). Returns 0, or -1 when every
+ * worker has failed or allocation fails.
+ */
+int cluster_evaluate(cluster_t *c, const perm_dataset_t *ds, const gap_sequence_t *const *seqs,
+                     size_t count, uint64_t *comps);
+
+/*
+ * Worker side: listen on port and serve one coordinator connection at a
+ * time with `threads` OpenMP threads per chunk, forever. Returns -1 only
+ * if the socket cannot be set up.
+ */
+int cluster_worker_serve(int port, int threads);
+
+#endif /* CLUSTER_H */
@@ -0,0 +1,562 @@
+#define _GNU_SOURCE
+/*
+ * dataset.c - mmap-based PERMGEN1 / PERMGENX / PERMGEN2 loader
+ */
+
+#include "dataset.h"
+#include "shellsort.h"
+#include "rng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char *const elem_names[ELEM_NUM_TYPES] = {
+    "i32", "i64", "u32", "f32", "f64", "kv"
+};
+
+static const size_t elem_sizes[ELEM_NUM_TYPES] = {
+    sizeof(int32_t), sizeof(int64_t), sizeof(uint32_t),
+    sizeof(float), sizeof(double), sizeof(kv_pair_t)
+};
+
+const char *elem_type_name(elem_type_t type) {
+    if ((unsigned)type >= ELEM_NUM_TYPES) return "unknown";
+    return elem_names[type];
+}
+
+size_t elem_type_size(elem_type_t type) {
+    if ((unsigned)type >= ELEM_NUM_TYPES) return 0;
+    return elem_sizes[type];
+}
+
+int elem_type_parse(const char *name, elem_type_t *type) {
+    for (int i = 0; i < ELEM_NUM_TYPES; i++) {
+        if (strcmp(name, elem_names[i]) == 0) {
+            *type = (elem_type_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int elem_type_check_n(elem_type_t type, uint64_t N) {
+    if (type == ELEM_F32 && N > ELEM_F32_MAX_N) {
+        fprintf(stderr, "Error: --type f32 is exact only for N <= %llu (got N=%lu)\n",
+                (unsigned long long)ELEM_F32_MAX_N, (unsigned long)N);
+        return -1;
+    }
+    return 0;
+}
+
+void dataset_path(char *buf, size_t len, const char *perms_dir, uint64_t N, elem_type_t type) {
+    if (type == ELEM_I32) {
+        snprintf(buf, len, "%s/perm_%lu.bin", perms_dir, (unsigned long)N);
+    } else {
+        snprintf(buf, len, "%s/perm_%lu_%s.bin", perms_dir, (unsigned long)N,
+                 elem_type_name(type));
+    }
+}
+
+int dataset_convert(const int32_t *perm, size_t n, elem_type_t type, void *out) {
+    if (elem_type_check_n(type, n) < 0) return -1;
+    int64_t half = (int64_t)(n / 2);
+
+    switch (type) {
+    case ELEM_I32:
+        memcpy(out, perm, n * sizeof(int32_t));
+        break;
+    case ELEM_I64:
+        for (size_t i = 0; i < n; i++) {
+            ((int64_t *)out)[i] = ((int64_t)perm[i] - half) * 4294967311LL;
+        }
+        break;
+    case ELEM_U32:
+        for (size_t i = 0; i < n; i++) {
+            ((uint32_t *)out)[i] = (uint32_t)perm[i];
+        }
+        break;
+    case ELEM_F32:
+        for (size_t i = 0; i < n; i++) {
+            ((float *)out)[i] = (float)perm[i];
+        }
+        break;
+    case ELEM_F64:
+        for (size_t i = 0; i < n; i++) {
+            ((double *)out)[i] = (double)perm[i] + 0.5;
+        }
+        break;
+    case ELEM_KV:
+        for (size_t i = 0; i < n; i++) {
+            ((kv_pair_t *)out)[i].key = ((int64_t)perm[i] - half) * 4294967311LL;
+            ((kv_pair_t *)out)[i].value = (uint64_t)i;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+void dataset_path_dist(char *buf, size_t len, const char *perms_dir, uint64_t N,
+                       elem_type_t type, const dist_t *dist) {
+    char stem[1024];
+    dataset_path(stem, sizeof(stem), perms_dir, N, type);
+    if (dist->kind == DIST_UNIFORM) {
+        snprintf(buf, len, "%s", stem);
+        return;
+    }
+
+    char label[64];
+    dist_label(dist, label, sizeof(label));
+    snprintf(buf, len, "%.*s_%s.bin", (int)(strlen(stem) - 4), stem, label);
+}
+
+void dataset_path_packed(char *buf, size_t len, const char *perms_dir, uint64_t N,
+                         const dist_t *dist) {
+    char bin[1024];
+    dataset_path_dist(bin, sizeof(bin), perms_dir, N, ELEM_I32, dist);
+    snprintf(buf, len, "%.*s.pg2", (int)(strlen(bin) - 4), bin);
+}
+
+void dataset_path_sums(char *buf, size_t len, const char *data_path) {
+    snprintf(buf, len, "%s.sum", data_path);
+}
+
+/* Map a PERMGEN2 file and check its header and whole index */
+static int load_permgen2(const char *path, int fd, uint64_t N, elem_type_t type,
+                         const dist_t *dist, perm_dataset_t *ds) {
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "Error: Cannot stat %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if ((uint64_t)st.st_size < PERMGEN2_HEADER_SIZE) {
+        fprintf(stderr, "Error: %s is too short for a PERMGEN2 header\n", path);
+        close(fd);
+        return -1;
+    }
+
+    size_t len = (size_t)st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot mmap %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    const permgen2_header_t *hdr = map;
+    const char *err = NULL;
+    if (hdr->magic != PERMGEN2_MAGIC) {
+        err = "invalid magic";
+    } else if (hdr->version != PERMGEN2_VERSION) {
+        err = "unsupported PERMGEN2 version";
+    } else if (hdr->N != N) {
+        err = "N mismatch";
+    } else if (hdr->dist != (uint32_t)dist->kind || hdr->dist_param != dist->param) {
+        err = "distribution mismatch";
+    } else if (hdr->index_offset < PERMGEN2_HEADER_SIZE || hdr->index_offset > len ||
+               hdr->trials > (len - hdr->index_offset) / sizeof(permgen2_index_t)) {
+        err = "index out of bounds";
+    }
+
+    const permgen2_index_t *index =
+        (const permgen2_index_t *)((const char *)map + (err ? 0 : hdr->index_offset));
+    for (uint64_t t = 0; !err && t < hdr->trials; t++) {
+        const permgen2_index_t *e = &index[t];
+        if (e->codec >= PG2_NUM_CODECS) {
+            err = "unknown chunk codec";
+        } else if (e->offset > len || e->length > len - e->offset) {
+            err = "chunk out of bounds";
+        } else if (e->codec == PG2_RAW && e->length != N * sizeof(int32_t)) {
+            err = "raw chunk length mismatch";
+        }
+    }
+    if (err) {
+        fprintf(stderr, "Error: %s in %s\n", err, path);
+        munmap(map, len);
+        return -1;
+    }
+
+    madvise(map, len, MADV_WILLNEED);
+
+    ds->N = N;
+    ds->trials = hdr->trials;
+    ds->master_seed = hdr->master_seed;
+    ds->elem_type = type;
+    ds->elem_size = elem_type_size(type);
+    ds->rng_scheme = (int)hdr->rng_scheme;
+    ds->dist = *dist;
+    ds->index = index;
+    ds->map = map;
+    ds->map_len = len;
+    return 0;
+}
+
+int load_dataset_typed(const char *perms_dir, uint64_t N, elem_type_t type, perm_dataset_t *ds) {
+    dist_t uniform = dist_uniform();
+    return load_dataset_dist(perms_dir, N, type, &uniform, ds);
+}
+
+int load_dataset_dist(const char *perms_dir, uint64_t N, elem_type_t type, const dist_t *dist,
+                      perm_dataset_t *ds) {
+    if (elem_type_check_n(type, N) < 0) return -1;
+
+    char path[1024];
+    dataset_path_dist(path, sizeof(path), perms_dir, N, type, dist);
+
+    memset(ds, 0, sizeof(*ds));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 && errno == ENOENT) {
+        char packed[1024];
+        dataset_path_packed(packed, sizeof(packed), perms_dir, N, dist);
+        fd = open(packed, O_RDONLY);
+        if (fd >= 0) return load_permgen2(packed, fd, N, type, dist, ds);
+        fprintf(stderr, "Error: Cannot open %s or %s: %s\n", path, packed, strerror(errno));
+        return -1;
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "Error: Cannot stat %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if ((uint64_t)st.st_size < PERMGEN1_HEADER_SIZE) {
+        fprintf(stderr, "Error: %s is too short for a PERMGEN1 header\n", path);
+        close(fd);
+        return -1;
+    }
+
+    size_t len = (size_t)st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  /* mapping keeps the file referenced */
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot mmap %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    /* Check header in place */
+    const uint64_t *hdr = (const uint64_t *)map;
+    size_t header_size;
+    elem_type_t file_type;
+    dist_t file_dist = dist_uniform();
+    int file_scheme = RNG_SCHEME_V1;
+
+    if (hdr[0] == PERMGEN1_MAGIC) {
+        header_size = PERMGEN1_HEADER_SIZE;
+        file_type = ELEM_I32;
+    } else if (hdr[0] == PERMGENX_MAGIC && len >= PERMGENX_HEADER_SIZE) {
+        const permgenx_header_t *xh = (const permgenx_header_t *)map;
+        header_size = PERMGENX_HEADER_SIZE;
+        file_type = (elem_type_t)xh->elem_type;
+        if (xh->elem_type >= ELEM_NUM_TYPES || xh->elem_size != elem_type_size(file_type)) {
+            fprintf(stderr, "Error: Unsupported element type %u (size %u) in %s\n",
+                    xh->elem_type, xh->elem_size, path);
+            munmap(map, len);
+            return -1;
+        }
+        if (xh->version >= 2) {
+            file_dist.kind = (dist_kind_t)xh->dist;
+            file_dist.param = xh->dist_param;
+        }
+        if (xh->version >= 3) {
+            file_scheme = (int)xh->rng_scheme;
+            if (file_scheme != RNG_SCHEME_V1 && file_scheme != RNG_SCHEME_V2) {
+                fprintf(stderr, "Error: Unknown RNG scheme %d in %s\n", file_scheme, path);
+                munmap(map, len);
+                return -1;
+            }
+        }
+    } else {
+        fprintf(stderr, "Error: Invalid magic in %s\n", path);
+        munmap(map, len);
+        return -1;
+    }
+
+    if (file_type != type) {
+        fprintf(stderr, "Error: %s holds %s elements, expected %s\n",
+                path, elem_type_name(file_type), elem_type_name(type));
+        munmap(map, len);
+        return -1;
+    }
+
+    if (file_dist.kind != dist->kind || file_dist.param != dist->param) {
+        char want[64], got[64];
+        dist_label(dist, want, sizeof(want));
+        dist_label(&file_dist, got, sizeof(got));
+        fprintf(stderr, "Error: %s holds %s trials, expected %s\n", path, got, want);
+        munmap(map, len);
+        return -1;
+    }
+
+    if (hdr[1] != N) {
+        fprintf(stderr, "Error: N mismatch in %s (expected %lu, got %lu)\n",
+                path, (unsigned long)N, (unsigned long)hdr[1]);
+        munmap(map, len);
+        return -1;
+    }
+
+    size_t elem_size = elem_type_size(type);
+    uint64_t trials = hdr[2];
+    if (N != 0 && trials > (UINT64_MAX - header_size) / elem_size / N) {
+        fprintf(stderr, "Error: Implausible trial count %lu in %s\n",
+                (unsigned long)trials, path);
+        munmap(map, len);
+        return -1;
+    }
+
+    uint64_t expected = header_size + trials * N * elem_size;
+    if ((uint64_t)len != expected) {
+        fprintf(stderr, "Error: Size mismatch in %s (expected %lu bytes, got %lu)\n",
+                path, (unsigned long)expected, (unsigned long)len);
+        munmap(map, len);
+        return -1;
+    }
+
+    /*
+     * Hints only: start readahead now, and ask for transparent huge pages
+     * where the filesystem supports them. Failures are harmless.
+     */
+    madvise(map, len, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(map, len, MADV_HUGEPAGE);
+#endif
+
+    ds->N = N;
+    ds->trials = trials;
+    ds->master_seed = hdr[3];
+    ds->elem_type = type;
+    ds->elem_size = elem_size;
+    ds->raw = (const char *)map + header_size;
+    ds->data = (type == ELEM_I32) ? (const int32_t *)ds->raw : NULL;
+    ds->map = map;
+    ds->map_len = len;
+    ds->dist = file_dist;
+    ds->rng_scheme = file_scheme;
+    return 0;
+}
+
+void dataset_generate(perm_dataset_t *ds, uint64_t N, uint64_t trials,
+                      uint64_t master_seed, elem_type_t type, int rng_scheme) {
+    memset(ds, 0, sizeof(*ds));
+    ds->N = N;
+    ds->trials = trials;
+    ds->master_seed = master_seed;
+    ds->elem_type = type;
+    ds->elem_size = elem_type_size(type);
+    ds->generated = 1;
+    ds->rng_scheme = rng_scheme;
+    ds->dist = dist_uniform();
+}
+
+int dataset_source_args(dataset_source_t *src, int *argc, char **argv) {
+    int out = 1;
+    src->generate = 0;
+    src->seed = 0;
+    src->trials = DATASET_DEFAULT_TRIALS;
+    src->rng_scheme = 0;
+    src->dist = dist_uniform();
+    src->verify = 0;
+
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            src->verify = 1;
+        } else if (strcmp(argv[i], "--generate-seed") == 0 || strcmp(argv[i], "--trials") == 0 ||
+            strcmp(argv[i], "--rng-scheme") == 0) {
+            if (i + 1 >= *argc) {
+                fprintf(stderr, "Error: %s requires a value\n", argv[i]);
+                return -1;
+            }
+            if (strcmp(argv[i], "--generate-seed") == 0) {
+                src->generate = 1;
+                src->seed = strtoull(argv[i + 1], NULL, 0);
+            } else if (strcmp(argv[i], "--trials") == 0) {
+                src->trials = strtoull(argv[i + 1], NULL, 0);
+            } else if ((src->rng_scheme = rng_scheme_parse(argv[i + 1])) < 0) {
+                fprintf(stderr, "Error: Unknown RNG scheme '%s'\n", argv[i + 1]);
+                return -1;
+            }
+            i++;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+
+    *argc = out;
+    argv[out] = NULL;
+    return 0;
+}
+
+int dataset_open(const dataset_source_t *src, uint64_t N, elem_type_t type, perm_dataset_t *ds) {
+    if (src->generate) {
+        if (elem_type_check_n(type, N) < 0) return -1;
+        dataset_generate(ds, N, src->trials, src->seed, type,
+                         src->rng_scheme ? src->rng_scheme : RNG_SCHEME_V1);
+        ds->dist = src->dist;
+        return 0;
+    }
+    if (load_dataset_dist(src->perms_dir, N, type, &src->dist, ds) < 0) return -1;
+    if (src->rng_scheme && src->rng_scheme != ds->rng_scheme) {
+        fprintf(stderr, "Error: N=%lu trials in %s use RNG scheme v%d, not --rng-scheme v%d\n",
+                (unsigned long)N, src->perms_dir, ds->rng_scheme, src->rng_scheme);
+        free_dataset(ds);
+        return -1;
+    }
+    if (src->verify && dataset_verify_enable(ds, src->perms_dir) < 0) {
+        free_dataset(ds);
+        return -1;
+    }
+    return 0;
+}
+
+int dataset_verify_enable(perm_dataset_t *ds, const char *perms_dir) {
+    if (ds->generated) return 0;
+
+    char path[1024], sum_path[1024 + 8];
+    size_t header_size;
+    if (ds->index) {
+        dataset_path_packed(path, sizeof(path), perms_dir, ds->N, &ds->dist);
+        header_size = PERMGEN2_HEADER_SIZE;
+    } else {
+        dataset_path_dist(path, sizeof(path), perms_dir, ds->N, ds->elem_type, &ds->dist);
+        header_size = (size_t)((const char *)ds->raw - (const char *)ds->map);
+    }
+    dataset_path_sums(sum_path, sizeof(sum_path), path);
+
+    uint64_t file_digest;
+    uint64_t *sums;
+    if (digest_read_sums(sum_path, ds->trials, &file_digest, &sums) < 0) return -1;
+
+    /* Catches a sidecar from another file as well as a damaged header */
+    if (digest_file(ds->map, header_size, sums, ds->trials) != file_digest) {
+        fprintf(stderr, "Error: %s does not match the header of %s\n", sum_path, path);
+        free(sums);
+        return -1;
+    }
+
+    ds->verified = calloc(ds->trials ? ds->trials : 1, 1);
+    if (!ds->verified) {
+        free(sums);
+        return -1;
+    }
+    ds->sums = sums;
+    return 0;
+}
+
+uint64_t dataset_verified_count(const perm_dataset_t *ds) {
+    uint64_t count = 0;
+    if (!ds->verified) return 0;
+    for (uint64_t t = 0; t < ds->trials; t++) count += ds->verified[t];
+    return count;
+}
+
+/*
+ * Check trial t (bytes at data) against its digest the first time it is
+ * loaded. Two threads racing on the same trial both hash it, which is
+ * harmless; the flag only saves the repeat work for later sequences.
+ */
+static void verify_trial(const perm_dataset_t *ds, uint64_t t, const void *data, size_t bytes) {
+    uint8_t done;
+    #pragma omp atomic read
+    done = ds->verified[t];
+    if (done) return;
+
+    uint64_t h = digest64(data, bytes, 0);
+    if (h != ds->sums[t]) {
+        fprintf(stderr, "Error: Trial %lu fails verification (xxh64 %016lx, expected %016lx)\n",
+                (unsigned long)t, (unsigned long)h, (unsigned long)ds->sums[t]);
+        exit(1);
+    }
+    #pragma omp atomic write
+    ds->verified[t] = 1;
+}
+
+/* Rebuild int32 trial t of a generated or PERMGEN2 dataset into arr */
+static void fill_trial(const perm_dataset_t *ds, uint64_t t, int32_t *arr) {
+    if (ds->index && ds->index[t].codec != PG2_REPLAY) {
+        const permgen2_index_t *e = &ds->index[t];
+        if (pg2_decode((const uint8_t *)ds->map + e->offset, e, ds->N, arr) < 0) {
+            /* The index was checked at load, so only a damaged chunk gets here */
+            fprintf(stderr, "Error: Corrupt %s chunk for trial %lu\n",
+                    pg2_codec_name((pg2_codec_t)e->codec), (unsigned long)t);
+            exit(1);
+        }
+        return;
+    }
+    dist_generate(arr, ds->N, ds->master_seed, t, ds->rng_scheme, &ds->dist);
+}
+
+void dataset_copy_trial(const perm_dataset_t *ds, uint64_t t, int32_t *arr) {
+    if (ds->generated || ds->index) {
+        fill_trial(ds, t, arr);
+    } else {
+        memcpy(arr, dataset_trial(ds, t), ds->N * sizeof(int32_t));
+    }
+    /* Hash the copy while it is still in cache */
+    if (ds->sums) verify_trial(ds, t, arr, ds->N * sizeof(int32_t));
+}
+
+size_t dataset_load_scratch(const perm_dataset_t *ds) {
+    if (!ds->generated && !ds->index) return 0;
+    size_t bytes = ds->N * ds->elem_size;
+    if (ds->elem_type != ELEM_I32) bytes += ds->N * sizeof(int32_t);
+    return bytes;
+}
+
+const void *dataset_load_trial(const perm_dataset_t *ds, uint64_t t, void *tmp) {
+    if (!ds->generated && !ds->index) {
+        const void *trial = dataset_trial_raw(ds, t);
+        if (ds->sums) verify_trial(ds, t, trial, ds->N * ds->elem_size);
+        return trial;
+    }
+
+    /* Permutation after the converted trial; elem_size keeps it aligned */
+    int32_t *perm = (ds->elem_type == ELEM_I32)
+        ? tmp : (int32_t *)((char *)tmp + ds->N * ds->elem_size);
+    fill_trial(ds, t, perm);
+    /* PERMGEN2 sums cover the int32 permutation, before conversion */
+    if (ds->sums) verify_trial(ds, t, perm, ds->N * sizeof(int32_t));
+    if (ds->elem_type != ELEM_I32) {
+        /* Cannot fail: dataset_open() checked the type against N */
+        dataset_convert(perm, ds->N, ds->elem_type, tmp);
+    }
+    return tmp;
+}
+
+uint64_t dataset_trial_bytes(const perm_dataset_t *ds, uint64_t t) {
+    if (ds->generated) return 0;
+    if (ds->index) return ds->index[t].length;
+    return ds->N * ds->elem_size;
+}
+
+int load_dataset(const char *perms_dir, uint64_t N, perm_dataset_t *ds) {
+    return load_dataset_typed(perms_dir, N, ELEM_I32, ds);
+}
+
+void free_dataset(perm_dataset_t *ds) {
+    if (ds->map) {
+        munmap(ds->map, ds->map_len);
+    }
+    ds->map = NULL;
+    ds->map_len = 0;
+    ds->data = NULL;
+    ds->raw = NULL;
+    ds->index = NULL;
+    free(ds->sums);
+    free(ds->verified);
+    ds->sums = NULL;
+    ds->verified = NULL;
+}
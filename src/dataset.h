@@ -0,0 +1,263 @@
+/*
+ * dataset.h - Shared loader for PERMGEN1 / PERMGENX / PERMGEN2 permutation files
+ *
+ * Files are memory-mapped read-only and the header is checked in place.
+ * Trials are handed out as pointers straight into the mapping, so several
+ * benchmarks run against the same file share the page cache instead of
+ * each holding a private copy.
+ *
+ * Binary format (see permgen.c), int32 datasets, <dir>/perm_<N>.bin:
+ *   - uint64_t magic (0x5045524D47454E31 = "PERMGEN1")
+ *   - uint64_t N
+ *   - uint64_t TRIALS
+ *   - uint64_t master_seed
+ *   - int32_t data[TRIALS][N]
+ *
+ * Extended header for other element types, <dir>/perm_<N>_<type>.bin:
+ *   - uint64_t magic (0x5045524D47454E58 = "PERMGENX")
+ *   - uint64_t N
+ *   - uint64_t TRIALS
+ *   - uint64_t master_seed
+ *   - uint32_t elem_type (elem_type_t)
+ *   - uint32_t elem_size (bytes per element)
+ *   - uint32_t version (PERMGENX_VERSION; 0 in files that predate it)
+ *   - uint32_t dist (dist_kind_t, version >= 2)
+ *   - double dist_param (version >= 2)
+ *   - uint64_t reserved (zero)
+ *   - element data[TRIALS][N], starting at byte 64
+ *
+ * Uniform int32 datasets keep the PERMGEN1 header. Other distributions
+ * (dist.h) always use PERMGENX, int32 included, and add the distribution
+ * label to the name: <dir>/perm_<N>[_<type>]_<label>.bin. PERMGEN1 files
+ * and PERMGENX files without a version are uniform.
+ *
+ * Compressed datasets use the PERMGEN2 container (permgen2.h), named like
+ * the int32 file with a .pg2 extension. It is found when the .bin file does
+ * not exist, for any element type: trials are decoded (or replayed) into
+ * the caller's buffer and converted like generated ones.
+ *
+ * A dataset can also be generated instead of mapped (dataset_generate()):
+ * trial t is rebuilt on demand with rng_permutation(), which is the same
+ * permutation permgen would have written, so no file is needed.
+ *
+ * Files can be verified against the .sum sidecar permgen writes next to
+ * them (digest.h). dataset_verify_enable() only reads the sidecar; each
+ * trial is then hashed the first time dataset_copy_trial() or
+ * dataset_load_trial() hands it out, by whichever worker thread asked for
+ * it, so checking overlaps with faulting the mapping in and costs no
+ * separate pass. A trial that fails its digest is fatal: it would only
+ * produce wrong comparison counts.
+ */
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dist.h"
+#include "permgen2.h"
+#include "digest.h"
+
+#define PERMGEN1_MAGIC 0x5045524D47454E31ULL  /* "PERMGEN1" */
+#define PERMGEN1_HEADER_SIZE 32
+#define PERMGENX_MAGIC 0x5045524D47454E58ULL  /* "PERMGENX" */
+#define PERMGENX_HEADER_SIZE 64
+#define PERMGENX_VERSION 3                    /* 2: dist / dist_param, 3: rng_scheme */
+
+/*
+ * Element types. Non-int32 datasets are derived from the int32 permutation
+ * by an order-preserving map, so every kernel sees the same comparisons.
+ */
+typedef enum {
+    ELEM_I32 = 0,            /* int32_t: the permutation itself */
+    ELEM_I64,                /* int64_t: (p - N/2) * 4294967311 */
+    ELEM_U32,                /* uint32_t: p */
+    ELEM_F32,                /* float: p (N <= ELEM_F32_MAX_N only) */
+    ELEM_F64,                /* double: p + 0.5 */
+    ELEM_KV,                 /* kv_pair_t: key as ELEM_I64, value = position */
+    ELEM_NUM_TYPES
+} elem_type_t;
+
+/* PERMGENX on-disk header */
+typedef struct {
+    uint64_t magic;
+    uint64_t N;
+    uint64_t trials;
+    uint64_t master_seed;
+    uint32_t elem_type;
+    uint32_t elem_size;
+    uint32_t version;
+    uint32_t dist;
+    double dist_param;
+    uint32_t rng_scheme;     /* RNG_SCHEME_* of the trials (version >= 3; older files are V1) */
+    uint32_t reserved;
+} permgenx_header_t;
+
+/* Loaded (mapped) permutation dataset */
+typedef struct {
+    uint64_t N;
+    uint64_t trials;
+    uint64_t master_seed;
+    elem_type_t elem_type;
+    size_t elem_size;        /* Bytes per element */
+    const int32_t *data;     /* trials * N elements (ELEM_I32 only, else NULL) */
+    const void *raw;         /* Element data of any type, points into the mapping */
+    void *map;               /* Base of the mapping (header included) */
+    size_t map_len;          /* Length of the mapping in bytes */
+    int generated;           /* 1: no file, trials are rebuilt from master_seed */
+    int rng_scheme;          /* RNG_SCHEME_* the trials were derived with (from the header for files) */
+    dist_t dist;             /* Input distribution of the trials */
+    const permgen2_index_t *index; /* PERMGEN2: per-trial chunk index, else NULL */
+    uint64_t *sums;          /* Expected trial digests once verification is enabled, else NULL */
+    uint8_t *verified;       /* Per-trial flag: digest already checked */
+} perm_dataset_t;
+
+/* Where a harness gets its trials: a perms directory or a generator seed */
+typedef struct {
+    const char *perms_dir;   /* Used when generate == 0 */
+    int generate;            /* 1: --generate-seed mode */
+    uint64_t seed;           /* Master seed for generated trials */
+    uint64_t trials;         /* Trials per size for generated trials */
+    int rng_scheme;          /* RNG_SCHEME_* from --rng-scheme, 0 if not given (V1 when generating) */
+    dist_t dist;             /* Distribution to load or generate (default uniform) */
+    int verify;              /* 1: --verify, check trial digests as they are loaded */
+} dataset_source_t;
+
+/* Default trial count for --generate-seed when --trials is not given */
+#define DATASET_DEFAULT_TRIALS 100
+
+/* Short name ("i32", "i64", "u32", "f32", "f64", "kv") */
+const char *elem_type_name(elem_type_t type);
+
+/* Bytes per element of the given type */
+size_t elem_type_size(elem_type_t type);
+
+/* Parse a short name; returns 0 on success, -1 if unknown */
+int elem_type_parse(const char *name, elem_type_t *type);
+
+/*
+ * Largest N for ELEM_F32: floats hold every integer up to 2^24 exactly, so
+ * above it distinct permutation values round to equal keys and the counts
+ * no longer match the int32 dataset.
+ */
+#define ELEM_F32_MAX_N (1ULL << 24)
+
+/* 0 if N elements of type keep the permutation's distinct keys; else -1 with a message */
+int elem_type_check_n(elem_type_t type, uint64_t N);
+
+/* Dataset file path for (N, type): perm_<N>.bin for int32, else perm_<N>_<type>.bin */
+void dataset_path(char *buf, size_t len, const char *perms_dir, uint64_t N, elem_type_t type);
+
+/* Same as dataset_path() with the _<label> suffix for non-uniform distributions */
+void dataset_path_dist(char *buf, size_t len, const char *perms_dir, uint64_t N,
+                       elem_type_t type, const dist_t *dist);
+
+/* PERMGEN2 path for (N, dist): perm_<N>[_<label>].pg2 */
+void dataset_path_packed(char *buf, size_t len, const char *perms_dir, uint64_t N,
+                         const dist_t *dist);
+
+/* .sum sidecar of a dataset file: its path with ".sum" appended (perm_<N>.bin.sum) */
+void dataset_path_sums(char *buf, size_t len, const char *data_path);
+
+/*
+ * Map <perms_dir>/perm_<N>.bin (int32) and validate its header.
+ *
+ * Checks magic, that the stored N matches the requested N, and that the
+ * file size matches header + TRIALS * N * elem_size bytes.
+ *
+ * Returns 0 on success, -1 on error (message printed to stderr).
+ */
+int load_dataset(const char *perms_dir, uint64_t N, perm_dataset_t *ds);
+
+/* Same as load_dataset() for a dataset of the given element type */
+int load_dataset_typed(const char *perms_dir, uint64_t N, elem_type_t type, perm_dataset_t *ds);
+
+/*
+ * Same as load_dataset_typed() for distribution dist; the header must
+ * record the same distribution. Falls back to the PERMGEN2 file when the
+ * .bin file does not exist.
+ */
+int load_dataset_dist(const char *perms_dir, uint64_t N, elem_type_t type, const dist_t *dist,
+                      perm_dataset_t *ds);
+
+/*
+ * Set up a generated dataset of `trials` permutations of size N. Nothing is
+ * allocated; data and raw stay NULL and trials are produced by
+ * dataset_copy_trial() / dataset_load_trial(). The distribution is
+ * uniform; set ds->dist afterwards for another one.
+ */
+void dataset_generate(perm_dataset_t *ds, uint64_t N, uint64_t trials,
+                      uint64_t master_seed, elem_type_t type, int rng_scheme);
+
+/*
+ * Read the .sum sidecar of a loaded dataset (from the same perms_dir) and
+ * check it against the file header, then verify every trial as it is
+ * first loaded (see above). A no-op for generated datasets. Returns 0, or
+ * -1 with a message on stderr if the sidecar is missing or does not match.
+ */
+int dataset_verify_enable(perm_dataset_t *ds, const char *perms_dir);
+
+/* Trials verified so far */
+uint64_t dataset_verified_count(const perm_dataset_t *ds);
+
+/*
+ * Strip "--generate-seed <hex>", "--trials <T>", "--rng-scheme v1|v2" and
+ * "--verify" from argv, recording them in src, so positional-argument
+ * tools can take them anywhere on the command line. src->perms_dir is
+ * left untouched. Returns 0, or -1 if a
+ * flag is missing its value.
+ */
+int dataset_source_args(dataset_source_t *src, int *argc, char **argv);
+
+/*
+ * load_dataset_dist() or dataset_generate(), depending on src, followed by
+ * dataset_verify_enable() for --verify
+ */
+int dataset_open(const dataset_source_t *src, uint64_t N, elem_type_t type, perm_dataset_t *ds);
+
+/*
+ * Unmap a dataset loaded with load_dataset() and drop its digests. Safe to
+ * call twice, and a no-op for generated datasets.
+ */
+void free_dataset(perm_dataset_t *ds);
+
+/* Pointer to the first element of trial t (no copy, ELEM_I32 only) */
+static inline const int32_t *dataset_trial(const perm_dataset_t *ds, uint64_t t) {
+    return ds->data + t * ds->N;
+}
+
+/* Pointer to the first element of trial t for any element type (mapped only) */
+static inline const void *dataset_trial_raw(const perm_dataset_t *ds, uint64_t t) {
+    return (const char *)ds->raw + t * ds->N * ds->elem_size;
+}
+
+/* Copy int32 trial t into arr (N elements), regenerating or decoding it if needed */
+void dataset_copy_trial(const perm_dataset_t *ds, uint64_t t, int32_t *arr);
+
+/*
+ * Bytes of scratch dataset_load_trial() needs: 0 for a mapped raw dataset,
+ * otherwise room for one converted trial plus its int32 permutation.
+ */
+size_t dataset_load_scratch(const perm_dataset_t *ds);
+
+/*
+ * Pointer to trial t of any element type: into the mapping, or rebuilt in
+ * tmp (dataset_load_scratch() bytes) for a generated or PERMGEN2 dataset.
+ */
+const void *dataset_load_trial(const perm_dataset_t *ds, uint64_t t, void *tmp);
+
+/*
+ * File bytes one load of trial t reads: its data in a raw file, its chunk
+ * in a PERMGEN2 file (0 for a replay chunk), 0 for a generated dataset
+ */
+uint64_t dataset_trial_bytes(const perm_dataset_t *ds, uint64_t t);
+
+/*
+ * Convert an int32 permutation of 0..n-1 to element type `type` in out
+ * (n * elem_type_size(type) bytes), using the maps listed in elem_type_t.
+ * Returns 0, or -1 (see elem_type_check_n()) if the map would not be exact.
+ */
+int dataset_convert(const int32_t *perm, size_t n, elem_type_t type, void *out);
+
+#endif /* DATASET_H */
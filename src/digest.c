@@ -0,0 +1,172 @@
+/*
+ * digest.c - XXH64 and .sum sidecars (see digest.h)
+ */
+
+#include "digest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define P1 11400714785074694791ULL
+#define P2 14029467366897019727ULL
+#define P3 1609587929392839161ULL
+#define P4 9650029242287828579ULL
+#define P5 2870177450012600261ULL
+
+static inline uint64_t xxh_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = xxh_rotl(acc, 31);
+    return acc * P1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * P1 + P4;
+}
+
+uint64_t digest64(const void *buf, size_t len, uint64_t seed) {
+    const uint8_t *p = buf;
+    const uint8_t *end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + P1 + P2;
+        uint64_t v2 = seed + P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - P1;
+        const uint8_t *limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + P5;
+    }
+
+    h += (uint64_t)len;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxh_round(0, read64(p));
+        h = xxh_rotl(h, 27) * P1 + P4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * P1;
+        h = xxh_rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)(*p) * P5;
+        h = xxh_rotl(h, 11) * P1;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t digest_file(const void *header, size_t header_len, const uint64_t *sums,
+                     uint64_t trials) {
+    size_t len = header_len + trials * sizeof(uint64_t);
+    uint8_t *buf = malloc(len ? len : 1);
+    if (!buf) return 0;
+    memcpy(buf, header, header_len);
+    memcpy(buf + header_len, sums, trials * sizeof(uint64_t));
+    uint64_t h = digest64(buf, len, 0);
+    free(buf);
+    return h;
+}
+
+int digest_write_sums(const char *path, uint64_t file_digest, const uint64_t *sums,
+                      uint64_t trials) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fprintf(f, "%s xxh64\n", DIGEST_SUM_MAGIC);
+    fprintf(f, "file %016lx\n", (unsigned long)file_digest);
+    fprintf(f, "trials %lu\n", (unsigned long)trials);
+    for (uint64_t t = 0; t < trials; t++) {
+        fprintf(f, "%016lx\n", (unsigned long)sums[t]);
+    }
+    if (fclose(f) != 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int digest_read_sums(const char *path, uint64_t trials, uint64_t *file_digest, uint64_t **sums) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char magic[16], algo[16];
+    unsigned long fd_hex, count;
+    if (fscanf(f, "%15s %15s", magic, algo) != 2 || strcmp(magic, DIGEST_SUM_MAGIC) != 0 ||
+        strcmp(algo, "xxh64") != 0 || fscanf(f, " file %lx", &fd_hex) != 1 ||
+        fscanf(f, " trials %lu", &count) != 1) {
+        fprintf(stderr, "Error: %s is not a %s file\n", path, DIGEST_SUM_MAGIC);
+        fclose(f);
+        return -1;
+    }
+    if (count != trials) {
+        fprintf(stderr, "Error: %s lists %lu trials, dataset has %lu\n",
+                path, count, (unsigned long)trials);
+        fclose(f);
+        return -1;
+    }
+
+    uint64_t *s = malloc((trials ? trials : 1) * sizeof(uint64_t));
+    if (!s) {
+        fclose(f);
+        return -1;
+    }
+    for (uint64_t t = 0; t < trials; t++) {
+        unsigned long v;
+        if (fscanf(f, " %lx", &v) != 1) {
+            fprintf(stderr, "Error: %s is truncated at trial %lu\n", path, (unsigned long)t);
+            free(s);
+            fclose(f);
+            return -1;
+        }
+        s[t] = v;
+    }
+    fclose(f);
+
+    *file_digest = fd_hex;
+    *sums = s;
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * digest.h - Dataset checksums
+ *
+ * digest64() is XXH64 (seed 0 for dataset sums), so a digest can be
+ * cross-checked with any xxHash implementation, e.g. `xxhsum -H1` on a
+ * trial extracted with dd. It runs at several GB/s per core, far below
+ * the cost of sorting the same trial.
+ *
+ * permgen writes a sidecar next to each dataset file, <file>.sum (so
+ * perm_<N>.bin.sum and perm_<N>.pg2.sum):
+ *
+ *   PERMSUM1 xxh64
+ *   file <16 hex digits>
+ *   trials <T>
+ *   <16 hex digits>            one line per trial, in trial order
+ *
+ * Trial digests cover the trial as an array of the file's element type
+ * (int32 for PERMGEN1 and PERMGEN2, so both formats of the same data share
+ * their sums). The file digest is digest64() of the data file's fixed
+ * header followed by the trial digests, so it is computed in parallel and
+ * still changes with any trial; it is also recorded in .meta.
+ */
+
+#ifndef DIGEST_H
+#define DIGEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DIGEST_SUM_MAGIC "PERMSUM1"
+
+/* XXH64 of len bytes at buf */
+uint64_t digest64(const void *buf, size_t len, uint64_t seed);
+
+/* File digest from the header bytes and the trial digests (see above) */
+uint64_t digest_file(const void *header, size_t header_len, const uint64_t *sums,
+                     uint64_t trials);
+
+/* Write a .sum sidecar. Returns 0, or -1 with a message on stderr. */
+int digest_write_sums(const char *path, uint64_t file_digest, const uint64_t *sums,
+                      uint64_t trials);
+
+/*
+ * Read a .sum sidecar into a malloc()ed array of `trials` digests.
+ * Returns 0, or -1 with a message on stderr (missing file, bad format,
+ * trial count other than `trials`).
+ */
+int digest_read_sums(const char *path, uint64_t trials, uint64_t *file_digest, uint64_t **sums);
+
+#endif /* DIGEST_H */
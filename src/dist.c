@@ -0,0 +1,197 @@
+/*
+ * dist.c - Input distributions for generated datasets (see dist.h)
+ */
+
+#include "dist.h"
+#include "rng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char *const dist_names[DIST_NUM_KINDS] = {
+    "uniform", "sorted", "swaps", "runs", "reversed", "organ-pipe", "dups", "zipf"
+};
+
+/* Default parameter per mode; NAN marks parameterless modes */
+static const double dist_defaults[DIST_NUM_KINDS] = {
+    NAN, 0.9, 100, 16, NAN, NAN, 16, 1.0
+};
+
+const char *dist_kind_name(dist_kind_t kind) {
+    if ((unsigned)kind >= DIST_NUM_KINDS) return "unknown";
+    return dist_names[kind];
+}
+
+static int param_valid(dist_kind_t kind, double p) {
+    switch (kind) {
+        case DIST_SORTED: return p >= 0.0 && p <= 1.0;
+        case DIST_SWAPS:  return p >= 0.0 && p == floor(p);
+        case DIST_RUNS:   return p >= 1.0 && p <= DIST_MAX_RUNS && p == floor(p);
+        case DIST_DUPS:   return p >= 1.0 && p == floor(p);
+        case DIST_ZIPF:   return p > 0.0;
+        default:          return 0;
+    }
+}
+
+int dist_parse(const char *spec, dist_t *d) {
+    const char *colon = strchr(spec, ':');
+    size_t len = colon ? (size_t)(colon - spec) : strlen(spec);
+
+    for (int k = 0; k < DIST_NUM_KINDS; k++) {
+        if (strlen(dist_names[k]) != len || strncmp(spec, dist_names[k], len) != 0) continue;
+
+        d->kind = (dist_kind_t)k;
+        d->param = isnan(dist_defaults[k]) ? 0.0 : dist_defaults[k];
+        if (!colon) return 0;
+
+        char *end;
+        double p = strtod(colon + 1, &end);
+        if (isnan(dist_defaults[k]) || end == colon + 1 || *end != '\0' ||
+            !param_valid(d->kind, p)) {
+            return -1;
+        }
+        d->param = p;
+        return 0;
+    }
+    return -1;
+}
+
+void dist_label(const dist_t *d, char *buf, size_t len) {
+    if ((unsigned)d->kind < DIST_NUM_KINDS && isnan(dist_defaults[d->kind])) {
+        snprintf(buf, len, "%s", dist_kind_name(d->kind));
+    } else {
+        snprintf(buf, len, "%s-%g", dist_kind_name(d->kind), d->param);
+    }
+}
+
+/* Uniform double in [0, 1) */
+static double unit_double(rng_state_t *rng) {
+    return (double)(rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+/*
+ * Zipf(s) over 1..n by rejection-inversion (Hormann & Derflinger 1996):
+ * constant expected time, no tables.
+ */
+typedef struct {
+    double s;
+    double h_x1;             /* H(1.5) - 1 */
+    double h_n;              /* H(n + 0.5) */
+    double threshold;
+    uint64_t n;
+} zipf_t;
+
+/* (exp(x) - 1) / x and log(1 + x) / x, continuous at 0 */
+static double expm1_over(double x) { return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x / 2.0; }
+static double log1p_over(double x) { return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x / 2.0; }
+
+static double zipf_h(const zipf_t *z, double x) { return exp(-z->s * log(x)); }
+
+static double zipf_hint(const zipf_t *z, double x) {
+    double lx = log(x);
+    return expm1_over((1.0 - z->s) * lx) * lx;
+}
+
+static double zipf_hint_inv(const zipf_t *z, double x) {
+    double t = x * (1.0 - z->s);
+    if (t < -1.0) t = -1.0;  /* Rounding guard */
+    return exp(log1p_over(t) * x);
+}
+
+static void zipf_init(zipf_t *z, uint64_t n, double s) {
+    z->s = s;
+    z->n = n;
+    z->h_x1 = zipf_hint(z, 1.5) - 1.0;
+    z->h_n = zipf_hint(z, (double)n + 0.5);
+    z->threshold = 2.0 - zipf_hint_inv(z, zipf_hint(z, 2.5) - zipf_h(z, 2.0));
+}
+
+static uint64_t zipf_next(const zipf_t *z, rng_state_t *rng) {
+    for (;;) {
+        double u = z->h_n + unit_double(rng) * (z->h_x1 - z->h_n);
+        double x = zipf_hint_inv(z, u);
+        double kf = floor(x + 0.5);
+        if (kf < 1.0) kf = 1.0;
+        if (kf > (double)z->n) kf = (double)z->n;
+        if (kf - x <= z->threshold || u >= zipf_hint(z, kf + 0.5) - zipf_h(z, kf)) {
+            return (uint64_t)kf;
+        }
+    }
+}
+
+void dist_generate(int32_t *arr, uint64_t n, uint64_t master_seed, uint64_t trial,
+                   int rng_scheme, const dist_t *d) {
+    rng_state_t rng;
+
+    switch (d->kind) {
+    case DIST_SORTED: {
+        uint64_t m = (uint64_t)(d->param * (double)n);
+        if (m > n) m = n;
+        for (uint64_t i = 0; i < n; i++) arr[i] = (int32_t)i;
+        rng_seed(&rng, derive_seed(master_seed, n, trial));
+        if (n - m >= 2) rng_shuffle(&rng, arr + m, n - m);
+        break;
+    }
+    case DIST_SWAPS: {
+        for (uint64_t i = 0; i < n; i++) arr[i] = (int32_t)i;
+        rng_seed(&rng, derive_seed(master_seed, n, trial));
+        uint64_t k = (uint64_t)d->param;
+        for (uint64_t s = 0; s < k && n > 1; s++) {
+            uint64_t a = rng_uniform(&rng, n);
+            uint64_t b = rng_uniform(&rng, n);
+            int32_t tmp = arr[a];
+            arr[a] = arr[b];
+            arr[b] = tmp;
+        }
+        break;
+    }
+    case DIST_RUNS: {
+        /* Each value picks a run; replay the same draws to place them */
+        uint64_t r = (uint64_t)d->param;
+        uint64_t cursor[DIST_MAX_RUNS];
+        memset(cursor, 0, r * sizeof(uint64_t));
+        uint64_t seed = derive_seed(master_seed, n, trial);
+
+        rng_seed(&rng, seed);
+        for (uint64_t v = 0; v < n; v++) cursor[rng_uniform(&rng, r)]++;
+        uint64_t start = 0;
+        for (uint64_t k = 0; k < r; k++) {
+            uint64_t c = cursor[k];
+            cursor[k] = start;
+            start += c;
+        }
+        rng_seed(&rng, seed);
+        for (uint64_t v = 0; v < n; v++) arr[cursor[rng_uniform(&rng, r)]++] = (int32_t)v;
+        break;
+    }
+    case DIST_REVERSED:
+        for (uint64_t i = 0; i < n; i++) arr[i] = (int32_t)(n - 1 - i);
+        break;
+    case DIST_ORGAN_PIPE: {
+        uint64_t half = (n + 1) / 2;
+        for (uint64_t i = 0; i < half; i++) arr[i] = (int32_t)(2 * i);
+        for (uint64_t i = half; i < n; i++) arr[i] = (int32_t)(2 * (n - 1 - i) + 1);
+        break;
+    }
+    case DIST_DUPS: {
+        uint64_t k = (uint64_t)d->param < n ? (uint64_t)d->param : n;
+        rng_permutation_scheme(arr, n, master_seed, trial, rng_scheme);
+        for (uint64_t i = 0; i < n; i++) {
+            arr[i] = (int32_t)((uint64_t)arr[i] * k / n);
+        }
+        break;
+    }
+    case DIST_ZIPF: {
+        zipf_t z;
+        zipf_init(&z, n, d->param);
+        rng_seed(&rng, derive_seed(master_seed, n, trial));
+        for (uint64_t i = 0; i < n; i++) arr[i] = (int32_t)(zipf_next(&z, &rng) - 1);
+        break;
+    }
+    default:
+        rng_permutation_scheme(arr, n, master_seed, trial, rng_scheme);
+        break;
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * dist.h - Input distributions for generated datasets
+ *
+ * Every trial is a pure function of (master_seed, N, trial, distribution),
+ * like the uniform permutations, so permgen files and --generate-seed runs
+ * agree for every mode. Values are int32 in [0, N), so the element-type
+ * maps in dataset.h still apply; modes with repeated keys (dups, zipf) are
+ * no longer permutations.
+ *
+ * Modes, written name[:param] on the command line:
+ *   uniform        rng_permutation_scheme(), the reference datasets
+ *   sorted:f       first f*N slots in order, the rest a random permutation of
+ *                  the larger values (sorted data with appended records,
+ *                  default f = 0.9)
+ *   swaps:k        identity with k random transpositions (default 100)
+ *   runs:r         random interleaving of r ascending runs (default 16)
+ *   reversed       N-1 down to 0
+ *   organ-pipe     even values ascending, then odd values descending
+ *   dups:k         uniform permutation mapped to k distinct keys (default 16)
+ *   zipf:s         i.i.d. Zipf(s) ranks over 1..N, minus one (default 1.0)
+ *
+ * Non-uniform modes other than dups draw from the V1 generator seeded with
+ * derive_seed(master, N, trial); the RNG scheme only selects the uniform
+ * permutation that uniform and dups start from.
+ */
+
+#ifndef DIST_H
+#define DIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    DIST_UNIFORM = 0,
+    DIST_SORTED,
+    DIST_SWAPS,
+    DIST_RUNS,
+    DIST_REVERSED,
+    DIST_ORGAN_PIPE,
+    DIST_DUPS,
+    DIST_ZIPF,
+    DIST_NUM_KINDS
+} dist_kind_t;
+
+/* Upper bound on runs:r (the run cursors live on the stack) */
+#define DIST_MAX_RUNS 4096
+
+typedef struct {
+    dist_kind_t kind;
+    double param;            /* Mode parameter (0 for parameterless modes) */
+} dist_t;
+
+/* The uniform distribution */
+static inline dist_t dist_uniform(void) {
+    dist_t d = { DIST_UNIFORM, 0.0 };
+    return d;
+}
+
+/* Mode name ("uniform", "swaps", ...) */
+const char *dist_kind_name(dist_kind_t kind);
+
+/*
+ * Parse "name[:param]". A missing parameter takes the default listed
+ * above. Returns 0 on success, -1 if the name or parameter is invalid.
+ */
+int dist_parse(const char *spec, dist_t *d);
+
+/*
+ * File-name-safe label: "uniform", "reversed", "swaps-100", "sorted-0.9".
+ * Also used for the .meta "dist" field and the bench dist column.
+ */
+void dist_label(const dist_t *d, char *buf, size_t len);
+
+/* Fill arr (n int32) with trial `trial` of distribution d */
+void dist_generate(int32_t *arr, uint64_t n, uint64_t master_seed, uint64_t trial,
+                   int rng_scheme, const dist_t *d);
+
+#endif /* DIST_H */
@@ -0,0 +1,77 @@
+/*
+ * estimate.c - Sub-sampled size estimates of comparison counts (estimate.h)
+ */
+
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "estimate.h"
+
+void estimate_config_default(estimate_config_t *cfg) {
+    cfg->levels = 3;
+    cfg->shift = 3;
+    cfg->min_n = 1000;
+    cfg->trials = 0;
+}
+
+int estimate_comparisons(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                         const estimate_config_t *cfg, const scratch_pool_t *scratch, int threads,
+                         estimate_t *out) {
+    uint64_t N = ds->N;
+    uint64_t trials = cfg->trials && cfg->trials < ds->trials ? cfg->trials : ds->trials;
+
+    /* Segment k sits right after segment k-1; together they stay under N */
+    uint64_t lens[ESTIMATE_MAX_LEVELS], offs[ESTIMATE_MAX_LEVELS];
+    int levels = 0;
+    uint64_t off = 0;
+    for (int k = 1; k <= cfg->levels && levels < ESTIMATE_MAX_LEVELS; k++) {
+        if (cfg->shift * k >= 64) break;
+        uint64_t n = N >> (cfg->shift * k);
+        if (n < cfg->min_n || n < 2) break;
+        lens[levels] = n;
+        offs[levels] = off;
+        off += n;
+        levels++;
+    }
+    if (levels < 2 || off > N || trials == 0) return -1;
+
+    uint64_t totals[ESTIMATE_MAX_LEVELS] = {0};
+
+    #pragma omp parallel for schedule(static) num_threads(threads) \
+        reduction(+:totals[:ESTIMATE_MAX_LEVELS])
+    for (uint64_t t = 0; t < trials; t++) {
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
+        for (int k = 0; k < levels; k++) {
+            totals[k] += shellsort(arr + offs[k], lens[k], seq);
+        }
+    }
+
+    /* Least squares of comparisons/n against log2 n */
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int k = 0; k < levels; k++) {
+        double x = log2((double)lens[k]);
+        double y = (double)totals[k] / ((double)trials * (double)lens[k]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double m = (double)levels;
+    double b = (m * sxy - sx * sy) / (m * sxx - sx * sx);
+    double a = (sy - b * sx) / m;
+
+    out->a = a;
+    out->b = b;
+    out->comparisons = (double)N * (a + b * log2((double)N));
+    out->levels = levels;
+    out->elements = off * trials;
+    return 0;
+}
+
+double estimate_relative(const estimate_t *cand, const estimate_t *ref, double ref_exact) {
+    return ref_exact * cand->comparisons / ref->comparisons;
+}
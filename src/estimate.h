@@ -0,0 +1,70 @@
+/*
+ * estimate.h - Cheap comparison-count estimates from sub-sampled sizes
+ *
+ * Mean comparisons per element of a fixed gap sequence grow close to
+ * linearly in log2 N over the range this project searches (the per-size
+ * tables in the README). The estimator sorts short, disjoint segments of
+ * each trial - N/8, N/64, N/512 elements by default, a uniform random
+ * permutation each for a uniform dataset - with the gaps that apply at
+ * that length, fits comparisons/n = a + b * log2 n by least squares and
+ * reads the fit off at N. That costs about a seventh of one full sort per
+ * trial.
+ *
+ * Gaps above the largest segment are never exercised, so two sequences
+ * that differ only in their top gaps get the same estimate, and the error
+ * is mostly specific to each sequence. estimate_relative() scales an
+ * exactly measured reference (Ciura, computed once per size) by the ratio
+ * of the two fits; that removes only the reference's own error, so it is
+ * not reliably better than the raw estimate. Measured with estimate_bench
+ * (10 trials, 8 mutants), the mean relative error is 0.76-0.83% at N=100K
+ * (max 2-3.4%) and 2.4% at N=1M (max 23% for a mutant with bad top gaps;
+ * 0.75% without it). That is several times the ~0.3% gaps between good
+ * candidates: use estimates only to prune clearly worse sequences with a
+ * wide margin, never to rank close ones, and rerun estimate_bench on the
+ * dataset before relying on them.
+ */
+
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "shellsort.h"
+#include "dataset.h"
+#include "scratch.h"
+
+/* Most segment sizes one estimate fits */
+#define ESTIMATE_MAX_LEVELS 8
+
+typedef struct {
+    int levels;              /* Segment sizes fitted (default 3, at least 2) */
+    int shift;               /* Segment k has N >> (shift * k) elements (default 3) */
+    uint64_t min_n;          /* Smaller segments are dropped (default 1000) */
+    uint64_t trials;         /* Trials sampled, 0 = all (default 0) */
+} estimate_config_t;
+
+typedef struct {
+    double a, b;             /* comparisons/n ~ a + b * log2 n */
+    double comparisons;      /* Extrapolated mean comparisons at ds->N */
+    int levels;              /* Segment sizes actually fitted */
+    uint64_t elements;       /* Elements sorted in total, all trials */
+} estimate_t;
+
+void estimate_config_default(estimate_config_t *cfg);
+
+/*
+ * Estimate the mean comparisons of seq on ds. scratch must hold N int32 per
+ * thread. Returns 0, or -1 if fewer than two segment sizes reach min_n.
+ */
+int estimate_comparisons(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                         const estimate_config_t *cfg, const scratch_pool_t *scratch, int threads,
+                         estimate_t *out);
+
+/*
+ * Estimate of a candidate corrected by a reference sequence whose mean at
+ * this size is known exactly: ref_exact * cand / ref.
+ */
+double estimate_relative(const estimate_t *cand, const estimate_t *ref, double ref_exact);
+
+#endif /* ESTIMATE_H */
@@ -0,0 +1,291 @@
+#define _GNU_SOURCE
+/*
+ * estimate_bench.c - Calibrate estimate.h against exact comparison counts
+ *
+ * Usage: ./estimate_bench [perms_dir] [threads] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                         [--sizes n1,n2,...] [--mutants M] [--seed <hex>] [--levels L]
+ *                         [--shift S] [--min-n n] [--est-trials T] [--margin P]
+ *
+ * For every size the baselines and M random perturbations of Evolved are
+ * scored twice: exactly, as shellsort_stats() counts them over all trials,
+ * and with the sub-sampled estimator, raw and relative to Ciura's exact
+ * mean. The report gives each estimate's error, the Spearman rank
+ * correlation of the relative estimates with the exact means, the time
+ * ratio, and how pruning at a margin would have gone: a candidate is
+ * discarded when its relative estimate is more than P% above Ciura, and a
+ * discard is wrong when its exact mean is below Ciura's.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "rng.h"
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "estimate.h"
+#include "cli.h"
+#include "timing.h"
+
+#define MAX_SIZES 16
+#define MAX_MUTANTS 64
+#define NUM_CANDIDATE_BASELINES 7     /* gaps_baselines.h sequences incl. Evolved */
+#define MAX_SEQS (NUM_CANDIDATE_BASELINES + MAX_MUTANTS)
+#define DEFAULT_SEED 0xE57A7EULL
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [perms_dir] [threads] [--generate-seed <hex> [--trials T]]\n"
+                    "       [--sizes n1,n2,...] [--mutants M] [--seed <hex>] [--levels L]\n"
+                    "       [--shift S] [--min-n n] [--est-trials T] [--margin P]\n", prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --sizes <list>    Sizes to calibrate (default: 1000000,2000000,4000000,8000000)\n");
+    fprintf(stderr, "  --mutants M       Perturbed Evolved sequences added (default: 8, max %d)\n",
+            MAX_MUTANTS);
+    fprintf(stderr, "  --seed <hex>      Seed of the perturbations (default: 0x%llX)\n",
+            (unsigned long long)DEFAULT_SEED);
+    fprintf(stderr, "  --levels L        Segment sizes fitted (default: 3)\n");
+    fprintf(stderr, "  --shift S         Segment k holds N >> (S * k) elements (default: 3)\n");
+    fprintf(stderr, "  --min-n n         Smallest segment kept (default: 1000)\n");
+    fprintf(stderr, "  --est-trials T    Trials the estimator samples (default: all)\n");
+    fprintf(stderr, "  --margin P        Prune above Ciura + P%% (default: 0.5)\n");
+}
+
+/* Evolved with every gap above 10 scaled by a random factor in [0.93, 1.07] */
+static void perturbed_evolved(gap_sequence_t *seq, uint64_t N, rng_state_t *rng) {
+    gaps_evolved(seq, N);
+    for (size_t i = 0; i < seq->num_gaps; i++) {
+        if (i == 0 || seq->gaps[i] <= 10) continue;
+        double f = 0.93 + 0.14 * (double)rng_uniform(rng, 1000001) / 1e6;
+        uint64_t g = (uint64_t)((double)seq->gaps[i] * f + 0.5);
+        if (g <= seq->gaps[i - 1]) g = seq->gaps[i - 1] + 1;
+        seq->gaps[i] = g;
+    }
+    /* Keep the sequence increasing and below N after scaling up */
+    while (seq->num_gaps > 1 && seq->gaps[seq->num_gaps - 1] >= N) seq->num_gaps--;
+}
+
+static double exact_mean(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                         const scratch_pool_t *scratch, int threads) {
+    uint64_t N = ds->N;
+    uint64_t trials = ds->trials;
+    uint64_t total = 0;
+
+    #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:total)
+    for (uint64_t t = 0; t < trials; t++) {
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
+        total += shellsort_stats(arr, N, seq).comparisons;
+    }
+    return (double)total / (double)trials;
+}
+
+/* Ranks of x[0..n), ties sharing their mean rank */
+static void ranks(const double *x, size_t n, double *r) {
+    for (size_t i = 0; i < n; i++) {
+        size_t below = 0, equal = 0;
+        for (size_t j = 0; j < n; j++) {
+            if (x[j] < x[i]) below++;
+            else if (x[j] == x[i]) equal++;
+        }
+        r[i] = (double)below + (double)(equal + 1) / 2.0;
+    }
+}
+
+static double spearman(const double *x, const double *y, size_t n) {
+    double rx[MAX_SEQS], ry[MAX_SEQS];
+    ranks(x, n, rx);
+    ranks(y, n, ry);
+    double mean = (double)(n + 1) / 2.0;
+    double sxy = 0, sxx = 0, syy = 0;
+    for (size_t i = 0; i < n; i++) {
+        sxy += (rx[i] - mean) * (ry[i] - mean);
+        sxx += (rx[i] - mean) * (rx[i] - mean);
+        syy += (ry[i] - mean) * (ry[i] - mean);
+    }
+    return sxx > 0 && syy > 0 ? sxy / sqrt(sxx * syy) : 0;
+}
+
+int main(int argc, char **argv) {
+    const char *perms_dir = "results/perms";
+    int threads = 16;
+    uint64_t sizes[MAX_SIZES] = {1000000, 2000000, 4000000, 8000000};
+    size_t num_sizes = 4;
+    int mutants = 8;
+    uint64_t seed = DEFAULT_SEED;
+    double margin = 0.5;
+
+    estimate_config_t cfg;
+    estimate_config_default(&cfg);
+
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+
+    int npos = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 2, sizes, MAX_SIZES, &num_sizes) < 0) {
+                fprintf(stderr, "Error: Invalid sizes list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mutants") == 0 && i + 1 < argc) {
+            mutants = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 16);
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            cfg.levels = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shift") == 0 && i + 1 < argc) {
+            cfg.shift = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--min-n") == 0 && i + 1 < argc) {
+            cfg.min_n = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--est-trials") == 0 && i + 1 < argc) {
+            cfg.trials = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--margin") == 0 && i + 1 < argc) {
+            margin = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            argv[npos++] = argv[i];
+        }
+    }
+    argc = npos;
+    if (mutants < 0 || mutants > MAX_MUTANTS) {
+        fprintf(stderr, "Error: --mutants must be 0..%d\n", MAX_MUTANTS);
+        return 1;
+    }
+    if (cfg.levels < 2 || cfg.levels > ESTIMATE_MAX_LEVELS || cfg.shift < 1) {
+        fprintf(stderr, "Error: --levels must be 2..%d and --shift positive\n",
+                ESTIMATE_MAX_LEVELS);
+        return 1;
+    }
+
+    if (argc > 1) perms_dir = argv[1];
+    if (argc > 2) threads = atoi(argv[2]);
+    source.perms_dir = perms_dir;
+
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+
+    const char *baseline_names[NUM_CANDIDATE_BASELINES] = {"Ciura", "Ciura-Ext", "Tokuda", "Lee-2021",
+                                                 "Skean-2023", "Sedgewick-86", "EVOLVED"};
+    size_t num_seqs = NUM_CANDIDATE_BASELINES + (size_t)mutants;
+
+    printf("Comparison-Count Estimator Calibration\n");
+    printf("======================================\n");
+    printf("Segments: %d sizes of N >> %d*k (min %lu), %s trials, prune margin %.2f%%\n\n",
+           cfg.levels, cfg.shift, (unsigned long)cfg.min_n,
+           cfg.trials ? "sampled" : "all", margin);
+
+    double sum_raw = 0, sum_rel = 0, max_rel = 0;
+    size_t scored = 0;
+    int failed = 0;
+
+    for (size_t s = 0; s < num_sizes; s++) {
+        uint64_t N = sizes[s];
+
+        perm_dataset_t ds;
+        if (dataset_open(&source, N, ELEM_I32, &ds) < 0) {
+            printf("Failed to load N=%lu\n", (unsigned long)N);
+            failed = 1;
+            continue;
+        }
+
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, threads, N * sizeof(int32_t)) < 0) {
+            free_dataset(&ds);
+            failed = 1;
+            continue;
+        }
+
+        gap_sequence_t seqs[MAX_SEQS];
+        gaps_ciura(&seqs[0], N);
+        gaps_ciura_extended(&seqs[1], N);
+        gaps_tokuda(&seqs[2], N);
+        gaps_lee(&seqs[3], N);
+        gaps_skean(&seqs[4], N);
+        gaps_sedgewick86(&seqs[5], N);
+        gaps_evolved(&seqs[6], N);
+        rng_state_t rng;
+        rng_seed(&rng, derive_seed(seed, N, 0));
+        for (int m = 0; m < mutants; m++) {
+            perturbed_evolved(&seqs[NUM_CANDIDATE_BASELINES + m], N, &rng);
+        }
+
+        double exact[MAX_SEQS], rel[MAX_SEQS];
+        estimate_t est[MAX_SEQS];
+        double t_exact = 0, t_est = 0;
+
+        for (size_t i = 0; i < num_seqs; i++) {
+            double t0 = timing_wall_seconds();
+            exact[i] = exact_mean(&ds, &seqs[i], &scratch, threads);
+            double t1 = timing_wall_seconds();
+            if (estimate_comparisons(&ds, &seqs[i], &cfg, &scratch, threads, &est[i]) < 0) {
+                fprintf(stderr, "Error: N=%lu is too small for %d segments of >> %d above %lu\n",
+                        (unsigned long)N, cfg.levels, cfg.shift, (unsigned long)cfg.min_n);
+                scratch_pool_free(&scratch);
+                free_dataset(&ds);
+                return 1;
+            }
+            t_exact += t1 - t0;
+            t_est += timing_wall_seconds() - t1;
+        }
+
+        printf("N = %lu (%lu trials, %d segments)\n", (unsigned long)N,
+               (unsigned long)ds.trials, est[0].levels);
+        printf("%-14s | %14s | %14s %8s | %14s %8s\n", "Sequence", "Exact", "Raw est",
+               "err %", "Rel est", "err %");
+        printf("---------------|----------------|-------------------------|------------------------\n");
+
+        size_t pruned = 0, wrong = 0;
+        for (size_t i = 0; i < num_seqs; i++) {
+            char name[32];
+            if (i < NUM_CANDIDATE_BASELINES) snprintf(name, sizeof(name), "%s", baseline_names[i]);
+            else snprintf(name, sizeof(name), "Evolved~%zu", i - NUM_CANDIDATE_BASELINES + 1);
+
+            rel[i] = estimate_relative(&est[i], &est[0], exact[0]);
+            double raw_err = (est[i].comparisons - exact[i]) / exact[i] * 100.0;
+            double rel_err = (rel[i] - exact[i]) / exact[i] * 100.0;
+            printf("%-14s | %14.0f | %14.0f %+7.3f%% | %14.0f %+7.3f%%\n", name, exact[i],
+                   est[i].comparisons, raw_err, rel[i], rel_err);
+
+            if (i > 0) {
+                sum_raw += fabs(raw_err);
+                sum_rel += fabs(rel_err);
+                if (fabs(rel_err) > max_rel) max_rel = fabs(rel_err);
+                scored++;
+                if (rel[i] > exact[0] * (1.0 + margin / 100.0)) {
+                    pruned++;
+                    if (exact[i] < exact[0]) wrong++;
+                }
+            }
+        }
+        printf("Spearman (rel vs exact): %.3f   Time: exact %.2fs, estimate %.2fs (%.1fx)\n",
+               spearman(rel, exact, num_seqs), t_exact, t_est, t_est > 0 ? t_exact / t_est : 0);
+        printf("Pruned %zu of %zu non-reference sequences, %zu of them better than Ciura\n\n",
+               pruned, num_seqs - 1, wrong);
+
+        scratch_pool_free(&scratch);
+        free_dataset(&ds);
+    }
+
+    if (scored > 0) {
+        printf("Mean |error| over non-reference sequences: raw %.3f%%, relative %.3f%% "
+               "(max %.3f%%)\n", sum_raw / (double)scored, sum_rel / (double)scored, max_rel);
+    }
+    return failed;
+}
@@ -0,0 +1,62 @@
+#define _GNU_SOURCE
+/*
+ * eval_worker.c - Worker node for distributed evaluation (cluster.h)
+ *
+ * Usage: ./eval_worker [--port P] [--threads N]
+ *
+ * Listens for a coordinator (evolve_live --workers host:port,...) and
+ * sorts the chunks of trials it sends, rebuilding every permutation
+ * locally from the job's master seed. Runs until killed; a coordinator
+ * that disconnects is simply replaced by the next one to connect.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "cluster.h"
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--port P] [--threads N]\n", prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --port P          TCP port to listen on (default: %d)\n",
+            CLUSTER_DEFAULT_PORT);
+    fprintf(stderr, "  --threads N       OpenMP threads per chunk (default: all)\n");
+}
+
+int main(int argc, char **argv) {
+    int port = CLUSTER_DEFAULT_PORT;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (port <= 0 || port > 65535) {
+        fprintf(stderr, "Error: Invalid port %d\n", port);
+        return 1;
+    }
+
+#ifdef _OPENMP
+    if (threads <= 0) threads = omp_get_max_threads();
+#else
+    threads = 1;
+#endif
+
+    return cluster_worker_serve(port, threads) < 0 ? 1 : 0;
+}
@@ -0,0 +1,1095 @@
+#define _GNU_SOURCE
+/*
+ * evolve_live.c - Evolutionary search for Shellsort gap sequences
+ *
+ * Usage: ./evolve_live --perms <dir> --out <dir> [--generations G] [--pop P]
+ *                      [--mutation R] [--sizes n1,n2,...] [--threads N]
+ *                      [--seed <hex>] [--elite E] [--plateau G]
+ *                      [--checkpoint <file>] [--resume] [--status <file>] [--race]
+ *                      [--prefix-cache <MiB>] [--verify]
+ *                      [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                      [--workers host[:port],... [--chunk T] [--worker-timeout S]]
+ *
+ * Fitness is the mean over sizes of mean_comparisons(candidate) divided by
+ * mean_comparisons(Ciura) on the same permutations, so 0.995 is 0.5% better
+ * than Ciura. Lower is better.
+ *
+ * One generation:
+ *   1. Every individual is reduced to its canonical form (ascending, starts
+ *      at 1, no gaps >= the largest size since those are never used) and
+ *      looked up in a fitness cache keyed by a hash of that form. Elites and
+ *      repeated offspring are not sorted again.
+ *   2. The misses are evaluated size by size as one flat OpenMP loop over
+ *      (individual x trial), so a small number of new individuals still
+ *      fills every thread.
+ *      With --race, misses are instead raced against Ciura (race.h) and a
+ *      candidate that is significantly worse stops after a few batches; its
+ *      fitness is Ciura's full-trial mean plus the paired mean difference
+ *      over the trials it used.
+ *      With --prefix-cache, misses are sorted in order of their largest
+ *      gaps and each trial starts from the deepest snapshot of a shared
+ *      leading-pass prefix (prefix_cache.h), so siblings that differ only
+ *      in small gaps skip the common passes. Counts are unchanged.
+ *      With --workers, the same (individual x trial) work is sharded over
+ *      eval_worker nodes instead (cluster.h); they rebuild the trials from
+ *      the --generate-seed master seed, and the counts come back per trial,
+ *      so fitness is identical to a local run.
+ *   3. Tournament selection with elitism, merge crossover and the mutation
+ *      operators from ACADEMIC_REPORT.md section 2.4 build the next
+ *      population.
+ *
+ * After each generation the population, search RNG state and best-ever
+ * individual are written to the checkpoint file (write + rename), together
+ * with their fitness, so --resume continues the run without re-sorting.
+ * The checkpoint also records the trials, dataset and race mode those
+ * fitness values were measured under; --resume refuses a checkpoint whose
+ * settings differ, since its cached fitness would not be comparable.
+ * A one-screen summary goes to the status file for `watch cat`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "rng.h"
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "race.h"
+#include "prefix_cache.h"
+#include "cluster.h"
+#include "cli.h"
+#include "timing.h"
+
+#define MAX_SIZES 32
+#define MAX_POP 1024
+#define SETTINGS_LEN 1200
+
+#define CHECKPOINT_MAGIC "EVOLVE_CHECKPOINT 2"
+
+typedef struct {
+    char out_dir[512];
+    char checkpoint_path[1024];
+    char status_path[1024];
+    dataset_source_t source;
+    uint64_t sizes[MAX_SIZES];
+    size_t num_sizes;
+    int generations;
+    int pop;
+    double mutation;
+    int elite;
+    int tournament;
+    int plateau;             /* Stop after this many generations without improvement (0 = never) */
+    uint64_t search_seed;
+    int threads;
+    int resume;
+    int race;                /* Early-terminate clearly worse candidates */
+    size_t prefix_mib;       /* Prefix snapshot budget (0 = off) */
+    const char *workers;     /* eval_worker list for --workers, else NULL */
+    uint64_t chunk;          /* Trials per worker chunk (0 = automatic) */
+    double worker_timeout;   /* Least seconds a chunk is allowed (0 = no deadline) */
+} config_t;
+
+/* One member of the population */
+typedef struct {
+    gap_sequence_t seq;
+    double fitness;
+} individual_t;
+
+/* Fitness cache entry, keyed by the canonical gap list */
+typedef struct {
+    uint64_t hash;
+    size_t num_gaps;         /* 0 = empty slot */
+    uint64_t gaps[MAX_GAPS];
+    double fitness;
+    double means[MAX_SIZES]; /* Mean comparisons per size */
+} cache_entry_t;
+
+typedef struct {
+    cache_entry_t *slots;
+    size_t cap;              /* Power of two */
+    size_t used;
+    uint64_t hits;
+    uint64_t misses;
+} fitness_cache_t;
+
+/* Everything needed to evaluate a candidate */
+typedef struct {
+    const config_t *cfg;
+    perm_dataset_t ds[MAX_SIZES];
+    scratch_pool_t scratch;
+    double ciura_means[MAX_SIZES];
+    race_reference_t refs[MAX_SIZES]; /* Ciura per-trial counts, for --race */
+    race_config_t race;
+    prefix_cache_t prefix;   /* Leading-pass snapshots, for --prefix-cache */
+    cluster_t *cluster;      /* Remote workers, for --workers, else NULL */
+    uint64_t max_n;
+    int threads;
+    uint64_t sorts;          /* Total sorts run */
+    char settings[SETTINGS_LEN]; /* What fitness is measured under; must match on --resume */
+} evaluator_t;
+
+/* ---- Arguments ----------------------------------------------------------- */
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s --perms <dir> --out <dir> [options]\n", prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --perms <dir>        Directory containing permutation files\n");
+    fprintf(stderr, "  --out <dir>          Output directory for the generation log\n");
+    fprintf(stderr, "  --generations G      Maximum generations (default: 200)\n");
+    fprintf(stderr, "  --pop P              Population size (default: 80)\n");
+    fprintf(stderr, "  --mutation R         Probability an offspring is mutated (default: 0.25)\n");
+    fprintf(stderr, "  --sizes <list>       Target sizes (default: 1000000,2000000)\n");
+    fprintf(stderr, "  --threads N          Number of OpenMP threads (default: all)\n");
+    fprintf(stderr, "  --seed <hex>         Search RNG seed (default: 0x1337C0DE)\n");
+    fprintf(stderr, "  --elite E            Individuals copied unchanged (default: 8)\n");
+    fprintf(stderr, "  --plateau G          Stop after G generations without improvement\n");
+    fprintf(stderr, "                       (default: 50, 0 = never)\n");
+    fprintf(stderr, "  --checkpoint <file>  Checkpoint path (default: <out>/evolve_checkpoint.txt)\n");
+    fprintf(stderr, "  --resume             Continue from the checkpoint\n");
+    fprintf(stderr, "  --status <file>      Live status file (default: results/status.txt)\n");
+    fprintf(stderr, "  --race               Stop evaluating a candidate once it is significantly\n");
+    fprintf(stderr, "                       worse than Ciura (sequential paired test)\n");
+    fprintf(stderr, "  --prefix-cache <MiB> Reuse array snapshots after shared leading passes,\n");
+    fprintf(stderr, "                       up to this much memory (default: 0 = off)\n");
+    fprintf(stderr, "  --generate-seed <hex>\n");
+    fprintf(stderr, "                       Rebuild permutations from this master seed instead of\n");
+    fprintf(stderr, "                       reading --perms\n");
+    fprintf(stderr, "  --trials T           Trials per size with --generate-seed (default: %d)\n",
+            DATASET_DEFAULT_TRIALS);
+    fprintf(stderr, "  --rng-scheme <v>     Permutation stream for --generate-seed (default: v1)\n");
+    fprintf(stderr, "  --verify             Check trials against the permgen .sum digests as they\n");
+    fprintf(stderr, "                       are first loaded\n");
+    fprintf(stderr, "  --workers <list>     Shard evaluation over eval_worker nodes (host[:port],\n");
+    fprintf(stderr, "                       comma-separated, default port %d); needs\n",
+            CLUSTER_DEFAULT_PORT);
+    fprintf(stderr, "                       --generate-seed, not with --race or --prefix-cache\n");
+    fprintf(stderr, "  --chunk T            Trials per worker request (default: trials / (4 x\n");
+    fprintf(stderr, "                       workers))\n");
+    fprintf(stderr, "  --worker-timeout S   Drop a worker that misses its chunk's deadline and\n");
+    fprintf(stderr, "                       requeue the chunk. The deadline is %.0fx the chunk's\n",
+            CLUSTER_TIMEOUT_FACTOR);
+    fprintf(stderr, "                       work at the slowest rate seen, at least S seconds\n");
+    fprintf(stderr, "                       (default: %.0f, 0 = no deadline)\n", CLUSTER_DEFAULT_TIMEOUT);
+}
+
+static int parse_args(int argc, char **argv, config_t *cfg) {
+    static char perms_dir[512];
+
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->generations = 200;
+    cfg->pop = 80;
+    cfg->mutation = 0.25;
+    cfg->elite = 8;
+    cfg->tournament = 4;
+    cfg->plateau = 50;
+    cfg->search_seed = 0x1337C0DEULL;
+    cfg->worker_timeout = CLUSTER_DEFAULT_TIMEOUT;
+    strcpy(cfg->status_path, "results/status.txt");
+    cfg->sizes[0] = 1000000;
+    cfg->sizes[1] = 2000000;
+    cfg->num_sizes = 2;
+
+    if (dataset_source_args(&cfg->source, &argc, argv) < 0) return -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--perms") == 0 && i + 1 < argc) {
+            strncpy(perms_dir, argv[++i], sizeof(perms_dir) - 1);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            strncpy(cfg->out_dir, argv[++i], sizeof(cfg->out_dir) - 1);
+        } else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) {
+            cfg->generations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pop") == 0 && i + 1 < argc) {
+            cfg->pop = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--mutation") == 0 && i + 1 < argc) {
+            cfg->mutation = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 2, cfg->sizes, MAX_SIZES, &cfg->num_sizes) < 0 ||
+                cfg->num_sizes == 0) {
+                fprintf(stderr, "Error: Invalid sizes list\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            cfg->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            cfg->search_seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--elite") == 0 && i + 1 < argc) {
+            cfg->elite = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--plateau") == 0 && i + 1 < argc) {
+            cfg->plateau = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            strncpy(cfg->checkpoint_path, argv[++i], sizeof(cfg->checkpoint_path) - 1);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            cfg->resume = 1;
+        } else if (strcmp(argv[i], "--race") == 0) {
+            cfg->race = 1;
+        } else if (strcmp(argv[i], "--prefix-cache") == 0 && i + 1 < argc) {
+            cfg->prefix_mib = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            cfg->workers = argv[++i];
+        } else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            cfg->chunk = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--worker-timeout") == 0 && i + 1 < argc) {
+            cfg->worker_timeout = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--status") == 0 && i + 1 < argc) {
+            strncpy(cfg->status_path, argv[++i], sizeof(cfg->status_path) - 1);
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            exit(0);
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    if ((perms_dir[0] == '\0' && !cfg->source.generate) || cfg->out_dir[0] == '\0') {
+        fprintf(stderr, "Error: --out and one of --perms or --generate-seed are required\n");
+        return -1;
+    }
+    if (cfg->pop < 2 || cfg->pop > MAX_POP) {
+        fprintf(stderr, "Error: --pop must be between 2 and %d\n", MAX_POP);
+        return -1;
+    }
+    if (cfg->elite < 0 || cfg->elite >= cfg->pop) {
+        fprintf(stderr, "Error: --elite must be less than --pop\n");
+        return -1;
+    }
+    if (cfg->workers && (!cfg->source.generate || cfg->race || cfg->prefix_mib)) {
+        fprintf(stderr, "Error: --workers needs --generate-seed and no --race or --prefix-cache\n");
+        return -1;
+    }
+    if (cfg->worker_timeout < 0) {
+        fprintf(stderr, "Error: --worker-timeout must be >= 0\n");
+        return -1;
+    }
+
+    cfg->source.perms_dir = perms_dir;
+    if (cfg->checkpoint_path[0] == '\0') {
+        snprintf(cfg->checkpoint_path, sizeof(cfg->checkpoint_path),
+                 "%s/evolve_checkpoint.txt", cfg->out_dir);
+    }
+    return 0;
+}
+
+/* Wall-clock time in seconds */
+/* ---- Search RNG ---------------------------------------------------------- */
+
+/* Uniform double in [0, 1) */
+static double rng_double(rng_state_t *rng) {
+    return (double)(rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* ---- Genome -------------------------------------------------------------- */
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Canonical form: ascending, unique, first gap 1, every gap < max_n (larger
+ * gaps are skipped by shellsort() at every target size).
+ */
+static void canonicalize_gaps(gap_sequence_t *seq, uint64_t max_n) {
+    qsort(seq->gaps, seq->num_gaps, sizeof(uint64_t), cmp_u64);
+
+    size_t k = 0;
+    seq->gaps[k++] = 1;
+    for (size_t i = 0; i < seq->num_gaps; i++) {
+        uint64_t g = seq->gaps[i];
+        if (g <= seq->gaps[k - 1] || g >= max_n) continue;
+        if (k == MAX_GAPS) break;
+        seq->gaps[k++] = g;
+    }
+    seq->num_gaps = k;
+}
+
+static uint64_t sequence_hash(const gap_sequence_t *seq) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ seq->num_gaps;
+    for (size_t i = 0; i < seq->num_gaps; i++) {
+        uint64_t s = h ^ seq->gaps[i];
+        h = splitmix64(&s);
+    }
+    return h;
+}
+
+/* Merge crossover: a's gaps below a random cut, b's gaps from the cut up */
+static void crossover(gap_sequence_t *child, const gap_sequence_t *a, const gap_sequence_t *b,
+                      rng_state_t *rng) {
+    uint64_t top = a->gaps[a->num_gaps - 1] > b->gaps[b->num_gaps - 1]
+                 ? a->gaps[a->num_gaps - 1] : b->gaps[b->num_gaps - 1];
+    uint64_t cut = 1 + rng_uniform(rng, top);
+
+    child->num_gaps = 0;
+    for (size_t i = 0; i < a->num_gaps && child->num_gaps < MAX_GAPS; i++) {
+        if (a->gaps[i] < cut) child->gaps[child->num_gaps++] = a->gaps[i];
+    }
+    for (size_t i = 0; i < b->num_gaps && child->num_gaps < MAX_GAPS; i++) {
+        if (b->gaps[i] >= cut) child->gaps[child->num_gaps++] = b->gaps[i];
+    }
+}
+
+/* One mutation: insert, delete, modify, scale all, or small perturbation */
+static void mutate(gap_sequence_t *seq, rng_state_t *rng, uint64_t max_n) {
+    size_t k = seq->num_gaps;
+
+    switch (rng_uniform(rng, 5)) {
+    case 0: {
+        /* Insert a gap between two neighbours, or on top */
+        if (k >= MAX_GAPS) break;
+        size_t i = (size_t)rng_uniform(rng, k);
+        uint64_t lo = seq->gaps[i];
+        uint64_t hi = (i + 1 < k) ? seq->gaps[i + 1] : (uint64_t)(lo * 2.5) + 2;
+        if (hi > max_n) hi = max_n;
+        if (hi - lo < 2) break;
+        seq->gaps[seq->num_gaps++] = lo + 1 + rng_uniform(rng, hi - lo - 1);
+        break;
+    }
+    case 1: {
+        /* Delete a gap other than 1 */
+        if (k <= 2) break;
+        size_t i = 1 + (size_t)rng_uniform(rng, k - 1);
+        memmove(&seq->gaps[i], &seq->gaps[i + 1], (k - i - 1) * sizeof(uint64_t));
+        seq->num_gaps--;
+        break;
+    }
+    case 2: {
+        /* Move one gap within +-10% */
+        if (k < 2) break;
+        size_t i = 1 + (size_t)rng_uniform(rng, k - 1);
+        double f = 0.9 + 0.2 * rng_double(rng);
+        uint64_t g = (uint64_t)((double)seq->gaps[i] * f);
+        seq->gaps[i] = g > 1 ? g : 2;
+        break;
+    }
+    case 3: {
+        /* Scale every gap above 1 by the same factor within +-3% */
+        double f = 0.97 + 0.06 * rng_double(rng);
+        for (size_t i = 1; i < k; i++) {
+            uint64_t g = (uint64_t)((double)seq->gaps[i] * f);
+            seq->gaps[i] = g > 1 ? g : 2;
+        }
+        break;
+    }
+    default: {
+        /* Nudge one gap by up to 1% (at least +-1) */
+        if (k < 2) break;
+        size_t i = 1 + (size_t)rng_uniform(rng, k - 1);
+        uint64_t g = seq->gaps[i];
+        uint64_t d = g / 100 > 0 ? g / 100 : 1;
+        uint64_t step = 1 + rng_uniform(rng, d);
+        if (rng_next(rng) & 1) {
+            seq->gaps[i] = g + step;
+        } else {
+            seq->gaps[i] = g > step + 1 ? g - step : 2;
+        }
+        break;
+    }
+    }
+
+    canonicalize_gaps(seq, max_n);
+}
+
+static void sequence_to_string(const gap_sequence_t *seq, char *buf, size_t len) {
+    size_t pos = 0;
+    buf[0] = '\0';
+    for (size_t i = 0; i < seq->num_gaps && pos < len; i++) {
+        pos += (size_t)snprintf(buf + pos, len - pos, "%s%lu", i ? " " : "",
+                                (unsigned long)seq->gaps[i]);
+    }
+}
+
+/* ---- Fitness cache ------------------------------------------------------- */
+
+static int cache_init(fitness_cache_t *c, size_t cap) {
+    memset(c, 0, sizeof(*c));
+    c->slots = calloc(cap, sizeof(cache_entry_t));
+    if (!c->slots) return -1;
+    c->cap = cap;
+    return 0;
+}
+
+static void cache_free(fitness_cache_t *c) {
+    free(c->slots);
+    c->slots = NULL;
+}
+
+static int same_gaps(const cache_entry_t *e, const gap_sequence_t *seq) {
+    return e->num_gaps == seq->num_gaps &&
+           memcmp(e->gaps, seq->gaps, seq->num_gaps * sizeof(uint64_t)) == 0;
+}
+
+/* Slot holding seq, or the empty slot where it belongs */
+static cache_entry_t *cache_slot(fitness_cache_t *c, const gap_sequence_t *seq, uint64_t hash) {
+    size_t mask = c->cap - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        cache_entry_t *e = &c->slots[i];
+        if (e->num_gaps == 0) return e;
+        if (e->hash == hash && same_gaps(e, seq)) return e;
+    }
+}
+
+static int cache_grow(fitness_cache_t *c) {
+    fitness_cache_t bigger;
+    if (cache_init(&bigger, c->cap * 2) < 0) return -1;
+
+    for (size_t i = 0; i < c->cap; i++) {
+        cache_entry_t *e = &c->slots[i];
+        if (e->num_gaps == 0) continue;
+        size_t mask = bigger.cap - 1;
+        size_t j = (size_t)e->hash & mask;
+        while (bigger.slots[j].num_gaps != 0) j = (j + 1) & mask;
+        bigger.slots[j] = *e;
+    }
+
+    bigger.used = c->used;
+    bigger.hits = c->hits;
+    bigger.misses = c->misses;
+    free(c->slots);
+    *c = bigger;
+    return 0;
+}
+
+/* Insert seq (empty fitness) if absent; returns its entry, NULL on OOM */
+static cache_entry_t *cache_insert(fitness_cache_t *c, const gap_sequence_t *seq, int *is_new) {
+    if (2 * (c->used + 1) > c->cap && cache_grow(c) < 0) return NULL;
+
+    uint64_t hash = sequence_hash(seq);
+    cache_entry_t *e = cache_slot(c, seq, hash);
+    *is_new = (e->num_gaps == 0);
+    if (*is_new) {
+        e->hash = hash;
+        e->num_gaps = seq->num_gaps;
+        memcpy(e->gaps, seq->gaps, seq->num_gaps * sizeof(uint64_t));
+        e->fitness = NAN;
+        c->used++;
+    }
+    return e;
+}
+
+/* ---- Evaluation ---------------------------------------------------------- */
+
+/*
+ * Raced estimate of mean comparisons at size index s: Ciura's full mean
+ * plus the paired difference over the trials each candidate used.
+ */
+static int race_size(evaluator_t *ev, size_t s, gap_sequence_t *const *seqs, size_t count,
+                     double *means) {
+    race_result_t *res = malloc(count * sizeof(race_result_t));
+    if (!res) return -1;
+
+    if (race_evaluate_many(&ev->refs[s], (const gap_sequence_t *const *)seqs, count,
+                           &ev->scratch, &ev->race, ev->threads, res) < 0) {
+        free(res);
+        return -1;
+    }
+    for (size_t m = 0; m < count; m++) {
+        means[m] = ev->ciura_means[s] + res[m].test.mean_diff;
+        ev->sorts += res[m].trials_used;
+    }
+
+    free(res);
+    return 0;
+}
+
+/*
+ * Mean comparisons of seqs[0..count) at size index s, one flat parallel
+ * loop over (sequence x trial). With a prefix budget each sort goes
+ * through the snapshot cache; with --workers the loop runs on the cluster.
+ */
+static int evaluate_size(evaluator_t *ev, size_t s, gap_sequence_t *const *seqs, size_t count,
+                         double *means) {
+    if (ev->cfg->race) return race_size(ev, s, seqs, count, means);
+
+    const perm_dataset_t *ds = &ev->ds[s];
+    uint64_t N = ds->N;
+    uint64_t trials = ds->trials;
+    uint64_t work = (uint64_t)count * trials;
+
+    uint64_t *comps = malloc(work * sizeof(uint64_t));
+    if (!comps) return -1;
+
+    if (ev->cluster) {
+        if (cluster_evaluate(ev->cluster, ds, (const gap_sequence_t *const *)seqs, count,
+                             comps) < 0) {
+            free(comps);
+            return -1;
+        }
+    } else {
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(ev->threads)
+        for (uint64_t w = 0; w < work; w++) {
+            uint64_t m = w / trials;
+            uint64_t t = w % trials;
+            int32_t *arr = scratch_get(&ev->scratch);
+            if (ev->cfg->prefix_mib) {
+                comps[w] = prefix_cache_sort(&ev->prefix, ds, t, seqs[m], arr).comparisons;
+            } else {
+                dataset_copy_trial(ds, t, arr);
+                comps[w] = shellsort(arr, N, seqs[m]);
+            }
+        }
+    }
+
+    for (size_t m = 0; m < count; m++) {
+        uint64_t total = 0;
+        for (uint64_t t = 0; t < trials; t++) total += comps[m * trials + t];
+        means[m] = (double)total / (double)trials;
+    }
+
+    ev->sorts += work;
+    free(comps);
+    return 0;
+}
+
+/* Descending gap order, so sequences sharing their largest gaps are adjacent */
+static int cmp_leading_gaps(const void *a, const void *b) {
+    const gap_sequence_t *x = *(gap_sequence_t *const *)a;
+    const gap_sequence_t *y = *(gap_sequence_t *const *)b;
+    size_t i = x->num_gaps, j = y->num_gaps;
+    while (i > 0 && j > 0) {
+        uint64_t gx = x->gaps[--i], gy = y->gaps[--j];
+        if (gx != gy) return gx < gy ? -1 : 1;
+    }
+    return (i > 0) - (j > 0);
+}
+
+static double fitness_from_means(const evaluator_t *ev, const double *means) {
+    double f = 0.0;
+    for (size_t s = 0; s < ev->cfg->num_sizes; s++) {
+        f += means[s] / ev->ciura_means[s];
+    }
+    return f / (double)ev->cfg->num_sizes;
+}
+
+/* Fill pop[i].fitness, sorting only individuals not already in the cache */
+static int evaluate_population(evaluator_t *ev, fitness_cache_t *cache, individual_t *pop,
+                               int count, int *evaluated) {
+    cache_entry_t *entries[MAX_POP];
+    gap_sequence_t *todo[MAX_POP];
+    cache_entry_t *todo_entries[MAX_POP];
+    size_t num_todo = 0;
+
+    /* Reserve every entry first so the table cannot move underneath us */
+    for (int i = 0; i < count; i++) {
+        int is_new;
+        if (!cache_insert(cache, &pop[i].seq, &is_new)) return -1;
+        if (is_new) {
+            todo[num_todo++] = &pop[i].seq;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        entries[i] = cache_slot(cache, &pop[i].seq, sequence_hash(&pop[i].seq));
+    }
+    if (ev->cfg->prefix_mib) {
+        qsort(todo, num_todo, sizeof(todo[0]), cmp_leading_gaps);
+    }
+    for (size_t m = 0; m < num_todo; m++) {
+        todo_entries[m] = cache_slot(cache, todo[m], sequence_hash(todo[m]));
+    }
+    cache->misses += num_todo;
+    cache->hits += (uint64_t)count - num_todo;
+
+    if (num_todo > 0) {
+        double *means = malloc(num_todo * sizeof(double));
+        if (!means) return -1;
+        for (size_t s = 0; s < ev->cfg->num_sizes; s++) {
+            if (evaluate_size(ev, s, todo, num_todo, means) < 0) {
+                free(means);
+                return -1;
+            }
+            for (size_t m = 0; m < num_todo; m++) {
+                todo_entries[m]->means[s] = means[m];
+            }
+        }
+        free(means);
+        for (size_t m = 0; m < num_todo; m++) {
+            todo_entries[m]->fitness = fitness_from_means(ev, todo_entries[m]->means);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        pop[i].fitness = entries[i]->fitness;
+    }
+    *evaluated = (int)num_todo;
+    return 0;
+}
+
+/* ---- Checkpoint / status ------------------------------------------------- */
+
+typedef struct {
+    int generation;          /* Last completed generation */
+    int stale;               /* Generations since best improved */
+    rng_state_t rng;
+    individual_t best;
+} search_state_t;
+
+static void write_individual(FILE *f, const char *tag, const individual_t *ind,
+                             const fitness_cache_t *cache, size_t num_sizes) {
+    fitness_cache_t *c = (fitness_cache_t *)cache;
+    const cache_entry_t *e = cache_slot(c, &ind->seq, sequence_hash(&ind->seq));
+
+    fprintf(f, "%s %.17g", tag, ind->fitness);
+    for (size_t s = 0; s < num_sizes; s++) {
+        fprintf(f, " %.17g", e->num_gaps ? e->means[s] : NAN);
+    }
+    fprintf(f, " %zu", ind->seq.num_gaps);
+    for (size_t i = 0; i < ind->seq.num_gaps; i++) {
+        fprintf(f, " %lu", (unsigned long)ind->seq.gaps[i]);
+    }
+    fprintf(f, "\n");
+}
+
+/* One line naming everything a fitness value depends on besides the gaps and sizes */
+static void describe_settings(evaluator_t *ev) {
+    const config_t *cfg = ev->cfg;
+    const perm_dataset_t *ds = &ev->ds[0];
+    size_t len = 0;
+
+    if (cfg->source.generate) {
+        len += snprintf(ev->settings + len, sizeof(ev->settings) - len, "generate");
+    } else {
+        len += snprintf(ev->settings + len, sizeof(ev->settings) - len, "perms %s",
+                        cfg->source.perms_dir);
+    }
+    len += snprintf(ev->settings + len, sizeof(ev->settings) - len,
+                    " seed 0x%lX scheme %d dist %s:%g", (unsigned long)ds->master_seed,
+                    ds->rng_scheme, dist_kind_name(ds->dist.kind), ds->dist.param);
+    if (cfg->race) {
+        len += snprintf(ev->settings + len, sizeof(ev->settings) - len,
+                        " race %lu/%lu/%g", (unsigned long)ev->race.batch,
+                        (unsigned long)ev->race.min_trials, ev->race.alpha);
+    } else {
+        len += snprintf(ev->settings + len, sizeof(ev->settings) - len, " race off");
+    }
+    len += snprintf(ev->settings + len, sizeof(ev->settings) - len, " trials");
+    for (size_t s = 0; s < cfg->num_sizes && len < sizeof(ev->settings); s++) {
+        len += snprintf(ev->settings + len, sizeof(ev->settings) - len, "%c%lu",
+                        s ? ',' : ' ', (unsigned long)ev->ds[s].trials);
+    }
+}
+
+static int save_checkpoint(const config_t *cfg, const char *settings, const search_state_t *st,
+                           const individual_t *pop, const fitness_cache_t *cache) {
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", cfg->checkpoint_path);
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", tmp, strerror(errno));
+        return -1;
+    }
+
+    fprintf(f, "%s\n", CHECKPOINT_MAGIC);
+    fprintf(f, "generation %d\n", st->generation);
+    fprintf(f, "stale %d\n", st->stale);
+    fprintf(f, "rng %016lx %016lx %016lx %016lx\n",
+            (unsigned long)st->rng.s[0], (unsigned long)st->rng.s[1],
+            (unsigned long)st->rng.s[2], (unsigned long)st->rng.s[3]);
+    fprintf(f, "sizes");
+    for (size_t s = 0; s < cfg->num_sizes; s++) {
+        fprintf(f, "%c%lu", s ? ',' : ' ', (unsigned long)cfg->sizes[s]);
+    }
+    fprintf(f, "\n");
+    fprintf(f, "settings %s\n", settings);
+    write_individual(f, "best", &st->best, cache, cfg->num_sizes);
+    fprintf(f, "pop %d\n", cfg->pop);
+    for (int i = 0; i < cfg->pop; i++) {
+        write_individual(f, "ind", &pop[i], cache, cfg->num_sizes);
+    }
+
+    if (fclose(f) != 0 || rename(tmp, cfg->checkpoint_path) < 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", cfg->checkpoint_path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* Parse "<tag> fitness means... k gaps..." and seed the cache if it was evaluated */
+static int read_individual(FILE *f, const char *tag, individual_t *ind, fitness_cache_t *cache,
+                           size_t num_sizes) {
+    char word[32];
+    double means[MAX_SIZES];
+    size_t k;
+
+    if (fscanf(f, "%31s %lf", word, &ind->fitness) != 2 || strcmp(word, tag) != 0) return -1;
+    for (size_t s = 0; s < num_sizes; s++) {
+        if (fscanf(f, "%lf", &means[s]) != 1) return -1;
+    }
+    if (fscanf(f, "%zu", &k) != 1 || k == 0 || k > MAX_GAPS) return -1;
+    for (size_t i = 0; i < k; i++) {
+        unsigned long g;
+        if (fscanf(f, "%lu", &g) != 1) return -1;
+        ind->seq.gaps[i] = g;
+    }
+    ind->seq.num_gaps = k;
+    snprintf(ind->seq.name, sizeof(ind->seq.name), "candidate");
+    if (isnan(ind->fitness)) return 0;  /* Offspring not evaluated yet */
+
+    int is_new;
+    cache_entry_t *e = cache_insert(cache, &ind->seq, &is_new);
+    if (!e) return -1;
+    if (is_new) {
+        e->fitness = ind->fitness;
+        memcpy(e->means, means, num_sizes * sizeof(double));
+    }
+    return 0;
+}
+
+static int load_checkpoint(const config_t *cfg, const char *settings, search_state_t *st,
+                           individual_t *pop, fitness_cache_t *cache) {
+    FILE *f = fopen(cfg->checkpoint_path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", cfg->checkpoint_path, strerror(errno));
+        return -1;
+    }
+
+    char line[256], sizes[1024];
+    unsigned long s0, s1, s2, s3;
+    int pop_size;
+    int ok = fgets(line, sizeof(line), f) != NULL &&
+             strncmp(line, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC)) == 0 &&
+             fscanf(f, " generation %d", &st->generation) == 1 &&
+             fscanf(f, " stale %d", &st->stale) == 1 &&
+             fscanf(f, " rng %lx %lx %lx %lx", &s0, &s1, &s2, &s3) == 4 &&
+             fscanf(f, " sizes %1023s", sizes) == 1;
+
+    if (ok) {
+        uint64_t ck_sizes[MAX_SIZES];
+        size_t n;
+        ok = parse_uint64_list(sizes, 2, ck_sizes, MAX_SIZES, &n) == 0 &&
+             n == cfg->num_sizes &&
+             memcmp(ck_sizes, cfg->sizes, n * sizeof(uint64_t)) == 0;
+        if (!ok) {
+            fprintf(stderr, "Error: %s was written for sizes %s\n", cfg->checkpoint_path, sizes);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    /* Rest of the sizes line, then the settings the cached fitness was measured under */
+    char ck_settings[SETTINGS_LEN + 16];
+    ok = ok && fgets(line, sizeof(line), f) != NULL &&
+         fgets(ck_settings, sizeof(ck_settings), f) != NULL &&
+         strncmp(ck_settings, "settings ", 9) == 0;
+    if (ok) {
+        ck_settings[strcspn(ck_settings, "\n")] = '\0';
+        if (strcmp(ck_settings + 9, settings) != 0) {
+            fprintf(stderr, "Error: %s was measured under different settings:\n"
+                    "  checkpoint: %s\n  this run:   %s\n",
+                    cfg->checkpoint_path, ck_settings + 9, settings);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    ok = ok && read_individual(f, "best", &st->best, cache, cfg->num_sizes) == 0 &&
+         fscanf(f, " pop %d", &pop_size) == 1 && pop_size == cfg->pop;
+    for (int i = 0; ok && i < cfg->pop; i++) {
+        ok = read_individual(f, "ind", &pop[i], cache, cfg->num_sizes) == 0;
+    }
+    fclose(f);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Malformed checkpoint %s (or --pop differs)\n", cfg->checkpoint_path);
+        return -1;
+    }
+
+    st->rng.s[0] = s0;
+    st->rng.s[1] = s1;
+    st->rng.s[2] = s2;
+    st->rng.s[3] = s3;
+    return 0;
+}
+
+static void write_status(const config_t *cfg, const search_state_t *st, double mean_fitness,
+                         const fitness_cache_t *cache, const evaluator_t *ev, double elapsed) {
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", cfg->status_path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return;  /* Status is best effort */
+
+    char gaps[2048];
+    sequence_to_string(&st->best.seq, gaps, sizeof(gaps));
+
+    fprintf(f, "generation:   %d / %d\n", st->generation, cfg->generations);
+    fprintf(f, "best fitness: %.6f  (%+.4f%% vs Ciura)\n", st->best.fitness,
+            (1.0 - st->best.fitness) * 100.0);
+    fprintf(f, "mean fitness: %.6f\n", mean_fitness);
+    fprintf(f, "stale:        %d generations\n", st->stale);
+    fprintf(f, "cache:        %lu hits, %lu misses, %zu entries\n",
+            (unsigned long)cache->hits, (unsigned long)cache->misses, cache->used);
+    fprintf(f, "sorts:        %lu (%.1f/s)\n", (unsigned long)ev->sorts,
+            elapsed > 0 ? (double)ev->sorts / elapsed : 0.0);
+    fprintf(f, "best gaps:    %s\n", gaps);
+    fclose(f);
+    rename(tmp, cfg->status_path);
+}
+
+/* ---- Search -------------------------------------------------------------- */
+
+static int cmp_fitness(const void *a, const void *b) {
+    double x = ((const individual_t *)a)->fitness, y = ((const individual_t *)b)->fitness;
+    return (x > y) - (x < y);
+}
+
+static const individual_t *tournament(const individual_t *pop, int count, int rounds,
+                                      rng_state_t *rng) {
+    const individual_t *best = &pop[rng_uniform(rng, (uint64_t)count)];
+    for (int r = 1; r < rounds; r++) {
+        const individual_t *c = &pop[rng_uniform(rng, (uint64_t)count)];
+        if (c->fitness < best->fitness) best = c;
+    }
+    return best;
+}
+
+/* Seed the population with Ciura, Ciura-extended, Evolved and their mutants */
+static void initial_population(individual_t *pop, int count, rng_state_t *rng, uint64_t max_n) {
+    gap_sequence_t seeds[3];
+    gaps_ciura(&seeds[0], max_n);
+    gaps_ciura_extended(&seeds[1], max_n);
+    gaps_evolved(&seeds[2], max_n);
+
+    for (int i = 0; i < count; i++) {
+        pop[i].seq = seeds[i % 3];
+        canonicalize_gaps(&pop[i].seq, max_n);
+        if (i >= 3) {
+            int rounds = 1 + (int)rng_uniform(rng, 3);
+            for (int r = 0; r < rounds; r++) mutate(&pop[i].seq, rng, max_n);
+        }
+        snprintf(pop[i].seq.name, sizeof(pop[i].seq.name), "candidate");
+        pop[i].fitness = NAN;
+    }
+}
+
+static void next_generation(const config_t *cfg, const individual_t *pop, individual_t *next,
+                            rng_state_t *rng, uint64_t max_n) {
+    /* pop is sorted best first */
+    for (int i = 0; i < cfg->elite; i++) {
+        next[i] = pop[i];
+    }
+
+    for (int i = cfg->elite; i < cfg->pop; i++) {
+        const individual_t *a = tournament(pop, cfg->pop, cfg->tournament, rng);
+        if (rng_double(rng) < 0.7) {
+            const individual_t *b = tournament(pop, cfg->pop, cfg->tournament, rng);
+            crossover(&next[i].seq, &a->seq, &b->seq, rng);
+            canonicalize_gaps(&next[i].seq, max_n);
+        } else {
+            next[i].seq = a->seq;
+        }
+        if (rng_double(rng) < cfg->mutation) {
+            mutate(&next[i].seq, rng, max_n);
+        }
+        snprintf(next[i].seq.name, sizeof(next[i].seq.name), "candidate");
+        next[i].fitness = NAN;
+    }
+}
+
+int main(int argc, char **argv) {
+    config_t cfg;
+    if (parse_args(argc, argv, &cfg) < 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    int num_threads = cfg.threads;
+#ifdef _OPENMP
+    if (num_threads <= 0) num_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    num_threads = 1;
+#endif
+
+    mkdir(cfg.out_dir, 0755);
+
+    /* Load every target size once for the whole run */
+    static evaluator_t ev;
+    ev.cfg = &cfg;
+    ev.threads = num_threads;
+    race_config_default(&ev.race);
+    ev.race.stop_better = 0;  /* Good candidates still get full-trial fitness */
+    for (size_t s = 0; s < cfg.num_sizes; s++) {
+        if (dataset_open(&cfg.source, cfg.sizes[s], ELEM_I32, &ev.ds[s]) < 0) {
+            for (size_t p = 0; p < s; p++) free_dataset(&ev.ds[p]);
+            return 1;
+        }
+        if (cfg.sizes[s] > ev.max_n) ev.max_n = cfg.sizes[s];
+    }
+    describe_settings(&ev);
+    if (scratch_pool_init(&ev.scratch, num_threads, ev.max_n * sizeof(int32_t)) < 0) {
+        return 1;
+    }
+    if (prefix_cache_init(&ev.prefix, cfg.prefix_mib << 20) < 0) return 1;
+
+    static cluster_t cluster;
+    if (cfg.workers) {
+        if (cluster_connect(&cluster, cfg.workers) < 0) return 1;
+        cluster.chunk_trials = cfg.chunk;
+        cluster.worker_timeout = cfg.worker_timeout;
+        ev.cluster = &cluster;
+    }
+
+    printf("Evolutionary Gap Search\n");
+    printf("=======================\n");
+    printf("Population: %d, elite: %d, mutation: %.2f, generations: %d\n",
+           cfg.pop, cfg.elite, cfg.mutation, cfg.generations);
+    printf("Sizes:");
+    for (size_t s = 0; s < cfg.num_sizes; s++) {
+        printf(" %lu (%lu trials)", (unsigned long)cfg.sizes[s], (unsigned long)ev.ds[s].trials);
+    }
+    printf("\nThreads: %d, search seed: 0x%lX\n", num_threads, (unsigned long)cfg.search_seed);
+    if (ev.cluster) {
+        printf("Workers: %zu (%s), chunk deadline %.0fx slowest rate, at least %g s\n",
+               cluster.num_workers, cfg.workers, CLUSTER_TIMEOUT_FACTOR, cluster.worker_timeout);
+    }
+    if (cfg.race) {
+        printf("Racing: batch %lu, min %lu trials, alpha %g\n", (unsigned long)ev.race.batch,
+               (unsigned long)ev.race.min_trials, ev.race.alpha);
+    }
+    if (cfg.prefix_mib && !cfg.race) {
+        printf("Prefix cache: %zu MiB, snapshot every %zu passes\n", cfg.prefix_mib,
+               ev.prefix.stride);
+    }
+    printf("\n");
+
+    /* Reference: Ciura on the same permutations, per trial for --race */
+    static gap_sequence_t ciura;
+    gaps_ciura(&ciura, ev.max_n);
+    canonicalize_gaps(&ciura, ev.max_n);
+    for (size_t s = 0; s < cfg.num_sizes; s++) {
+        if (race_reference_init(&ev.refs[s], &ciura, &ev.ds[s]) < 0) return 1;
+        if (ev.cluster) {
+            const gap_sequence_t *ref_seq = &ciura;
+            if (cluster_evaluate(ev.cluster, &ev.ds[s], &ref_seq, 1, ev.refs[s].comps) < 0) {
+                return 1;
+            }
+            ev.refs[s].filled = ev.ds[s].trials;
+        }
+        ev.ciura_means[s] = race_reference_mean(&ev.refs[s], ev.ds[s].trials, &ev.scratch,
+                                                num_threads);
+        ev.sorts += ev.ds[s].trials;
+        printf("Ciura N=%lu: %.2f comparisons\n", (unsigned long)cfg.sizes[s], ev.ciura_means[s]);
+    }
+    printf("\n");
+
+    static individual_t pop[MAX_POP], next[MAX_POP];
+    fitness_cache_t cache;
+    search_state_t st;
+    if (cache_init(&cache, 1024) < 0) return 1;
+    memset(&st, 0, sizeof(st));
+
+    if (cfg.resume) {
+        if (load_checkpoint(&cfg, ev.settings, &st, pop, &cache) < 0) return 1;
+        printf("Resumed from %s at generation %d (best %.6f)\n\n",
+               cfg.checkpoint_path, st.generation, st.best.fitness);
+    } else {
+        rng_seed(&st.rng, cfg.search_seed);
+        initial_population(pop, cfg.pop, &st.rng, ev.max_n);
+        st.best.fitness = INFINITY;
+    }
+
+    /* Per-generation log */
+    time_t now = time(NULL);
+    char timestamp[64], log_path[1024];
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", localtime(&now));
+    snprintf(log_path, sizeof(log_path), "%s/evolve_%s.csv", cfg.out_dir, timestamp);
+    FILE *log = fopen(log_path, "w");
+    if (!log) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", log_path, strerror(errno));
+        return 1;
+    }
+    fprintf(log, "generation,best_fitness,mean_fitness,improvement_pct,evaluated,cache_hits,"
+            "seconds,best_gaps\n");
+
+    double t_start = timing_wall_seconds();
+    int first = st.generation + 1;
+
+    for (int gen = first; gen <= cfg.generations; gen++) {
+        /* After a resume the population is already evaluated (from the cache) */
+        int evaluated;
+        if (evaluate_population(&ev, &cache, pop, cfg.pop, &evaluated) < 0) {
+            fprintf(stderr, "Error: Failed to evaluate generation %d\n", gen);
+            return 1;
+        }
+
+        qsort(pop, (size_t)cfg.pop, sizeof(individual_t), cmp_fitness);
+
+        if (pop[0].fitness < st.best.fitness) {
+            st.best = pop[0];
+            st.stale = 0;
+        } else {
+            st.stale++;
+        }
+
+        double mean = 0.0;
+        for (int i = 0; i < cfg.pop; i++) mean += pop[i].fitness;
+        mean /= cfg.pop;
+
+        double elapsed = timing_wall_seconds() - t_start;
+        char gaps[2048];
+        sequence_to_string(&st.best.seq, gaps, sizeof(gaps));
+        printf("Gen %4d: best %.6f (%+.4f%%)  mean %.6f  evaluated %d  [%s]\n",
+               gen, st.best.fitness, (1.0 - st.best.fitness) * 100.0, mean, evaluated, gaps);
+        fprintf(log, "%d,%.8f,%.8f,%.5f,%d,%d,%.2f,\"%s\"\n", gen, st.best.fitness, mean,
+                (1.0 - st.best.fitness) * 100.0, evaluated, cfg.pop - evaluated, elapsed, gaps);
+        fflush(log);
+
+        /* Breed, then checkpoint the population the next generation will evaluate */
+        st.generation = gen;
+        next_generation(&cfg, pop, next, &st.rng, ev.max_n);
+        memcpy(pop, next, (size_t)cfg.pop * sizeof(individual_t));
+
+        /* Offspring fitness is unknown until evaluated; store the cached value if any */
+        for (int i = 0; i < cfg.pop; i++) {
+            cache_entry_t *e = cache_slot(&cache, &pop[i].seq, sequence_hash(&pop[i].seq));
+            pop[i].fitness = e->num_gaps ? e->fitness : NAN;
+        }
+        if (save_checkpoint(&cfg, ev.settings, &st, pop, &cache) < 0) {
+            fprintf(stderr, "Error: Failed to checkpoint generation %d\n", gen);
+            return 1;
+        }
+        write_status(&cfg, &st, mean, &cache, &ev, elapsed);
+
+        if (cfg.plateau > 0 && st.stale >= cfg.plateau) {
+            printf("\nNo improvement in %d generations, stopping.\n", cfg.plateau);
+            break;
+        }
+    }
+
+    char gaps[2048];
+    sequence_to_string(&st.best.seq, gaps, sizeof(gaps));
+    printf("\nBest: %.6f (%+.4f%% vs Ciura)\n", st.best.fitness, (1.0 - st.best.fitness) * 100.0);
+    printf("Gaps: %s\n", gaps);
+    printf("Cache: %lu hits, %lu misses; %lu sorts\n",
+           (unsigned long)cache.hits, (unsigned long)cache.misses, (unsigned long)ev.sorts);
+    if (cfg.prefix_mib && !cfg.race) {
+        uint64_t passes = ev.prefix.passes_skipped + ev.prefix.passes_run;
+        printf("Prefix cache: %lu hits, %lu misses, %lu evictions; %.1f%% of passes skipped\n",
+               (unsigned long)ev.prefix.hits, (unsigned long)ev.prefix.misses,
+               (unsigned long)ev.prefix.evictions,
+               passes ? 100.0 * (double)ev.prefix.passes_skipped / (double)passes : 0.0);
+    }
+    printf("Log: %s\n", log_path);
+
+    fclose(log);
+    cache_free(&cache);
+    scratch_pool_free(&ev.scratch);
+    prefix_cache_free(&ev.prefix);
+    if (ev.cluster) cluster_close(ev.cluster);
+    for (size_t s = 0; s < cfg.num_sizes; s++) {
+        race_reference_free(&ev.refs[s]);
+        free_dataset(&ev.ds[s]);
+    }
+    return 0;
+}
@@ -1,6 +1,11 @@
 /*
  * full_bench.c - Comprehensive benchmark with full statistics
  * Outputs per-trial data for statistical analysis
+ *
+ * Usage: ./full_bench [perms_dir] [threads] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                     [--verify] [--telemetry <file>[.prom] [--telemetry-interval S]]
+ *
+ * --telemetry publishes live progress while it runs (see telemetry.h).
  */
 #define _GNU_SOURCE
 #include <stdio.h>
@@ -17,37 +22,10 @@
 #include "rng.h"
 #include "shellsort.h"
 #include "gaps_baselines.h"
-
-#define MAGIC 0x5045524D47454E31ULL
-
-typedef struct {
-    uint64_t N;
-    uint64_t trials;
-    int32_t *data;
-} perm_dataset_t;
-
-static int load_dataset(const char *dir, uint64_t N, perm_dataset_t *ds) {
-    char path[1024];
-    snprintf(path, sizeof(path), "%s/perm_%lu.bin", dir, (unsigned long)N);
-    FILE *f = fopen(path, "rb");
-    if (!f) return -1;
-
-    uint64_t magic;
-    fread(&magic, sizeof(magic), 1, f);
-    if (magic != MAGIC) { fclose(f); return -1; }
-
-    fread(&ds->N, sizeof(ds->N), 1, f);
-    fread(&ds->trials, sizeof(ds->trials), 1, f);
-    uint64_t seed;
-    fread(&seed, sizeof(seed), 1, f);
-
-    size_t total = ds->trials * ds->N;
-    ds->data = malloc(total * sizeof(int32_t));
-    if (!ds->data) { fclose(f); return -1; }
-    fread(ds->data, sizeof(int32_t), total, f);
-    fclose(f);
-    return 0;
-}
+#include "dataset.h"
+#include "scratch.h"
+#include "stats.h"
+#include "telemetry.h"
 
 typedef struct {
     uint64_t *comparisons;  /* per-trial comparisons */
@@ -63,45 +41,31 @@ typedef struct {
 } detailed_stats_t;
 
 static void compute_stats(detailed_stats_t *stats) {
-    double sum = 0;
-    for (uint64_t i = 0; i < stats->trials; i++) {
-        sum += stats->comparisons[i];
-    }
-    stats->mean_comps = sum / stats->trials;
-    
-    double var = 0;
+    welford_t comps, runtime;
+    welford_init(&comps);
+    welford_init(&runtime);
     for (uint64_t i = 0; i < stats->trials; i++) {
-        double diff = stats->comparisons[i] - stats->mean_comps;
-        var += diff * diff;
+        welford_add(&comps, (double)stats->comparisons[i]);
+        welford_add(&runtime, stats->runtimes_us[i]);
     }
-    stats->stddev_comps = sqrt(var / (stats->trials - 1));
-    stats->stderr_comps = stats->stddev_comps / sqrt(stats->trials);
-    
-    /* 95% CI using t-distribution approximation (t ~ 1.96 for large n) */
-    double t_val = 1.96;
-    if (stats->trials < 30) t_val = 2.045;  /* t for df=29 */
-    if (stats->trials < 20) t_val = 2.093;  /* t for df=19 */
-    if (stats->trials < 10) t_val = 2.262;  /* t for df=9 */
-    
+
+    stats->mean_comps = comps.mean;
+    stats->stddev_comps = welford_stddev(&comps);
+    stats->stderr_comps = welford_stderr(&comps);
+
+    /* 95% CI using the t-distribution */
+    double t_val = stats_t95(stats->trials - 1);
     stats->ci95_low = stats->mean_comps - t_val * stats->stderr_comps;
     stats->ci95_high = stats->mean_comps + t_val * stats->stderr_comps;
-    
-    /* Runtime stats */
-    sum = 0;
-    for (uint64_t i = 0; i < stats->trials; i++) {
-        sum += stats->runtimes_us[i];
-    }
-    stats->mean_runtime = sum / stats->trials;
-    
-    var = 0;
-    for (uint64_t i = 0; i < stats->trials; i++) {
-        double diff = stats->runtimes_us[i] - stats->mean_runtime;
-        var += diff * diff;
-    }
-    stats->stddev_runtime = sqrt(var / (stats->trials - 1));
+
+    stats->mean_runtime = runtime.mean;
+    stats->stddev_runtime = welford_stddev(&runtime);
 }
 
-static detailed_stats_t benchmark_sequence(const perm_dataset_t *ds, const gap_sequence_t *seq, int threads) {
+/* first: this is the size's first sequence, whose loads count as trials loaded */
+static detailed_stats_t benchmark_sequence(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                                           const scratch_pool_t *scratch, int threads,
+                                           int first, telemetry_t *tel) {
     detailed_stats_t stats;
     stats.trials = ds->trials;
     stats.comparisons = malloc(ds->trials * sizeof(uint64_t));
@@ -111,8 +75,10 @@ static detailed_stats_t benchmark_sequence(const perm_dataset_t *ds, const gap_s
     
     #pragma omp parallel for schedule(static) num_threads(threads)
     for (uint64_t t = 0; t < ds->trials; t++) {
-        int32_t *arr = malloc(N * sizeof(int32_t));
-        memcpy(arr, &ds->data[t * N], N * sizeof(int32_t));
+        telemetry_slot_t *ts = telemetry_thread_slot(tel);
+        telemetry_begin(ts);
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
         
         struct timespec start, end;
         clock_gettime(CLOCK_MONOTONIC, &start);
@@ -121,7 +87,7 @@ static detailed_stats_t benchmark_sequence(const perm_dataset_t *ds, const gap_s
         
         stats.runtimes_us[t] = (end.tv_sec - start.tv_sec) * 1e6 + 
                                (end.tv_nsec - start.tv_nsec) / 1e3;
-        free(arr);
+        telemetry_end(ts, first, 1, N, stats.comparisons[t], dataset_trial_bytes(ds, t));
     }
     
     compute_stats(&stats);
@@ -129,40 +95,38 @@ static detailed_stats_t benchmark_sequence(const perm_dataset_t *ds, const gap_s
 }
 
 /* Paired t-test for difference */
-static void paired_test(detailed_stats_t *a, detailed_stats_t *b, 
+static void paired_test(detailed_stats_t *a, detailed_stats_t *b,
                         double *mean_diff, double *t_stat, double *p_approx) {
     uint64_t n = a->trials < b->trials ? a->trials : b->trials;
-    
-    double *diffs = malloc(n * sizeof(double));
-    double sum_diff = 0;
-    for (uint64_t i = 0; i < n; i++) {
-        diffs[i] = (double)a->comparisons[i] - (double)b->comparisons[i];
-        sum_diff += diffs[i];
-    }
-    *mean_diff = sum_diff / n;
-    
-    double var = 0;
-    for (uint64_t i = 0; i < n; i++) {
-        double d = diffs[i] - *mean_diff;
-        var += d * d;
-    }
-    double se = sqrt(var / (n - 1)) / sqrt(n);
-    
-    *t_stat = *mean_diff / se;
-    
-    /* Approximate p-value using normal approximation for large n */
-    double z = fabs(*t_stat);
-    *p_approx = 2.0 * (1.0 - 0.5 * (1.0 + erf(z / sqrt(2.0))));
-    
-    free(diffs);
+    paired_result_t r = paired_test_u64(a->comparisons, b->comparisons, n);
+    *mean_diff = r.mean_diff;
+    *t_stat = r.t_stat;
+    *p_approx = r.p_value;
 }
 
 int main(int argc, char **argv) {
     const char *perms_dir = "results/perms";
     int threads = 16;
     
+    const char *telemetry_path = NULL;
+    double telemetry_interval = TELEMETRY_DEFAULT_INTERVAL;
+    
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+    int npos = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetry_path = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry-interval") == 0 && i + 1 < argc) {
+            telemetry_interval = atof(argv[++i]);
+        } else {
+            argv[npos++] = argv[i];
+        }
+    }
+    argc = npos;
     if (argc > 1) perms_dir = argv[1];
     if (argc > 2) threads = atoi(argv[2]);
+    source.perms_dir = perms_dir;
     
 #ifdef _OPENMP
     omp_set_num_threads(threads);
@@ -171,13 +135,24 @@ int main(int argc, char **argv) {
     uint64_t sizes[] = {1000000, 2000000, 4000000, 8000000};
     int num_sizes = 4;
     
+    telemetry_t *tel = NULL;
+    if (telemetry_path) {
+        tel = telemetry_start(telemetry_path, "full_bench", threads, telemetry_interval);
+        if (!tel) return 1;
+    }
+    
     printf("================================================================================\n");
     printf("COMPREHENSIVE SHELLSORT GAP SEQUENCE BENCHMARK\n");
     printf("================================================================================\n\n");
     
     printf("System Configuration:\n");
     printf("  Threads: %d\n", threads);
-    printf("  Permutations directory: %s\n\n", perms_dir);
+    if (source.generate) {
+        printf("  Permutations: generated, master seed 0x%lX, %lu trials\n\n",
+               (unsigned long)source.seed, (unsigned long)source.trials);
+    } else {
+        printf("  Permutations directory: %s\n\n", perms_dir);
+    }
     
     /* Generate sequences */
     gap_sequence_t ciura, evolved;
@@ -199,6 +174,14 @@ int main(int argc, char **argv) {
     double total_ciura = 0, total_evolved = 0;
     double total_ciura_var = 0, total_evolved_var = 0;
     
+    /*
+     * Announce every size for the ETA, two sorts per trial. File datasets
+     * reveal their trial count on load, so the first one stands in for the
+     * rest until each is loaded and revised.
+     */
+    uint64_t planned = source.generate ? source.trials : 0;
+    for (int s = 0; planned && s < num_sizes; s++) telemetry_expect(tel, 2 * planned, sizes[s]);
+
     for (int s = 0; s < num_sizes; s++) {
         uint64_t N = sizes[s];
         
@@ -207,10 +190,15 @@ int main(int argc, char **argv) {
         printf("================================================================================\n");
         
         perm_dataset_t ds;
-        if (load_dataset(perms_dir, N, &ds) < 0) {
+        if (dataset_open(&source, N, ELEM_I32, &ds) < 0) {
             printf("Failed to load dataset for N=%lu\n", N);
+            telemetry_revise(tel, 2 * planned, 0, N);
             continue;
         }
+        if (!planned) {
+            planned = ds.trials;
+            for (int r = s; r < num_sizes; r++) telemetry_expect(tel, 2 * planned, sizes[r]);
+        }
         
         printf("Trials: %lu\n\n", ds.trials);
         
@@ -227,9 +215,23 @@ int main(int argc, char **argv) {
         
         printf("Ciura gaps used: %zu, Evolved gaps used: %zu\n\n", 
                ciura_n.num_gaps, evolved_n.num_gaps);
+
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, threads, N * sizeof(int32_t)) < 0) {
+            telemetry_revise(tel, 2 * planned, 0, N);
+            free_dataset(&ds);
+            continue;
+        }
         
-        detailed_stats_t ciura_stats = benchmark_sequence(&ds, &ciura_n, threads);
-        detailed_stats_t evolved_stats = benchmark_sequence(&ds, &evolved_n, threads);
+        char phase[64];
+        snprintf(phase, sizeof(phase), "N=%lu (%d of %d)", (unsigned long)N, s + 1, num_sizes);
+        telemetry_set_phase(tel, phase);
+        telemetry_revise(tel, 2 * planned, 2 * ds.trials, N);
+        
+        detailed_stats_t ciura_stats = benchmark_sequence(&ds, &ciura_n, &scratch, threads, 1,
+                                                          tel);
+        detailed_stats_t evolved_stats = benchmark_sequence(&ds, &evolved_n, &scratch, threads,
+                                                            0, tel);
         
         printf("COMPARISON COUNTS:\n");
         printf("%-10s %16s %16s %16s %16s\n", "Sequence", "Mean", "StdDev", "StdErr", "95% CI");
@@ -272,9 +274,12 @@ int main(int argc, char **argv) {
         free(ciura_stats.runtimes_us);
         free(evolved_stats.comparisons);
         free(evolved_stats.runtimes_us);
-        free(ds.data);
+        scratch_pool_free(&scratch);
+        free_dataset(&ds);
     }
     
+    telemetry_stop(tel);
+    
     printf("================================================================================\n");
     printf("AGGREGATE RESULTS\n");
     printf("================================================================================\n");
@@ -0,0 +1,103 @@
+/*
+ * gaps_adaptive.h - Size-adaptive gap sequences
+ *
+ * gaps_evolved() was tuned on N = 1M..8M. Below that range its small gaps
+ * are Ciura's and its upper gaps fall where the large-N search put them.
+ * gaps_for_size() picks a sequence tuned for the N range (and input
+ * distribution) being sorted from a compiled-in table, and falls back to
+ * gaps_evolved() wherever no entry applies.
+ *
+ * Entries were searched on generated uniform trials (seed 0x5EED0001) at
+ * sizes inside their range: Tuned-1K with evolve_live, Tuned-100 by
+ * nudging Evolved's gaps >= 50 one at a time. adaptive_bench re-checks
+ * every entry against Evolved on a different seed; an entry is only
+ * listed here if it passes there. On 0xC0FFEE1234 with --trials 300 the
+ * pooled improvement over Evolved (positive = fewer comparisons, as in
+ * full_bench) is +0.32% for Tuned-100 and +0.26% for Tuned-1K. Ranges
+ * without an entry (10K and up, and every non-uniform distribution so
+ * far) use gaps_evolved().
+ */
+
+#ifndef GAPS_ADAPTIVE_H
+#define GAPS_ADAPTIVE_H
+
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "dist.h"
+#include <string.h>
+
+/* One tuned sequence and where it applies */
+typedef struct {
+    const char *name;
+    uint64_t min_n;          /* Applies to min_n <= N < max_n */
+    uint64_t max_n;
+    dist_kind_t dist;        /* Input distribution it was tuned on */
+    double dist_param;
+    const uint64_t *gaps;    /* Ascending, 1 first */
+    size_t num_gaps;
+} gaps_table_entry_t;
+
+/* The compiled-in table, in ascending N order */
+static inline const gaps_table_entry_t *gaps_size_table(size_t *count) {
+    static const uint64_t tuned_100[] = {
+        1, 4, 10, 23, 57, 143, 398
+    };
+    static const uint64_t tuned_1k[] = {
+        1, 4, 10, 23, 57, 132, 301, 767, 1770, 4132
+    };
+    static const gaps_table_entry_t table[] = {
+        { "Tuned-100", 100, 1000, DIST_UNIFORM, 0.0,
+          tuned_100, sizeof(tuned_100) / sizeof(tuned_100[0]) },
+        { "Tuned-1K", 1000, 10000, DIST_UNIFORM, 0.0,
+          tuned_1k, sizeof(tuned_1k) / sizeof(tuned_1k[0]) },
+    };
+    *count = sizeof(table) / sizeof(table[0]);
+    return table;
+}
+
+/* Entry for N elements of distribution dist, or NULL if none applies */
+static inline const gaps_table_entry_t *gaps_table_lookup(uint64_t n, const dist_t *dist) {
+    size_t count;
+    const gaps_table_entry_t *table = gaps_size_table(&count);
+    for (size_t i = 0; i < count; i++) {
+        if (n >= table[i].min_n && n < table[i].max_n && dist->kind == table[i].dist &&
+            dist->param == table[i].dist_param) {
+            return &table[i];
+        }
+    }
+    return NULL;
+}
+
+/* Sequence of a table entry, gaps up to max_gap, extended by 2.25x like Evolved */
+static inline void gaps_table_sequence(gap_sequence_t *seq, const gaps_table_entry_t *entry,
+                                       uint64_t max_gap) {
+    strncpy(seq->name, entry->name, sizeof(seq->name) - 1);
+    seq->name[sizeof(seq->name) - 1] = '\0';
+    seq->num_gaps = 0;
+
+    for (size_t i = 0; i < entry->num_gaps && i < MAX_GAPS && entry->gaps[i] <= max_gap; i++) {
+        seq->gaps[seq->num_gaps++] = entry->gaps[i];
+    }
+
+    while (seq->num_gaps < MAX_GAPS) {
+        uint64_t next = (uint64_t)(seq->gaps[seq->num_gaps - 1] * 2.25);
+        if (next > max_gap || next <= seq->gaps[seq->num_gaps - 1]) break;
+        seq->gaps[seq->num_gaps++] = next;
+    }
+}
+
+/*
+ * Best known sequence for sorting n elements of distribution dist (NULL
+ * for uniform): the matching table entry, else gaps_evolved(seq, n).
+ */
+static inline void gaps_for_size(gap_sequence_t *seq, uint64_t n, const dist_t *dist) {
+    dist_t uniform = dist_uniform();
+    const gaps_table_entry_t *entry = gaps_table_lookup(n, dist ? dist : &uniform);
+    if (entry) {
+        gaps_table_sequence(seq, entry, n);
+    } else {
+        gaps_evolved(seq, n);
+    }
+}
+
+#endif /* GAPS_ADAPTIVE_H */
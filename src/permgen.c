@@ -3,11 +3,43 @@
  * permgen.c - Generate reproducible permutation datasets for benchmarking
  *
  * Usage: ./permgen --out <dir> --seed <hex> --sizes <n1,n2,...> --trials <t1,t2,...>
+ *                  [--type i32|i64|u32|f32|f64|kv] [--threads N] [--rng-scheme v1|v2]
+ *                  [--dist <mode>[,<mode>...]] [--format raw|pg2 [--replay]]
  *
  * Output format per size:
  *   <dir>/perm_<N>.bin   - Binary file with TRIALS permutations
  *   <dir>/perm_<N>.meta  - Metadata (JSON-ish)
  *
+ * With --type other than i32 the files are perm_<N>_<type>.{bin,meta} with
+ * the PERMGENX header from dataset.h; values are an order-preserving map of
+ * the same permutations, so comparison counts match the int32 dataset.
+ *
+ * Trials are independent (each is seeded with derive_seed(master, N, t)), so
+ * they are generated in parallel with OpenMP. The output file is sized up
+ * front and every trial is pwrite()n into its own slot, so the bytes on disk
+ * do not depend on the thread count or on scheduling.
+ *
+ * --rng-scheme v2 switches to the faster RNG_SCHEME_V2 stream (see rng.h).
+ * It produces different permutations for the same seed, so it is opt-in.
+ * v2 files always use the PERMGENX header (a PERMGEN1 header has no room),
+ * which records the scheme so loaders can tell them apart and reject a
+ * conflicting --rng-scheme; v1 reproduces the published datasets.
+ *
+ * --dist writes structured inputs instead of (or as well as) uniform
+ * permutations: sorted prefixes, random swaps, runs, reversed, organ-pipe,
+ * duplicate keys and Zipf keys (see dist.h). Non-uniform files use the
+ * PERMGENX header at PERMGENX_VERSION, which records the mode, are named
+ * perm_<N>[_<type>]_<label>.bin, and list the mode in .meta.
+ *
+ * --format pg2 writes the compressed PERMGEN2 container (permgen2.h)
+ * instead: perm_<N>[_<label>].pg2, int32 trials as independently
+ * decodable chunks, or with --replay only the seed needed to rebuild them.
+ *
+ * Every dataset file also gets a <file>.sum sidecar with an xxh64 digest per
+ * trial and one for the whole file (digest.h), hashed by the thread that
+ * generated each trial; the file digest is repeated in .meta. Tools given
+ * --verify check trials against it as they load them.
+ *
  * Binary format:
  *   - uint64_t magic (0x5045524D47454E31 = "PERMGEN1")
  *   - uint64_t N
@@ -22,12 +54,20 @@
 #include <stdint.h>
 #include <time.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "rng.h"
+#include "dataset.h"
+#include "cli.h"
 
-#define MAGIC 0x5045524D47454E31ULL  /* "PERMGEN1" */
 #define MAX_SIZES 32
+#define MAX_DISTS 16
 
 typedef struct {
     char out_dir[512];
@@ -35,6 +75,13 @@ typedef struct {
     uint64_t sizes[MAX_SIZES];
     uint64_t trials[MAX_SIZES];
     size_t num_sizes;
+    elem_type_t elem_type;
+    int threads;
+    int rng_scheme;
+    dist_t dists[MAX_DISTS];
+    size_t num_dists;
+    int packed;              /* Write PERMGEN2 (.pg2) instead of raw files */
+    int replay;              /* PERMGEN2 replay chunks only */
 } config_t;
 
 static void print_usage(const char *prog) {
@@ -45,27 +92,35 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "  --seed <hex>      Master seed in hex (e.g., 0xC0FFEE1234)\n");
     fprintf(stderr, "  --sizes <list>    Comma-separated list of N values\n");
     fprintf(stderr, "  --trials <list>   Comma-separated list of trial counts (one per size)\n");
+    fprintf(stderr, "  --type <name>     Element type: i32 (default), i64, u32, f32, f64, kv\n");
+    fprintf(stderr, "  --threads N       Number of OpenMP threads (default: all)\n");
+    fprintf(stderr, "  --rng-scheme <v>  v1 (default, reference datasets) or v2 (faster,\n");
+    fprintf(stderr, "                    different permutations for the same seed)\n");
+    fprintf(stderr, "  --dist <list>     Comma-separated input distributions (default: uniform):\n");
+    fprintf(stderr, "                    uniform, sorted[:f], swaps[:k], runs[:r], reversed,\n");
+    fprintf(stderr, "                    organ-pipe, dups[:k], zipf[:s]\n");
+    fprintf(stderr, "  --format <name>   raw (default: PERMGEN1/PERMGENX .bin) or pg2\n");
+    fprintf(stderr, "                    (PERMGEN2: compressed int32 chunks with an index)\n");
+    fprintf(stderr, "  --replay          With --format pg2, store replay tokens instead of data;\n");
+    fprintf(stderr, "                    readers regenerate each trial from the seed\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Example:\n");
     fprintf(stderr, "  %s --out results/perms --seed 0xC0FFEE1234 \\\n", prog);
     fprintf(stderr, "    --sizes 1000,10000,100000,1000000 --trials 1000,1000,1000,100\n");
 }
 
-static int parse_uint64_list(const char *str, uint64_t *out, size_t max, size_t *count) {
+static int parse_dist_list(const char *str, dist_t *out, size_t max, size_t *count) {
     *count = 0;
     char *copy = strdup(str);
     if (!copy) return -1;
 
-    char *tok = strtok(copy, ",");
-    while (tok && *count < max) {
-        char *end;
-        out[*count] = strtoull(tok, &end, 0);
-        if (*end != '\0' && *end != '\n') {
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        if (*count >= max || dist_parse(tok, &out[*count]) < 0) {
+            fprintf(stderr, "Error: Invalid distribution '%s'\n", tok);
             free(copy);
             return -1;
         }
         (*count)++;
-        tok = strtok(NULL, ",");
     }
 
     free(copy);
@@ -75,6 +130,7 @@ static int parse_uint64_list(const char *str, uint64_t *out, size_t max, size_t
 static int parse_args(int argc, char **argv, config_t *cfg) {
     memset(cfg, 0, sizeof(*cfg));
     cfg->master_seed = 0xC0FFEE1234ULL;  /* Default */
+    cfg->rng_scheme = RNG_SCHEME_V1;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
@@ -82,13 +138,13 @@ static int parse_args(int argc, char **argv, config_t *cfg) {
         } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
             cfg->master_seed = strtoull(argv[++i], NULL, 0);
         } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
-            if (parse_uint64_list(argv[++i], cfg->sizes, MAX_SIZES, &cfg->num_sizes) < 0) {
+            if (parse_uint64_list(argv[++i], 2, cfg->sizes, MAX_SIZES, &cfg->num_sizes) < 0) {
                 fprintf(stderr, "Error: Invalid sizes list\n");
                 return -1;
             }
         } else if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
             size_t count;
-            if (parse_uint64_list(argv[++i], cfg->trials, MAX_SIZES, &count) < 0) {
+            if (parse_uint64_list(argv[++i], 1, cfg->trials, MAX_SIZES, &count) < 0) {
                 fprintf(stderr, "Error: Invalid trials list\n");
                 return -1;
             }
@@ -97,6 +153,34 @@ static int parse_args(int argc, char **argv, config_t *cfg) {
                         count, cfg->num_sizes);
                 return -1;
             }
+        } else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            if (elem_type_parse(argv[++i], &cfg->elem_type) < 0) {
+                fprintf(stderr, "Error: Unknown element type '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            cfg->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rng-scheme") == 0 && i + 1 < argc) {
+            if ((cfg->rng_scheme = rng_scheme_parse(argv[++i])) < 0) {
+                fprintf(stderr, "Error: Unknown RNG scheme '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+            if (parse_dist_list(argv[++i], cfg->dists, MAX_DISTS, &cfg->num_dists) < 0) {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char *f = argv[++i];
+            if (strcmp(f, "raw") == 0) {
+                cfg->packed = 0;
+            } else if (strcmp(f, "pg2") == 0) {
+                cfg->packed = 1;
+            } else {
+                fprintf(stderr, "Error: Unknown format '%s'\n", f);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            cfg->replay = 1;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             print_usage(argv[0]);
             exit(0);
@@ -111,98 +195,425 @@ static int parse_args(int argc, char **argv, config_t *cfg) {
         return -1;
     }
 
+    if (cfg->num_dists == 0) {
+        cfg->dists[0] = dist_uniform();
+        cfg->num_dists = 1;
+    }
+
+    if (cfg->packed && cfg->elem_type != ELEM_I32) {
+        fprintf(stderr, "Error: PERMGEN2 stores int32 trials; other types are converted on load\n");
+        return -1;
+    }
+    if (cfg->replay && !cfg->packed) {
+        fprintf(stderr, "Error: --replay requires --format pg2\n");
+        return -1;
+    }
+    for (size_t i = 0; i < cfg->num_sizes; i++) {
+        if (elem_type_check_n(cfg->elem_type, cfg->sizes[i]) < 0) return -1;
+    }
+
     return 0;
 }
 
-static int generate_permutations(const config_t *cfg, size_t size_idx) {
+/* Write len bytes at offset, retrying short writes. Returns 0 or -1. */
+static int pwrite_all(int fd, const void *buf, size_t len, off_t offset) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t w = pwrite(fd, p, len, offset);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        len -= (size_t)w;
+        offset += w;
+    }
+    return 0;
+}
+
+/*
+ * Open meta_path and write the fields every format shares, up to and
+ * including "dist". The caller adds its format fields and the closing brace.
+ */
+static FILE *meta_begin(const config_t *cfg, const char *meta_path, uint64_t N, uint64_t trials,
+                        elem_type_t type, const char *label, uint64_t file_digest) {
+    FILE *meta_file = fopen(meta_path, "w");
+    if (!meta_file) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", meta_path, strerror(errno));
+        return NULL;
+    }
+
+    time_t now = time(NULL);
+    char time_str[64];
+    strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(meta_file, "{\n");
+    fprintf(meta_file, "  \"N\": %lu,\n", (unsigned long)N);
+    fprintf(meta_file, "  \"trials\": %lu,\n", (unsigned long)trials);
+    fprintf(meta_file, "  \"master_seed\": \"0x%lX\",\n", (unsigned long)cfg->master_seed);
+    if (cfg->rng_scheme == RNG_SCHEME_V2) {
+        fprintf(meta_file, "  \"rng\": \"%d-lane xoshiro256** seeded via splitmix64, "
+                "Lemire bounds, bucketed shuffle\",\n", RNG_LANES);
+    } else {
+        fprintf(meta_file, "  \"rng\": \"xoshiro256** seeded via splitmix64\",\n");
+    }
+    fprintf(meta_file, "  \"rng_scheme\": \"v%d\",\n", cfg->rng_scheme);
+    fprintf(meta_file, "  \"seed_derivation\": \"derive_seed(master, N, trial)\",\n");
+    fprintf(meta_file, "  \"generation_date\": \"%s\",\n", time_str);
+    fprintf(meta_file, "  \"elem_type\": \"%s\",\n", elem_type_name(type));
+    fprintf(meta_file, "  \"dist\": \"%s\",\n", label);
+    fprintf(meta_file, "  \"digest\": \"xxh64\",\n");
+    fprintf(meta_file, "  \"file_digest\": \"%016lx\",\n", (unsigned long)file_digest);
+    return meta_file;
+}
+
+/* Write the .sum sidecar of bin_path; returns the file digest through *file_digest */
+static int write_sums(const char *bin_path, const void *header, size_t header_size,
+                      const uint64_t *sums, uint64_t trials, uint64_t *file_digest) {
+    char sum_path[1024 + 8];
+    dataset_path_sums(sum_path, sizeof(sum_path), bin_path);
+    *file_digest = digest_file(header, header_size, sums, trials);
+    return digest_write_sums(sum_path, *file_digest, sums, trials);
+}
+
+/*
+ * PERMGEN2 output: trials are generated and encoded in parallel, one batch
+ * of `threads` trials at a time, then appended in trial order so the file
+ * does not depend on scheduling. The index is written last.
+ */
+static int generate_packed(const config_t *cfg, size_t size_idx, const dist_t *dist) {
     uint64_t N = cfg->sizes[size_idx];
     uint64_t trials = cfg->trials[size_idx];
 
-    /* Allocate array for one permutation */
-    int32_t *arr = malloc(N * sizeof(int32_t));
-    if (!arr) {
-        fprintf(stderr, "Error: Failed to allocate array for N=%lu\n", (unsigned long)N);
+    if (pg2_chunk_capacity(N) > UINT32_MAX) {
+        fprintf(stderr, "Error: N=%lu is too large for PERMGEN2 chunks\n", (unsigned long)N);
         return -1;
     }
 
-    /* Open output files */
-    char bin_path[1024], meta_path[1024];
-    snprintf(bin_path, sizeof(bin_path), "%s/perm_%lu.bin", cfg->out_dir, (unsigned long)N);
-    snprintf(meta_path, sizeof(meta_path), "%s/perm_%lu.meta", cfg->out_dir, (unsigned long)N);
+    char label[64], bin_path[1024], meta_path[1024];
+    dist_label(dist, label, sizeof(label));
+    dataset_path_packed(bin_path, sizeof(bin_path), cfg->out_dir, N, dist);
+    snprintf(meta_path, sizeof(meta_path), "%.*s.meta",
+             (int)(strlen(bin_path) - 4), bin_path);
+
+    permgen2_index_t *index = calloc(trials ? trials : 1, sizeof(permgen2_index_t));
+    uint64_t *sums = calloc(trials ? trials : 1, sizeof(uint64_t));
+    if (!index || !sums) {
+        fprintf(stderr, "Error: Failed to allocate PERMGEN2 index\n");
+        free(index);
+        free(sums);
+        return -1;
+    }
 
-    FILE *bin_file = fopen(bin_path, "wb");
-    if (!bin_file) {
+    int fd = open(bin_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
         fprintf(stderr, "Error: Cannot open %s: %s\n", bin_path, strerror(errno));
-        free(arr);
+        free(index);
+        free(sums);
         return -1;
     }
 
-    /* Write header */
-    uint64_t magic = MAGIC;
-    fwrite(&magic, sizeof(magic), 1, bin_file);
-    fwrite(&N, sizeof(N), 1, bin_file);
-    fwrite(&trials, sizeof(trials), 1, bin_file);
-    fwrite(&cfg->master_seed, sizeof(cfg->master_seed), 1, bin_file);
+    permgen2_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = PERMGEN2_MAGIC;
+    hdr.N = N;
+    hdr.trials = trials;
+    hdr.master_seed = cfg->master_seed;
+    hdr.version = PERMGEN2_VERSION;
+    hdr.dist = (uint32_t)dist->kind;
+    hdr.dist_param = dist->param;
+    hdr.rng_scheme = (uint32_t)cfg->rng_scheme;
+    hdr.index_offset = PERMGEN2_HEADER_SIZE;
+
+    printf("Generating N=%lu, trials=%lu, dist=%s, PERMGEN2%s...\n", (unsigned long)N,
+           (unsigned long)trials, label, cfg->replay ? " (replay)" : "");
+
+    uint64_t offset = PERMGEN2_HEADER_SIZE + trials * sizeof(permgen2_index_t);
+    uint64_t codec_counts[PG2_NUM_CODECS] = {0};
+    int failed = 0;
+
+    if (cfg->replay) {
+        /*
+         * Nothing to store: readers rebuild each trial from the header. The
+         * trials are still generated once for their digests, so --verify
+         * catches a reader whose replay does not reproduce them.
+         */
+        for (uint64_t t = 0; t < trials; t++) {
+            index[t].offset = offset;
+            index[t].codec = PG2_REPLAY;
+        }
+        codec_counts[PG2_REPLAY] = trials;
+
+        #pragma omp parallel
+        {
+            int32_t *arr = malloc(N * sizeof(int32_t));
+            if (!arr) {
+                fprintf(stderr, "Error: Failed to allocate array for N=%lu\n", (unsigned long)N);
+                #pragma omp atomic write
+                failed = 1;
+            }
 
-    printf("Generating N=%lu, trials=%lu...\n", (unsigned long)N, (unsigned long)trials);
+            #pragma omp for schedule(dynamic, 1)
+            for (uint64_t t = 0; t < trials; t++) {
+                if (!arr) continue;
+                dist_generate(arr, N, cfg->master_seed, t, cfg->rng_scheme, dist);
+                sums[t] = digest64(arr, N * sizeof(int32_t), 0);
+            }
+            free(arr);
+        }
+    } else {
+        int batch = 1;
+#ifdef _OPENMP
+        batch = omp_get_max_threads();
+#endif
+        size_t cap = pg2_chunk_capacity(N);
+        int32_t *arrs = malloc((size_t)batch * N * sizeof(int32_t));
+        uint8_t *chunks = malloc((size_t)batch * cap);
+        if (!arrs || !chunks) {
+            fprintf(stderr, "Error: Failed to allocate buffers for N=%lu\n", (unsigned long)N);
+            failed = 1;
+        }
+
+        for (uint64_t base = 0; !failed && base < trials; base += (uint64_t)batch) {
+            uint64_t count = trials - base < (uint64_t)batch ? trials - base : (uint64_t)batch;
+
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (uint64_t k = 0; k < count; k++) {
+                int32_t *arr = arrs + k * N;
+                dist_generate(arr, N, cfg->master_seed, base + k, cfg->rng_scheme, dist);
+                sums[base + k] = digest64(arr, N * sizeof(int32_t), 0);
+                pg2_encode(arr, N, chunks + k * cap, &index[base + k]);
+            }
+
+            for (uint64_t k = 0; k < count && !failed; k++) {
+                permgen2_index_t *e = &index[base + k];
+                e->offset = offset;
+                if (pwrite_all(fd, chunks + k * cap, e->length, (off_t)offset) < 0) {
+                    fprintf(stderr, "Error: Write failed for trial %lu: %s\n",
+                            (unsigned long)(base + k), strerror(errno));
+                    failed = 1;
+                }
+                offset += e->length;
+                codec_counts[e->codec]++;
+            }
 
-    /* Generate and write each permutation */
-    for (uint64_t t = 0; t < trials; t++) {
-        /* Initialize array to identity */
-        for (uint64_t i = 0; i < N; i++) {
-            arr[i] = (int32_t)i;
+            printf("  %lu/%lu trials\r", (unsigned long)(base + count), (unsigned long)trials);
+            fflush(stdout);
         }
 
-        /* Seed RNG for this trial */
-        rng_state_t rng;
-        uint64_t seed = derive_seed(cfg->master_seed, N, t);
-        rng_seed(&rng, seed);
+        free(arrs);
+        free(chunks);
+    }
+    printf("\n");
 
-        /* Shuffle */
-        rng_shuffle(&rng, arr, N);
+    if (!failed && (pwrite_all(fd, &hdr, sizeof(hdr), 0) < 0 ||
+                    pwrite_all(fd, index, trials * sizeof(permgen2_index_t),
+                               PERMGEN2_HEADER_SIZE) < 0)) {
+        fprintf(stderr, "Error: Header write failed for %s: %s\n", bin_path, strerror(errno));
+        failed = 1;
+    }
+    free(index);
+    if (close(fd) < 0 && !failed) {
+        fprintf(stderr, "Error: Cannot close %s: %s\n", bin_path, strerror(errno));
+        failed = 1;
+    }
+    uint64_t file_digest = 0;
+    if (!failed && write_sums(bin_path, &hdr, sizeof(hdr), sums, trials, &file_digest) < 0) {
+        failed = 1;
+    }
+    free(sums);
+    if (failed) return -1;
+
+    uint64_t raw_bytes = PERMGEN1_HEADER_SIZE + trials * N * sizeof(int32_t);
+    FILE *meta_file = meta_begin(cfg, meta_path, N, trials, ELEM_I32, label, file_digest);
+    if (!meta_file) return -1;
+    fprintf(meta_file, "  \"format_version\": %d,\n", PERMGEN2_VERSION);
+    fprintf(meta_file, "  \"bytes\": %lu,\n", (unsigned long)offset);
+    fprintf(meta_file, "  \"raw_bytes\": %lu,\n", (unsigned long)raw_bytes);
+    fprintf(meta_file, "  \"chunks\": {");
+    for (int c = 0, first = 1; c < PG2_NUM_CODECS; c++) {
+        if (!codec_counts[c]) continue;
+        fprintf(meta_file, "%s\"%s\": %lu", first ? "" : ", ", pg2_codec_name((pg2_codec_t)c),
+                (unsigned long)codec_counts[c]);
+        first = 0;
+    }
+    fprintf(meta_file, "},\n");
+    fprintf(meta_file, "  \"format\": \"PERMGEN2, TRIALS %s int32 chunks of N elements\"\n",
+            label);
+    fprintf(meta_file, "}\n");
+    fclose(meta_file);
 
-        /* Write */
-        if (fwrite(arr, sizeof(int32_t), N, bin_file) != N) {
-            fprintf(stderr, "Error: Write failed for trial %lu\n", (unsigned long)t);
-            fclose(bin_file);
-            free(arr);
-            return -1;
+    printf("Wrote %s (%.1f%% of raw), %s and .sum\n", bin_path,
+           100.0 * (double)offset / (double)raw_bytes, meta_path);
+    return 0;
+}
+
+static int generate_permutations(const config_t *cfg, size_t size_idx, const dist_t *dist) {
+    uint64_t N = cfg->sizes[size_idx];
+    uint64_t trials = cfg->trials[size_idx];
+
+    elem_type_t type = cfg->elem_type;
+    size_t elem_size = elem_type_size(type);
+    /* PERMGEN1 has no room for anything but v1 uniform int32 trials */
+    int permgen1 = (type == ELEM_I32 && dist->kind == DIST_UNIFORM &&
+                    cfg->rng_scheme == RNG_SCHEME_V1);
+    size_t header_size = permgen1 ? PERMGEN1_HEADER_SIZE : PERMGENX_HEADER_SIZE;
+    size_t trial_bytes = N * elem_size;
+
+    char label[64];
+    dist_label(dist, label, sizeof(label));
+
+    /* Open output files */
+    char bin_path[1024], meta_path[1024];
+    dataset_path_dist(bin_path, sizeof(bin_path), cfg->out_dir, N, type, dist);
+    snprintf(meta_path, sizeof(meta_path), "%.*s.meta",
+             (int)(strlen(bin_path) - 4), bin_path);
+
+    /*
+     * Write <bin>.tmp and rename it into place only once the .sum and .meta
+     * exist: the file is sized up front, so a partial write would otherwise
+     * leave a full-length .bin with zero-filled trials that passes the size
+     * check.
+     */
+    char tmp_path[1024 + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", bin_path);
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    /* Size the file up front so every trial has its slot */
+    off_t total = (off_t)(header_size + trials * trial_bytes);
+    if (ftruncate(fd, total) < 0) {
+        fprintf(stderr, "Error: Cannot size %s: %s\n", tmp_path, strerror(errno));
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    /* Write header; PERMGEN1 is the first 32 bytes of the same struct */
+    permgenx_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = permgen1 ? PERMGEN1_MAGIC : PERMGENX_MAGIC;
+    hdr.N = N;
+    hdr.trials = trials;
+    hdr.master_seed = cfg->master_seed;
+    if (!permgen1) {
+        hdr.elem_type = (uint32_t)type;
+        hdr.elem_size = (uint32_t)elem_size;
+        hdr.version = PERMGENX_VERSION;
+        hdr.dist = (uint32_t)dist->kind;
+        hdr.dist_param = dist->param;
+        hdr.rng_scheme = (uint32_t)cfg->rng_scheme;
+    }
+    if (pwrite_all(fd, &hdr, header_size, 0) < 0) {
+        fprintf(stderr, "Error: Header write failed for %s: %s\n", tmp_path, strerror(errno));
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    printf("Generating N=%lu, trials=%lu, type=%s, dist=%s...\n", (unsigned long)N,
+           (unsigned long)trials, elem_type_name(type), label);
+
+    uint64_t *sums = calloc(trials ? trials : 1, sizeof(uint64_t));
+    if (!sums) {
+        fprintf(stderr, "Error: Failed to allocate digests for N=%lu\n", (unsigned long)N);
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    int failed = 0;
+    uint64_t done = 0;
+
+    /* Generate and write each permutation; one buffer pair per thread */
+    #pragma omp parallel
+    {
+        int32_t *arr = malloc(N * sizeof(int32_t));
+        void *out = (type == ELEM_I32) ? (void *)arr : malloc(trial_bytes);
+        if (!arr || !out) {
+            fprintf(stderr, "Error: Failed to allocate array for N=%lu\n", (unsigned long)N);
+            #pragma omp atomic write
+            failed = 1;
         }
 
-        if ((t + 1) % 100 == 0 || t + 1 == trials) {
-            printf("  %lu/%lu trials\r", (unsigned long)(t + 1), (unsigned long)trials);
-            fflush(stdout);
+        #pragma omp for schedule(dynamic, 1)
+        for (uint64_t t = 0; t < trials; t++) {
+            int stop;
+            #pragma omp atomic read
+            stop = failed;
+            if (stop || !arr || !out) continue;
+
+            /* Trial t of the distribution, from this trial's derived seed */
+            dist_generate(arr, N, cfg->master_seed, t, cfg->rng_scheme, dist);
+
+            /* Convert and write into this trial's slot (types checked in parse_args()) */
+            if (type != ELEM_I32) {
+                dataset_convert(arr, N, type, out);
+            }
+            sums[t] = digest64(out, trial_bytes, 0);
+            if (pwrite_all(fd, out, trial_bytes, (off_t)(header_size + t * trial_bytes)) < 0) {
+                fprintf(stderr, "Error: Write failed for trial %lu: %s\n",
+                        (unsigned long)t, strerror(errno));
+                #pragma omp atomic write
+                failed = 1;
+                continue;
+            }
+
+            uint64_t d;
+            #pragma omp atomic capture
+            d = ++done;
+            if (d % 100 == 0 || d == trials) {
+                #pragma omp critical(progress)
+                {
+                    printf("  %lu/%lu trials\r", (unsigned long)d, (unsigned long)trials);
+                    fflush(stdout);
+                }
+            }
         }
+
+        free(arr);
+        if (out != arr) free(out);
     }
     printf("\n");
 
-    fclose(bin_file);
-    free(arr);
+    if (close(fd) < 0 && !failed) {
+        fprintf(stderr, "Error: Cannot close %s: %s\n", tmp_path, strerror(errno));
+        failed = 1;
+    }
+    uint64_t file_digest = 0;
+    if (!failed && write_sums(bin_path, &hdr, header_size, sums, trials, &file_digest) < 0) {
+        failed = 1;
+    }
+    free(sums);
+    if (failed) {
+        unlink(tmp_path);
+        return -1;
+    }
 
     /* Write metadata file */
-    FILE *meta_file = fopen(meta_path, "w");
+    FILE *meta_file = meta_begin(cfg, meta_path, N, trials, type, label, file_digest);
     if (!meta_file) {
-        fprintf(stderr, "Error: Cannot open %s: %s\n", meta_path, strerror(errno));
+        unlink(tmp_path);
         return -1;
     }
-
-    time_t now = time(NULL);
-    char time_str[64];
-    strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
-
-    fprintf(meta_file, "{\n");
-    fprintf(meta_file, "  \"N\": %lu,\n", (unsigned long)N);
-    fprintf(meta_file, "  \"trials\": %lu,\n", (unsigned long)trials);
-    fprintf(meta_file, "  \"master_seed\": \"0x%lX\",\n", (unsigned long)cfg->master_seed);
-    fprintf(meta_file, "  \"rng\": \"xoshiro256** seeded via splitmix64\",\n");
-    fprintf(meta_file, "  \"seed_derivation\": \"derive_seed(master, N, trial)\",\n");
-    fprintf(meta_file, "  \"generation_date\": \"%s\",\n", time_str);
-    fprintf(meta_file, "  \"format\": \"binary int32, TRIALS permutations of N elements\"\n");
+    if (permgen1) {
+        fprintf(meta_file, "  \"format\": \"binary int32, TRIALS permutations of N elements\"\n");
+    } else {
+        fprintf(meta_file, "  \"format_version\": %d,\n", PERMGENX_VERSION);
+        fprintf(meta_file, "  \"format\": \"PERMGENX, TRIALS %s trials of N %s elements\"\n",
+                label, elem_type_name(type));
+    }
     fprintf(meta_file, "}\n");
+    if (fclose(meta_file) != 0 || rename(tmp_path, bin_path) < 0) {
+        fprintf(stderr, "Error: Cannot finish %s: %s\n", bin_path, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
 
-    fclose(meta_file);
-
-    printf("Wrote %s and %s\n", bin_path, meta_path);
+    printf("Wrote %s, %s and .sum\n", bin_path, meta_path);
     return 0;
 }
 
@@ -214,12 +625,19 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+#ifdef _OPENMP
+    if (cfg.threads > 0) {
+        omp_set_num_threads(cfg.threads);
+    }
+#endif
+
     /* Create output directory if it doesn't exist */
     mkdir(cfg.out_dir, 0755);
 
     printf("Permutation Generator\n");
     printf("=====================\n");
     printf("Master seed: 0x%lX\n", (unsigned long)cfg.master_seed);
+    printf("RNG scheme:  v%d\n", cfg.rng_scheme);
     printf("Output dir:  %s\n", cfg.out_dir);
     printf("Sizes:       ");
     for (size_t i = 0; i < cfg.num_sizes; i++) {
@@ -232,11 +650,22 @@ int main(int argc, char **argv) {
         printf("%lu", (unsigned long)cfg.trials[i]);
         if (i < cfg.num_sizes - 1) printf(", ");
     }
+    printf("\n");
+    printf("Dists:       ");
+    for (size_t d = 0; d < cfg.num_dists; d++) {
+        char label[64];
+        dist_label(&cfg.dists[d], label, sizeof(label));
+        printf("%s%s", label, d < cfg.num_dists - 1 ? ", " : "");
+    }
     printf("\n\n");
 
     for (size_t i = 0; i < cfg.num_sizes; i++) {
-        if (generate_permutations(&cfg, i) < 0) {
-            return 1;
+        for (size_t d = 0; d < cfg.num_dists; d++) {
+            int rc = cfg.packed ? generate_packed(&cfg, i, &cfg.dists[d])
+                                : generate_permutations(&cfg, i, &cfg.dists[d]);
+            if (rc < 0) {
+                return 1;
+            }
         }
     }
 
@@ -0,0 +1,186 @@
+/*
+ * permgen2.c - PERMGEN2 chunk codecs (see permgen2.h)
+ */
+
+#include "permgen2.h"
+
+#include <string.h>
+
+#define PACK_PAD 8
+
+static const char *const codec_names[PG2_NUM_CODECS] = {
+    "raw", "bitpack", "delta", "replay"
+};
+
+const char *pg2_codec_name(pg2_codec_t codec) {
+    if ((unsigned)codec >= PG2_NUM_CODECS) return "unknown";
+    return codec_names[codec];
+}
+
+size_t pg2_chunk_capacity(uint64_t n) {
+    return n * sizeof(int32_t) + PACK_PAD;
+}
+
+static size_t bitpack_length(uint64_t n, unsigned bits) {
+    return (size_t)((n * bits + 7) / 8) + PACK_PAD;
+}
+
+static size_t bitpack_encode(const int32_t *arr, uint64_t n, unsigned bits, uint8_t *out) {
+    uint64_t acc = 0;
+    unsigned fill = 0;
+    size_t len = 0;
+
+    for (uint64_t i = 0; i < n; i++) {
+        acc |= (uint64_t)(uint32_t)arr[i] << fill;
+        fill += bits;
+        while (fill >= 8) {
+            out[len++] = (uint8_t)acc;
+            acc >>= 8;
+            fill -= 8;
+        }
+    }
+    if (fill) out[len++] = (uint8_t)acc;
+    memset(out + len, 0, PACK_PAD);
+    return len + PACK_PAD;
+}
+
+static inline size_t put_varint(uint8_t *out, size_t len, uint64_t v) {
+    while (v >= 0x80) {
+        out[len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[len++] = (uint8_t)v;
+    return len;
+}
+
+/* Zigzag residual of arr[i] against the "ascending by one" prediction */
+static inline uint64_t delta_residual(const int32_t *arr, uint64_t i) {
+    int64_t prev = i ? (int64_t)arr[i - 1] : -1;
+    int64_t d = (int64_t)arr[i] - prev - 1;
+    return ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+}
+
+/*
+ * Residuals as varints; a zero residual starts a run, written as 0 and
+ * the varint run length - 1. Returns the length, or 0 if it would exceed cap.
+ */
+static size_t delta_encode(const int32_t *arr, uint64_t n, uint8_t *out, size_t cap) {
+    size_t len = 0;
+
+    for (uint64_t i = 0; i < n;) {
+        if (len + 20 > cap) return 0;
+        uint64_t zz = delta_residual(arr, i);
+        if (zz != 0) {
+            len = put_varint(out, len, zz);
+            i++;
+            continue;
+        }
+
+        uint64_t run = 1;
+        while (i + run < n && delta_residual(arr, i + run) == 0) run++;
+        out[len++] = 0;
+        len = put_varint(out, len, run - 1);
+        i += run;
+    }
+    return len;
+}
+
+size_t pg2_encode(const int32_t *arr, uint64_t n, uint8_t *out, permgen2_index_t *entry) {
+    size_t raw_len = n * sizeof(int32_t);
+
+    /* Bits for the largest value; bit-packing needs all values >= 0 */
+    int32_t max = 0, min = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (arr[i] > max) max = arr[i];
+        if (arr[i] < min) min = arr[i];
+    }
+    unsigned bits = 1;
+    while (bits < 32 && ((uint32_t)max >> bits) != 0) bits++;
+    size_t pack_len = (min >= 0) ? bitpack_length(n, bits) : SIZE_MAX;
+
+    size_t best = pack_len < raw_len ? pack_len : raw_len;
+    size_t delta_len = delta_encode(arr, n, out, best);
+    if (delta_len > 0 && delta_len < best) {
+        entry->codec = PG2_DELTA;
+        entry->bits = 0;
+        entry->length = (uint32_t)delta_len;
+        return delta_len;
+    }
+
+    if (pack_len < raw_len) {
+        entry->codec = PG2_BITPACK;
+        entry->bits = (uint8_t)bits;
+        entry->length = (uint32_t)bitpack_encode(arr, n, bits, out);
+    } else {
+        entry->codec = PG2_RAW;
+        entry->bits = 32;
+        entry->length = (uint32_t)raw_len;
+        memcpy(out, arr, raw_len);
+    }
+    return entry->length;
+}
+
+static int bitpack_decode(const uint8_t *in, size_t len, unsigned bits, uint64_t n,
+                          int32_t *arr) {
+    if (bits == 0 || bits > 32 || len < bitpack_length(n, bits)) return -1;
+
+    uint64_t mask = (bits == 32) ? 0xFFFFFFFFULL : ((1ULL << bits) - 1);
+    uint64_t pos = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t w;
+        memcpy(&w, in + (pos >> 3), sizeof(w));
+        arr[i] = (int32_t)(uint32_t)((w >> (pos & 7)) & mask);
+        pos += bits;
+    }
+    return 0;
+}
+
+static inline int get_varint(const uint8_t *in, size_t len, size_t *p, uint64_t *v) {
+    uint64_t x = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (*p >= len) return -1;
+        uint8_t b = in[(*p)++];
+        x |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = x;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int delta_decode(const uint8_t *in, size_t len, uint64_t n, int32_t *arr) {
+    size_t p = 0;
+    int64_t prev = -1;
+
+    for (uint64_t i = 0; i < n;) {
+        uint64_t zz;
+        if (get_varint(in, len, &p, &zz) < 0) return -1;
+
+        if (zz == 0) {
+            uint64_t run;
+            if (get_varint(in, len, &p, &run) < 0 || run >= n - i) return -1;
+            for (uint64_t k = 0; k <= run; k++) arr[i++] = (int32_t)++prev;
+            continue;
+        }
+
+        prev += 1 + ((int64_t)(zz >> 1) ^ -(int64_t)(zz & 1));
+        arr[i++] = (int32_t)prev;
+    }
+    return p == len ? 0 : -1;
+}
+
+int pg2_decode(const uint8_t *chunk, const permgen2_index_t *entry, uint64_t n, int32_t *arr) {
+    switch (entry->codec) {
+        case PG2_RAW:
+            if (entry->length != n * sizeof(int32_t)) return -1;
+            memcpy(arr, chunk, n * sizeof(int32_t));
+            return 0;
+        case PG2_BITPACK:
+            return bitpack_decode(chunk, entry->length, entry->bits, n, arr);
+        case PG2_DELTA:
+            return delta_decode(chunk, entry->length, n, arr);
+        default:
+            return -1;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * permgen2.h - PERMGEN2 compressed dataset container
+ *
+ * Raw PERMGEN1 files grow as 4 * N * TRIALS bytes (3.2 GB at N = 8M, 100
+ * trials). PERMGEN2 stores each int32 trial as an independent chunk behind
+ * an index table, so any trial can be decoded on its own, straight into a
+ * worker's scratch buffer, with no shared decoder state.
+ *
+ * Layout, <dir>/perm_<N>[_<dist label>].pg2:
+ *   - permgen2_header_t (64 bytes)
+ *   - permgen2_index_t index[TRIALS] at header.index_offset
+ *   - chunk data, at the offsets listed in the index
+ *
+ * Chunk codecs (chosen per trial by the writer, smallest wins):
+ *   PG2_RAW      int32 data[N], as in PERMGEN1
+ *   PG2_BITPACK  values (all >= 0) packed LSB-first at `bits` bits each;
+ *                a random permutation of 8M needs 23 of 32 bits
+ *   PG2_DELTA    zigzag residuals against arr[i-1] + 1 as LEB128 varints,
+ *                with runs of zero residuals (ascending stretches) stored as
+ *                a length; small for sorted, nearly sorted and run inputs
+ *   PG2_REPLAY   no data: the trial is rebuilt with dist_generate() from the
+ *                header's master seed, RNG scheme and distribution. A file
+ *                of replay chunks is a few bytes per trial.
+ *
+ * Chunk lengths include 8 bytes of zero padding after bit-packed data so
+ * the decoder can always load a whole 64-bit word.
+ */
+
+#ifndef PERMGEN2_H
+#define PERMGEN2_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PERMGEN2_MAGIC 0x5045524D47454E32ULL  /* "PERMGEN2" */
+#define PERMGEN2_HEADER_SIZE 64
+#define PERMGEN2_VERSION 1
+
+typedef enum {
+    PG2_RAW = 0,
+    PG2_BITPACK,
+    PG2_DELTA,
+    PG2_REPLAY,
+    PG2_NUM_CODECS
+} pg2_codec_t;
+
+/* On-disk header */
+typedef struct {
+    uint64_t magic;
+    uint64_t N;
+    uint64_t trials;
+    uint64_t master_seed;
+    uint32_t version;
+    uint32_t dist;           /* dist_kind_t */
+    double dist_param;
+    uint32_t rng_scheme;     /* RNG_SCHEME_* the trials were generated with */
+    uint32_t reserved;
+    uint64_t index_offset;   /* Byte offset of index[0] */
+} permgen2_header_t;
+
+/* One index entry per trial */
+typedef struct {
+    uint64_t offset;         /* Byte offset of the chunk in the file */
+    uint32_t length;         /* Chunk bytes (0 for PG2_REPLAY) */
+    uint8_t codec;           /* pg2_codec_t */
+    uint8_t bits;            /* PG2_BITPACK bits per value */
+    uint16_t reserved;
+} permgen2_index_t;
+
+/* Codec name ("raw", "bitpack", "delta", "replay") */
+const char *pg2_codec_name(pg2_codec_t codec);
+
+/* Bytes an encode buffer for n elements needs */
+size_t pg2_chunk_capacity(uint64_t n);
+
+/*
+ * Encode arr (n int32) into out (pg2_chunk_capacity(n) bytes), picking the
+ * smallest of raw, bit-packed and delta. Fills entry's codec, bits and
+ * length (not offset). Returns the chunk length.
+ */
+size_t pg2_encode(const int32_t *arr, uint64_t n, uint8_t *out, permgen2_index_t *entry);
+
+/*
+ * Decode a stored chunk (any codec but PG2_REPLAY) of n elements into arr.
+ * Returns 0, or -1 if the chunk is malformed.
+ */
+int pg2_decode(const uint8_t *chunk, const permgen2_index_t *entry, uint64_t n, int32_t *arr);
+
+#endif /* PERMGEN2_H */
@@ -0,0 +1,250 @@
+/*
+ * prefix_cache.c - LRU snapshot cache for shared leading gap passes
+ */
+
+#include "prefix_cache.h"
+#include "rng.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PREFIX_BUCKETS 4096
+
+struct prefix_entry {
+    /* Key */
+    uint64_t hash;
+    uint64_t master_seed;
+    int rng_scheme;
+    uint64_t N;
+    uint64_t trial;
+    size_t depth;            /* Passes applied */
+    uint64_t gaps[MAX_GAPS]; /* The depth leading gaps, largest first */
+
+    /* Value */
+    sort_stats_t stats;      /* Counts of those passes */
+    int32_t *data;           /* N elements after the passes */
+
+    int pins;                /* Readers copying data; not evictable while > 0 */
+    prefix_entry_t *next;    /* Bucket chain */
+    prefix_entry_t *lru_prev;
+    prefix_entry_t *lru_next;
+};
+
+static void pc_lock(prefix_cache_t *pc) {
+#ifdef _OPENMP
+    omp_set_lock(&pc->lock);
+#else
+    (void)pc;
+#endif
+}
+
+static void pc_unlock(prefix_cache_t *pc) {
+#ifdef _OPENMP
+    omp_unset_lock(&pc->lock);
+#else
+    (void)pc;
+#endif
+}
+
+int prefix_cache_init(prefix_cache_t *pc, size_t budget_bytes) {
+    memset(pc, 0, sizeof(*pc));
+    pc->budget = budget_bytes;
+    pc->stride = 2;
+    pc->num_buckets = PREFIX_BUCKETS;
+    pc->buckets = calloc(pc->num_buckets, sizeof(prefix_entry_t *));
+    if (!pc->buckets) return -1;
+#ifdef _OPENMP
+    omp_init_lock(&pc->lock);
+#endif
+    return 0;
+}
+
+void prefix_cache_free(prefix_cache_t *pc) {
+    if (!pc->buckets) return;
+
+    for (prefix_entry_t *e = pc->lru_head; e;) {
+        prefix_entry_t *next = e->lru_next;
+        free(e->data);
+        free(e);
+        e = next;
+    }
+    free(pc->buckets);
+    pc->buckets = NULL;
+    pc->lru_head = pc->lru_tail = NULL;
+    pc->bytes = 0;
+#ifdef _OPENMP
+    omp_destroy_lock(&pc->lock);
+#endif
+}
+
+/* Hash of (dataset, trial, leading gaps); gaps are largest first */
+static uint64_t prefix_hash(const perm_dataset_t *ds, uint64_t t, const uint64_t *gaps,
+                            size_t depth) {
+    uint64_t h = ds->master_seed ^ (ds->N * 0x9e3779b97f4a7c15ULL);
+    h = splitmix64(&h) ^ (uint64_t)ds->rng_scheme;
+    h = splitmix64(&h) ^ t;
+    h = splitmix64(&h) ^ depth;
+    for (size_t i = 0; i < depth; i++) {
+        h ^= gaps[i];
+        h = splitmix64(&h);
+    }
+    return h;
+}
+
+static int entry_matches(const prefix_entry_t *e, uint64_t hash, const perm_dataset_t *ds,
+                         uint64_t t, const uint64_t *gaps, size_t depth) {
+    return e->hash == hash && e->depth == depth && e->trial == t && e->N == ds->N &&
+           e->master_seed == ds->master_seed && e->rng_scheme == ds->rng_scheme &&
+           memcmp(e->gaps, gaps, depth * sizeof(uint64_t)) == 0;
+}
+
+/* Caller holds the lock */
+static prefix_entry_t *find_locked(prefix_cache_t *pc, uint64_t hash, const perm_dataset_t *ds,
+                                   uint64_t t, const uint64_t *gaps, size_t depth) {
+    for (prefix_entry_t *e = pc->buckets[hash % pc->num_buckets]; e; e = e->next) {
+        if (entry_matches(e, hash, ds, t, gaps, depth)) return e;
+    }
+    return NULL;
+}
+
+static void lru_unlink(prefix_cache_t *pc, prefix_entry_t *e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next; else pc->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev; else pc->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push_front(prefix_cache_t *pc, prefix_entry_t *e) {
+    e->lru_prev = NULL;
+    e->lru_next = pc->lru_head;
+    if (pc->lru_head) pc->lru_head->lru_prev = e;
+    pc->lru_head = e;
+    if (!pc->lru_tail) pc->lru_tail = e;
+}
+
+/* Evict unpinned entries from the LRU end until `need` more bytes fit. Caller holds the lock. */
+static int make_room_locked(prefix_cache_t *pc, size_t need) {
+    prefix_entry_t *e = pc->lru_tail;
+    while (pc->bytes + need > pc->budget && e) {
+        prefix_entry_t *prev = e->lru_prev;
+        if (e->pins == 0) {
+            prefix_entry_t **link = &pc->buckets[e->hash % pc->num_buckets];
+            while (*link != e) link = &(*link)->next;
+            *link = e->next;
+            lru_unlink(pc, e);
+            pc->bytes -= e->N * sizeof(int32_t);
+            pc->evictions++;
+            free(e->data);
+            free(e);
+        }
+        e = prev;
+    }
+    return pc->bytes + need <= pc->budget;
+}
+
+/* Store arr as the snapshot after `depth` passes (copy made outside the lock) */
+static void store_snapshot(prefix_cache_t *pc, const perm_dataset_t *ds, uint64_t t,
+                           const uint64_t *gaps, size_t depth, const int32_t *arr,
+                           sort_stats_t stats) {
+    size_t bytes = ds->N * sizeof(int32_t);
+    if (bytes > pc->budget) return;
+
+    uint64_t hash = prefix_hash(ds, t, gaps, depth);
+
+    pc_lock(pc);
+    int present = find_locked(pc, hash, ds, t, gaps, depth) != NULL;
+    pc_unlock(pc);
+    if (present) return;
+
+    prefix_entry_t *e = malloc(sizeof(*e));
+    int32_t *data = malloc(bytes);
+    if (!e || !data) {
+        free(e);
+        free(data);
+        return;
+    }
+    memcpy(data, arr, bytes);
+
+    e->hash = hash;
+    e->master_seed = ds->master_seed;
+    e->rng_scheme = ds->rng_scheme;
+    e->N = ds->N;
+    e->trial = t;
+    e->depth = depth;
+    memcpy(e->gaps, gaps, depth * sizeof(uint64_t));
+    e->stats = stats;
+    e->data = data;
+    e->pins = 0;
+
+    pc_lock(pc);
+    /* Another thread may have stored it meanwhile */
+    if (find_locked(pc, hash, ds, t, gaps, depth) || !make_room_locked(pc, bytes)) {
+        pc_unlock(pc);
+        free(data);
+        free(e);
+        return;
+    }
+    size_t b = hash % pc->num_buckets;
+    e->next = pc->buckets[b];
+    pc->buckets[b] = e;
+    lru_push_front(pc, e);
+    pc->bytes += bytes;
+    pc_unlock(pc);
+}
+
+sort_stats_t prefix_cache_sort(prefix_cache_t *pc, const perm_dataset_t *ds, uint64_t t,
+                               const gap_sequence_t *seq, int32_t *arr) {
+    size_t n = ds->N;
+
+    /* Effective gaps in the order they run */
+    uint64_t gaps[MAX_GAPS];
+    size_t passes = 0;
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        if (seq->gaps[g - 1] < n) gaps[passes++] = seq->gaps[g - 1];
+    }
+
+    /* Deepest cached prefix (a full sort is never stored, so start below it) */
+    size_t depth = 0;
+    sort_stats_t stats = {0, 0};
+    prefix_entry_t *hit = NULL;
+
+    pc_lock(pc);
+    for (size_t d = passes > 0 ? passes - 1 : 0; d > 0; d--) {
+        hit = find_locked(pc, prefix_hash(ds, t, gaps, d), ds, t, gaps, d);
+        if (hit) {
+            depth = d;
+            hit->pins++;
+            lru_unlink(pc, hit);
+            lru_push_front(pc, hit);
+            break;
+        }
+    }
+    if (hit) pc->hits++; else pc->misses++;
+    pc->passes_skipped += depth;
+    pc->passes_run += passes - depth;
+    pc_unlock(pc);
+
+    if (hit) {
+        memcpy(arr, hit->data, n * sizeof(int32_t));
+        stats = hit->stats;
+        pc_lock(pc);
+        hit->pins--;
+        pc_unlock(pc);
+    } else {
+        dataset_copy_trial(ds, t, arr);
+    }
+
+    /* Remaining passes, one at a time so intermediate states can be stored */
+    size_t stride = pc->stride ? pc->stride : 1;
+    for (size_t p = depth; p < passes; p++) {
+        sort_stats_t s = shellsort_stats_passes(arr, n, seq, p, p + 1);
+        stats.comparisons += s.comparisons;
+        stats.moves += s.moves;
+
+        size_t done = p + 1;
+        if (done < passes && done % stride == 0 && pc->budget > 0) {
+            store_snapshot(pc, ds, t, gaps, done, arr, stats);
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,68 @@
+/*
+ * prefix_cache.h - Reuse of partially sorted arrays across gap sequences
+ *
+ * Shellsort runs gaps largest first, so two sequences whose k largest
+ * (effective, < N) gaps agree leave trial t in the same state after k
+ * passes, with the same comparison and move counts. The cache keeps such
+ * snapshots, keyed by (dataset, trial, leading gaps), and a sort restores
+ * the deepest matching one and runs only the remaining passes through
+ * shellsort_stats_from().
+ *
+ * Siblings in a search population usually differ in one small gap, so most
+ * of their work is a shared prefix. Snapshots are N * 4 bytes (32 MiB at
+ * N = 8M), so the cache has a byte budget and evicts least recently used
+ * snapshots. Results are identical to shellsort_stats() on the same trial.
+ *
+ * Thread safety: all functions may be called from inside a parallel
+ * region. Table updates take one lock; snapshot copies run outside it on
+ * pinned entries.
+ */
+
+#ifndef PREFIX_CACHE_H
+#define PREFIX_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "shellsort.h"
+#include "dataset.h"
+
+typedef struct prefix_entry prefix_entry_t;
+
+typedef struct {
+    size_t budget;           /* Bytes of snapshot data allowed */
+    size_t bytes;            /* Bytes currently held */
+    size_t stride;           /* Snapshot every stride-th pass boundary (default 2) */
+    prefix_entry_t **buckets;
+    size_t num_buckets;
+    prefix_entry_t *lru_head; /* Most recently used */
+    prefix_entry_t *lru_tail; /* Eviction candidate */
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t passes_skipped;
+    uint64_t passes_run;
+    uint64_t evictions;
+#ifdef _OPENMP
+    omp_lock_t lock;
+#endif
+} prefix_cache_t;
+
+/* Returns 0 on success, -1 on allocation failure. budget_bytes 0 disables storing. */
+int prefix_cache_init(prefix_cache_t *pc, size_t budget_bytes);
+
+/* Drop every snapshot and free the table */
+void prefix_cache_free(prefix_cache_t *pc);
+
+/*
+ * Sort trial t of ds with seq into arr (N int32) and return its stats,
+ * starting from the deepest cached snapshot of seq's leading passes and
+ * storing new snapshots every pc->stride passes as it goes.
+ */
+sort_stats_t prefix_cache_sort(prefix_cache_t *pc, const perm_dataset_t *ds, uint64_t t,
+                               const gap_sequence_t *seq, int32_t *arr);
+
+#endif /* PREFIX_CACHE_H */
@@ -0,0 +1,158 @@
+/*
+ * race.c - Racing evaluator (see race.h)
+ */
+
+#include "race.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void race_config_default(race_config_t *cfg) {
+    cfg->batch = 8;
+    cfg->min_trials = 16;
+    cfg->alpha = 1e-3;
+    cfg->stop_better = 1;
+}
+
+int race_reference_init(race_reference_t *ref, const gap_sequence_t *seq,
+                        const perm_dataset_t *ds) {
+    ref->seq = seq;
+    ref->ds = ds;
+    ref->filled = 0;
+    ref->comps = malloc((ds->trials ? ds->trials : 1) * sizeof(uint64_t));
+    return ref->comps ? 0 : -1;
+}
+
+void race_reference_free(race_reference_t *ref) {
+    free(ref->comps);
+    ref->comps = NULL;
+    ref->filled = 0;
+}
+
+void race_reference_fill(race_reference_t *ref, uint64_t upto, const scratch_pool_t *scratch,
+                         int threads) {
+    const perm_dataset_t *ds = ref->ds;
+    if (upto > ds->trials) upto = ds->trials;
+    if (upto <= ref->filled) return;
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (uint64_t t = ref->filled; t < upto; t++) {
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
+        ref->comps[t] = shellsort(arr, ds->N, ref->seq);
+    }
+    ref->filled = upto;
+}
+
+double race_reference_mean(race_reference_t *ref, uint64_t upto, const scratch_pool_t *scratch,
+                           int threads) {
+    if (upto > ref->ds->trials) upto = ref->ds->trials;
+    if (upto == 0) return 0.0;
+
+    race_reference_fill(ref, upto, scratch, threads);
+    uint64_t total = 0;
+    for (uint64_t t = 0; t < upto; t++) total += ref->comps[t];
+    return (double)total / (double)upto;
+}
+
+const char *race_verdict_name(race_verdict_t v) {
+    switch (v) {
+        case RACE_BETTER: return "better";
+        case RACE_WORSE:  return "worse";
+        default:          return "tie";
+    }
+}
+
+int race_evaluate_many(race_reference_t *ref, const gap_sequence_t *const *cands, size_t count,
+                       const scratch_pool_t *scratch, const race_config_t *cfg, int threads,
+                       race_result_t *results) {
+    const perm_dataset_t *ds = ref->ds;
+    uint64_t N = ds->N;
+    uint64_t trials = ds->trials;
+    uint64_t batch = cfg->batch ? cfg->batch : 1;
+
+    welford_t *diffs = malloc((count ? count : 1) * sizeof(welford_t));
+    uint64_t *cand_total = calloc(count ? count : 1, sizeof(uint64_t));
+    size_t *active = malloc((count ? count : 1) * sizeof(size_t));
+    uint64_t *comps = malloc((count ? count : 1) * batch * sizeof(uint64_t));
+    if (!diffs || !cand_total || !active || !comps) {
+        free(diffs);
+        free(cand_total);
+        free(active);
+        free(comps);
+        return -1;
+    }
+
+    size_t num_active = count;
+    for (size_t i = 0; i < count; i++) {
+        welford_init(&diffs[i]);
+        active[i] = i;
+        results[i].verdict = RACE_TIE;
+    }
+
+    uint64_t done = 0;
+    while (num_active > 0 && done < trials) {
+        uint64_t width = trials - done < batch ? trials - done : batch;
+        race_reference_fill(ref, done + width, scratch, threads);
+
+        /* Next batch for every undecided candidate, one flat loop */
+        uint64_t work = (uint64_t)num_active * width;
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+        for (uint64_t w = 0; w < work; w++) {
+            size_t a = (size_t)(w / width);
+            uint64_t t = done + w % width;
+            int32_t *arr = scratch_get(scratch);
+            dataset_copy_trial(ds, t, arr);
+            comps[w] = shellsort(arr, N, cands[active[a]]);
+        }
+
+        /* Fold in the batch in trial order, then look */
+        size_t kept = 0;
+        for (size_t a = 0; a < num_active; a++) {
+            size_t i = active[a];
+            for (uint64_t k = 0; k < width; k++) {
+                uint64_t c = comps[a * width + k];
+                cand_total[i] += c;
+                welford_add(&diffs[i], (double)c - (double)ref->comps[done + k]);
+            }
+
+            paired_result_t r = paired_test_welford(&diffs[i]);
+            if (diffs[i].n >= cfg->min_trials && r.p_value < cfg->alpha &&
+                (r.mean_diff > 0.0 || cfg->stop_better)) {
+                results[i].verdict = r.mean_diff > 0.0 ? RACE_WORSE : RACE_BETTER;
+            } else {
+                active[kept++] = i;
+            }
+        }
+        num_active = kept;
+        done += width;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        race_result_t *res = &results[i];
+        uint64_t n = diffs[i].n;
+        uint64_t ref_total = 0;
+        for (uint64_t t = 0; t < n; t++) ref_total += ref->comps[t];
+
+        res->trials_used = n;
+        res->test = paired_test_welford(&diffs[i]);
+        res->mean_candidate = n ? (double)cand_total[i] / (double)n : 0.0;
+        res->mean_reference = n ? (double)ref_total / (double)n : 0.0;
+
+        /* A candidate still running at the end is decided on all trials */
+        if (res->verdict == RACE_TIE && n >= cfg->min_trials && res->test.p_value < cfg->alpha) {
+            res->verdict = res->test.mean_diff > 0.0 ? RACE_WORSE : RACE_BETTER;
+        }
+    }
+
+    free(diffs);
+    free(cand_total);
+    free(active);
+    free(comps);
+    return 0;
+}
+
+int race_evaluate(race_reference_t *ref, const gap_sequence_t *cand, const scratch_pool_t *scratch,
+                  const race_config_t *cfg, int threads, race_result_t *result) {
+    return race_evaluate_many(ref, &cand, 1, scratch, cfg, threads, result);
+}
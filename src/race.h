@@ -0,0 +1,92 @@
+/*
+ * race.h - Racing (sequential paired) evaluation against a reference
+ *
+ * A candidate gap sequence and a reference are sorted on the same trials in
+ * batches. After each batch the per-trial differences (candidate minus
+ * reference comparisons) go through paired_test_welford(), and the race
+ * stops as soon as the difference is significant at the per-look alpha.
+ * Most candidates in a search are clearly worse than Ciura, and those are
+ * decided after one or two batches instead of the full trial count.
+ *
+ * The test is repeated after every batch, so the overall false-decision
+ * rate is higher than alpha; the default alpha is set low (1e-3) and a
+ * minimum trial count guards the normal approximation at small n.
+ */
+
+#ifndef RACE_H
+#define RACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "shellsort.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "stats.h"
+
+typedef struct {
+    uint64_t batch;          /* Trials added per look (default 8) */
+    uint64_t min_trials;     /* No decision before this many pairs (default 16) */
+    double alpha;            /* Per-look two-sided significance (default 1e-3) */
+    int stop_better;         /* 1: also stop early when the candidate is better (default) */
+} race_config_t;
+
+typedef enum {
+    RACE_TIE = 0,            /* Ran out of trials without a decision */
+    RACE_BETTER,             /* Significantly fewer comparisons than the reference */
+    RACE_WORSE               /* Significantly more comparisons than the reference */
+} race_verdict_t;
+
+typedef struct {
+    race_verdict_t verdict;
+    uint64_t trials_used;    /* Pairs actually sorted */
+    double mean_candidate;   /* Mean comparisons over trials_used */
+    double mean_reference;   /* Mean reference comparisons over the same trials */
+    paired_result_t test;    /* Paired test on candidate - reference */
+} race_result_t;
+
+/*
+ * Reference comparison counts, filled per trial on first use and shared by
+ * every candidate raced on the same dataset.
+ */
+typedef struct {
+    const gap_sequence_t *seq;
+    const perm_dataset_t *ds;
+    uint64_t *comps;         /* ds->trials entries */
+    uint64_t filled;         /* comps[0..filled) are valid */
+} race_reference_t;
+
+void race_config_default(race_config_t *cfg);
+
+/* Returns 0 on success, -1 on allocation failure */
+int race_reference_init(race_reference_t *ref, const gap_sequence_t *seq,
+                        const perm_dataset_t *ds);
+void race_reference_free(race_reference_t *ref);
+
+/* Make sure reference counts exist for trials [0, upto) */
+void race_reference_fill(race_reference_t *ref, uint64_t upto, const scratch_pool_t *scratch,
+                         int threads);
+
+/* Mean reference comparisons over trials [0, upto), filling as needed */
+double race_reference_mean(race_reference_t *ref, uint64_t upto, const scratch_pool_t *scratch,
+                           int threads);
+
+/*
+ * Race count candidates against ref. Each round runs the next batch of
+ * trials for every undecided candidate as one parallel loop, so a whole
+ * population can be raced together. scratch must hold N int32 per thread.
+ *
+ * Returns 0 on success, -1 on allocation failure. results[i] belongs to
+ * cands[i].
+ */
+int race_evaluate_many(race_reference_t *ref, const gap_sequence_t *const *cands, size_t count,
+                       const scratch_pool_t *scratch, const race_config_t *cfg, int threads,
+                       race_result_t *results);
+
+/* Single-candidate race_evaluate_many() */
+int race_evaluate(race_reference_t *ref, const gap_sequence_t *cand, const scratch_pool_t *scratch,
+                  const race_config_t *cfg, int threads, race_result_t *result);
+
+const char *race_verdict_name(race_verdict_t v);
+
+#endif /* RACE_H */
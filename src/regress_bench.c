@@ -0,0 +1,492 @@
+#define _GNU_SOURCE
+/*
+ * regress_bench.c - Performance regression suite against a stored baseline
+ *
+ * Usage: ./regress_bench [--out <file.json>] [--baseline <file.json>]
+ *                        [--sizes n1,n2,...] [--trials T] [--seed <hex>] [--threads T]
+ *                        [--time-tolerance F] [--noise-k K] [--no-time] [--subset]
+ *                        [--cpu c] [--no-pin]
+ *
+ * Runs a fixed matrix - every size x the baselines and Evolved x the
+ * counting, fast, simd and parallel kernels - on trials generated from one
+ * master seed (the same permutations permgen writes for it), and prints one
+ * line per cell. Each cell records the total comparisons over all trials
+ * (0 for fast, which does not count) and the median and MAD of the
+ * per-trial sort time in nanoseconds, timed in TSC cycles on a pinned
+ * thread. Every sorted trial is checked.
+ *
+ * --out writes the cells as JSON. --baseline reads a file written by an
+ * earlier --out (one cell per line; only this tool's own layout is parsed)
+ * and compares each matching cell:
+ *
+ *   - comparisons must be identical, and every counting kernel must agree
+ *     with the counting kernel in the same run, baseline or not; fast has
+ *     no count, so it is checked for sorted output and runtime only;
+ *   - the median time may not exceed the baseline's by more than
+ *     max(F * baseline median, K * max(baseline MAD, current MAD)), that
+ *     is the tolerance or the noise, whichever is larger (defaults F = 0.10,
+ *     K = 3).
+ *
+ * Runtimes are only compared when the baseline was recorded on the same
+ * CPU model (or they are skipped with a warning), and --no-time compares
+ * counts only, for machines that do not match. A baseline cell this run
+ * does not cover (fewer sizes, a dropped kernel) is a failure unless
+ * --subset says a partial run is intended. Exit status is 0 when nothing
+ * regressed and 1 on any regression, count mismatch, missing cell,
+ * unsorted output or error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "rng.h"
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "dataset.h"
+#include "stats.h"
+#include "timing.h"
+#include "cli.h"
+
+#define MAX_SIZES 16
+#define NUM_SEQS (NUM_BASELINES + 1)
+#define NUM_KERNELS 4
+#define MAX_CELLS (MAX_SIZES * NUM_SEQS * NUM_KERNELS)
+#define DEFAULT_TRIALS 10
+#define DEFAULT_SEED 0xC0FFEE1234ULL
+#define DEFAULT_TOLERANCE 0.10
+#define DEFAULT_NOISE_K 3.0
+
+typedef enum {
+    RK_COUNTING = 0,
+    RK_FAST,
+    RK_SIMD,
+    RK_PARALLEL
+} regress_kernel_t;
+
+static const char *kernel_names[NUM_KERNELS] = {"counting", "fast", "simd", "parallel"};
+
+typedef struct {
+    uint64_t n;
+    char sequence[64];
+    char kernel[16];
+    uint64_t comparisons;    /* Total over all trials, 0 for fast */
+    double median_ns;
+    double mad_ns;
+} cell_t;
+
+typedef struct {
+    char cpu[128];
+    uint64_t seed;
+    uint64_t trials;
+    cell_t cells[MAX_CELLS];
+    size_t num_cells;
+} run_t;
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [--out <file.json>] [--baseline <file.json>] [--sizes n1,...]\n"
+                    "       [--trials T] [--seed <hex>] [--threads T] [--time-tolerance F]\n"
+                    "       [--noise-k K] [--no-time] [--cpu c] [--no-pin]\n", prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --out <file>      Write this run as JSON\n");
+    fprintf(stderr, "  --baseline <file> Compare against an earlier --out file\n");
+    fprintf(stderr, "  --sizes <list>    Sizes (default: 1000,100000,1000000)\n");
+    fprintf(stderr, "  --trials T        Trials per size (default: %d)\n", DEFAULT_TRIALS);
+    fprintf(stderr, "  --seed <hex>      Master seed of the trials (default: 0x%llX)\n",
+            (unsigned long long)DEFAULT_SEED);
+    fprintf(stderr, "  --threads T       Threads of the parallel kernel (default: all)\n");
+    fprintf(stderr, "  --time-tolerance F  Allowed relative slowdown (default: %.2f)\n",
+            DEFAULT_TOLERANCE);
+    fprintf(stderr, "  --noise-k K       Noise bound in MADs (default: %.0f)\n", DEFAULT_NOISE_K);
+    fprintf(stderr, "  --no-time         Compare comparison counts only\n");
+    fprintf(stderr, "  --subset          Allow baseline cells this run does not cover\n");
+    fprintf(stderr, "  --cpu c           CPU to pin the measuring thread to (default: 0)\n");
+    fprintf(stderr, "  --no-pin          Leave the measuring thread unpinned\n");
+}
+
+/* Sort with one kernel; returns its comparison count (0 for fast) */
+static uint64_t sort_kernel(regress_kernel_t kernel, int32_t *arr, size_t n,
+                            const gap_sequence_t *seq, int threads) {
+    switch (kernel) {
+        case RK_COUNTING: return shellsort_stats(arr, n, seq).comparisons;
+        case RK_FAST:     shellsort_fast(arr, n, seq); return 0;
+        case RK_SIMD:     return shellsort_simd(arr, n, seq);
+        case RK_PARALLEL: return shellsort_parallel(arr, n, seq, threads);
+    }
+    return 0;
+}
+
+/*
+ * One cell: every trial copied into arr (untimed), sorted and checked.
+ * Returns 0, or -1 if a result was not sorted or memory ran out.
+ */
+static int run_cell(const perm_dataset_t *ds, regress_kernel_t kernel, const gap_sequence_t *seq,
+                    int threads, double ns_per_tick, int32_t *src, int32_t *arr,
+                    double *samples, cell_t *cell) {
+    uint64_t N = ds->N;
+    memset(cell, 0, sizeof(*cell));
+    cell->n = N;
+    snprintf(cell->sequence, sizeof(cell->sequence), "%.*s", (int)sizeof(cell->sequence) - 1, seq->name);
+    snprintf(cell->kernel, sizeof(cell->kernel), "%s", kernel_names[kernel]);
+
+    /* One untimed sort to warm the code and the sequence's gap table */
+    dataset_copy_trial(ds, 0, arr);
+    sort_kernel(kernel, arr, N, seq, threads);
+
+    for (uint64_t t = 0; t < ds->trials; t++) {
+        dataset_copy_trial(ds, t, src);
+        memcpy(arr, src, N * sizeof(int32_t));
+        uint64_t c0 = timing_begin();
+        cell->comparisons += sort_kernel(kernel, arr, N, seq, threads);
+        uint64_t c1 = timing_end();
+        samples[t] = (double)(c1 - c0) * ns_per_tick;
+        for (size_t i = 1; i < N; i++) {
+            if (arr[i - 1] > arr[i]) {
+                fprintf(stderr, "Error: %s/%s left N=%lu trial %lu unsorted\n", seq->name,
+                        kernel_names[kernel], (unsigned long)N, (unsigned long)t);
+                return -1;
+            }
+        }
+    }
+
+    if (stats_median(samples, ds->trials, &cell->median_ns) < 0 ||
+        stats_mad(samples, ds->trials, &cell->mad_ns) < 0) {
+        fprintf(stderr, "Error: Out of memory for statistics\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int write_json(const char *path, const run_t *run, double tsc_hz) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    time_t now = time(NULL);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    /* The cpu and cell lines are read back by read_json(); keep one per line */
+    fprintf(f, "{\n");
+    fprintf(f, "  \"tool\": \"regress_bench\",\n");
+    fprintf(f, "  \"format\": 1,\n");
+    fprintf(f, "  \"timestamp\": \"%s\",\n", stamp);
+    fprintf(f, "  \"cpu\": \"%s\",\n", run->cpu);
+    fprintf(f, "  \"tsc_hz\": %.0f,\n", tsc_hz);
+    fprintf(f, "  \"seed\": \"0x%lX\",\n", (unsigned long)run->seed);
+    fprintf(f, "  \"trials\": %lu,\n", (unsigned long)run->trials);
+    fprintf(f, "  \"cells\": [\n");
+    for (size_t i = 0; i < run->num_cells; i++) {
+        const cell_t *c = &run->cells[i];
+        fprintf(f, "    {\"n\": %lu, \"sequence\": \"%s\", \"kernel\": \"%s\", "
+                "\"comparisons\": %lu, \"median_ns\": %.1f, \"mad_ns\": %.1f}%s\n",
+                (unsigned long)c->n, c->sequence, c->kernel, (unsigned long)c->comparisons,
+                c->median_ns, c->mad_ns, i + 1 < run->num_cells ? "," : "");
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+
+    if (fclose(f) != 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+static int read_json(const char *path, run_t *run) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    memset(run, 0, sizeof(*run));
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = line + strspn(line, " \t");
+        unsigned long n, comps, seed;
+        cell_t c;
+        if (sscanf(p, "\"cpu\": \"%127[^\"]\"", run->cpu) == 1) continue;
+        if (sscanf(p, "\"seed\": \"0x%lx\"", &seed) == 1) {
+            run->seed = seed;
+            continue;
+        }
+        if (sscanf(p, "\"trials\": %lu", &n) == 1) {
+            run->trials = n;
+            continue;
+        }
+        if (sscanf(p, "{\"n\": %lu, \"sequence\": \"%63[^\"]\", \"kernel\": \"%15[^\"]\", "
+                   "\"comparisons\": %lu, \"median_ns\": %lf, \"mad_ns\": %lf}",
+                   &n, c.sequence, c.kernel, &comps, &c.median_ns, &c.mad_ns) == 6) {
+            if (run->num_cells >= MAX_CELLS) break;
+            c.n = n;
+            c.comparisons = comps;
+            run->cells[run->num_cells++] = c;
+        }
+    }
+    fclose(f);
+
+    if (run->num_cells == 0) {
+        fprintf(stderr, "Error: %s has no regress_bench cells\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static const cell_t *find_cell(const run_t *run, const cell_t *c) {
+    for (size_t i = 0; i < run->num_cells; i++) {
+        const cell_t *b = &run->cells[i];
+        if (b->n == c->n && strcmp(b->sequence, c->sequence) == 0 &&
+            strcmp(b->kernel, c->kernel) == 0) {
+            return b;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    const char *baseline_path = NULL;
+    uint64_t sizes[MAX_SIZES] = {1000, 100000, 1000000};
+    size_t num_sizes = 3;
+    uint64_t trials = DEFAULT_TRIALS;
+    uint64_t seed = DEFAULT_SEED;
+    int threads = 0;
+    double tolerance = DEFAULT_TOLERANCE;
+    double noise_k = DEFAULT_NOISE_K;
+    int check_time = 1;
+    int subset = 0;
+    int cpu = 0;
+    int pin = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 2, sizes, MAX_SIZES, &num_sizes) < 0) {
+                fprintf(stderr, "Error: Invalid sizes list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--trials") == 0 && i + 1 < argc) {
+            trials = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 16);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--time-tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--noise-k") == 0 && i + 1 < argc) {
+            noise_k = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--no-time") == 0) {
+            check_time = 0;
+        } else if (strcmp(argv[i], "--subset") == 0) {
+            subset = 1;
+        } else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-pin") == 0) {
+            pin = 0;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (trials == 0 || tolerance < 0 || noise_k < 0) {
+        fprintf(stderr, "Error: --trials must be positive, tolerances non-negative\n");
+        return 1;
+    }
+#ifdef _OPENMP
+    if (threads <= 0) threads = omp_get_max_threads();
+#else
+    threads = 1;
+#endif
+
+    /*
+     * Pin the measuring thread only. The parallel kernel's team is started
+     * first so its threads keep the full affinity mask instead of
+     * inheriting the pinned one.
+     */
+    #pragma omp parallel num_threads(threads)
+    {
+    }
+    if (pin && timing_pin_cpu(cpu) < 0) {
+        fprintf(stderr, "Error: Could not pin to CPU %d (use --cpu or --no-pin)\n", cpu);
+        return 1;
+    }
+
+    run_t *run = calloc(1, sizeof(run_t));
+    run_t *base = baseline_path ? calloc(1, sizeof(run_t)) : NULL;
+    if (!run || (baseline_path && !base)) {
+        fprintf(stderr, "Error: Out of memory\n");
+        free(run);
+        free(base);
+        return 1;
+    }
+    if (baseline_path && read_json(baseline_path, base) < 0) {
+        free(run);
+        free(base);
+        return 1;
+    }
+
+    timing_cpu_state_t cpu_state;
+    timing_cpu_state(cpu, &cpu_state);
+    snprintf(run->cpu, sizeof(run->cpu), "%s", cpu_state.model);
+    run->seed = seed;
+    run->trials = trials;
+    double tsc_hz = timing_tsc_hz();
+
+    if (base && (base->seed != seed || base->trials != trials)) {
+        fprintf(stderr, "Error: Baseline used seed 0x%lX, %lu trials; rerun with --seed 0x%lX "
+                "--trials %lu\n", (unsigned long)base->seed, (unsigned long)base->trials,
+                (unsigned long)base->seed, (unsigned long)base->trials);
+        free(run);
+        free(base);
+        return 1;
+    }
+    if (base && check_time && strcmp(base->cpu, run->cpu) != 0) {
+        fprintf(stderr, "Warning: Baseline CPU '%s' differs from '%s'; skipping runtime checks\n",
+                base->cpu, run->cpu);
+        check_time = 0;
+    }
+
+    printf("Regression Suite\n");
+    printf("================\n");
+    printf("CPU: %s (governor %s), TSC %.3f GHz\n", run->cpu,
+           cpu_state.governor[0] ? cpu_state.governor : "unknown", tsc_hz / 1e9);
+    printf("Seed 0x%lX, %lu trials, parallel kernel on %d threads\n", (unsigned long)seed,
+           (unsigned long)trials, threads);
+    if (base) {
+        printf("Baseline: %s (%zu cells), time tolerance %.0f%% or %.1f MADs%s\n",
+               baseline_path, base->num_cells, tolerance * 100.0, noise_k,
+               check_time ? "" : " (runtime not checked)");
+    }
+    printf("\n");
+    printf("%-9s %-16s %-9s | %14s | %12s | %10s | %s\n", "N", "Sequence", "Kernel",
+           "comparisons", "median us", "vs base", "status");
+    printf("--------------------------------------|----------------|--------------|"
+           "------------|-------\n");
+
+    int failures = 0;
+    double ns_per_tick = 1e9 / tsc_hz;
+
+    for (size_t s = 0; s < num_sizes && failures >= 0; s++) {
+        uint64_t N = sizes[s];
+        perm_dataset_t ds;
+        dataset_generate(&ds, N, trials, seed, ELEM_I32, RNG_SCHEME_V1);
+
+        int32_t *src = malloc(N * sizeof(int32_t));
+        int32_t *arr = malloc(N * sizeof(int32_t));
+        double *samples = malloc(trials * sizeof(double));
+        if (!src || !arr || !samples) {
+            fprintf(stderr, "Error: Out of memory at N=%lu\n", (unsigned long)N);
+            free(src);
+            free(arr);
+            free(samples);
+            failures = -1;
+            break;
+        }
+
+        gap_sequence_t seqs[NUM_SEQS];
+        gaps_all_baselines(seqs, N);
+        gaps_evolved(&seqs[NUM_BASELINES], N);
+
+        for (int q = 0; q < NUM_SEQS && failures >= 0; q++) {
+            uint64_t counted = 0;
+            for (int k = 0; k < NUM_KERNELS; k++) {
+                cell_t *c = &run->cells[run->num_cells];
+                if (run_cell(&ds, (regress_kernel_t)k, &seqs[q], threads, ns_per_tick, src, arr,
+                             samples, c) < 0) {
+                    failures = -1;
+                    break;
+                }
+                run->num_cells++;
+
+                const char *status = "ok";
+                char versus[32] = "-";
+                if (k == RK_COUNTING) {
+                    counted = c->comparisons;
+                } else if (k != RK_FAST && c->comparisons != counted) {
+                    status = "COUNT MISMATCH (vs counting)";
+                    failures++;
+                }
+
+                const cell_t *b = base ? find_cell(base, c) : NULL;
+                if (base && !b) {
+                    status = "new";
+                } else if (b && k != RK_FAST && b->comparisons != c->comparisons) {
+                    status = "COUNT MISMATCH (vs baseline)";
+                    failures++;
+                } else if (b && b->median_ns > 0) {
+                    snprintf(versus, sizeof(versus), "%+.1f%%",
+                             (c->median_ns / b->median_ns - 1.0) * 100.0);
+                    double noise = fmax(b->mad_ns, c->mad_ns) * noise_k;
+                    double allowed = fmax(tolerance * b->median_ns, noise);
+                    if (check_time && c->median_ns > b->median_ns + allowed &&
+                        strcmp(status, "ok") == 0) {
+                        status = "SLOWER";
+                        failures++;
+                    }
+                }
+
+                char comps[24] = "-";
+                if (k != RK_FAST) snprintf(comps, sizeof(comps), "%lu", (unsigned long)c->comparisons);
+                printf("%-9lu %-16s %-9s | %14s | %12.1f | %10s | %s\n", (unsigned long)N,
+                       c->sequence, c->kernel, comps, c->median_ns / 1e3, versus, status);
+                fflush(stdout);
+            }
+        }
+
+        free(src);
+        free(arr);
+        free(samples);
+        free_dataset(&ds);
+    }
+
+    if (failures >= 0 && base) {
+        size_t missing = 0;
+        for (size_t i = 0; i < base->num_cells; i++) {
+            if (!find_cell(run, &base->cells[i])) {
+                fprintf(stderr, "%s: Baseline cell N=%lu %s/%s was not run\n",
+                        subset ? "Warning" : "Error", (unsigned long)base->cells[i].n,
+                        base->cells[i].sequence, base->cells[i].kernel);
+                missing++;
+            }
+        }
+        if (missing > 0 && !subset) {
+            fprintf(stderr, "Error: %zu baseline cell%s missing (use --subset for a partial run)\n",
+                    missing, missing == 1 ? "" : "s");
+            failures += (int)missing;
+        }
+    }
+
+    int rc = 0;
+    if (failures < 0) {
+        rc = 1;
+    } else {
+        if (out_path && write_json(out_path, run, tsc_hz) < 0) rc = 1;
+        if (failures > 0) {
+            printf("\nFAIL: %d regression%s\n", failures, failures == 1 ? "" : "s");
+            rc = 1;
+        } else {
+            printf("\nPASS: %zu cells%s\n", run->num_cells, base ? " match the baseline" : "");
+        }
+    }
+
+    free(run);
+    free(base);
+    return rc;
+}
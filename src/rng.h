@@ -3,12 +3,22 @@
  *
  * Uses splitmix64 for seeding and xoshiro256** for generation.
  * All state is explicit - no global state.
+ *
+ * Two seed schemes are defined. RNG_SCHEME_V1 (rng_uniform, rng_shuffle,
+ * rng_permutation) is the reference that produced every PERMGEN1 dataset
+ * and must not change. RNG_SCHEME_V2 is an opt-in, faster stream: batched
+ * xoshiro256** lanes, Lemire multiply-shift bounds and a bucketed shuffle.
+ * It yields different (equally uniform) permutations for the same seed.
  */
 
 #ifndef RNG_H
 #define RNG_H
 
 #include <stdint.h>
+#include <string.h>
+
+#define RNG_SCHEME_V1 1  /* rng_permutation(): the on-disk reference */
+#define RNG_SCHEME_V2 2  /* rng_permutation_v2(): batched, Lemire, bucketed */
 
 /* splitmix64 - used for seeding xoshiro from a single 64-bit seed */
 static inline uint64_t splitmix64(uint64_t *state) {
@@ -81,4 +91,205 @@ static inline uint64_t derive_seed(uint64_t master_seed, uint64_t n, uint64_t tr
     return splitmix64(&state);
 }
 
+/*
+ * Trial `trial` of size n for master_seed: identity fill, then a shuffle
+ * seeded with derive_seed(). This is exactly what permgen writes to disk.
+ */
+static inline void rng_permutation(int32_t *arr, uint64_t n, uint64_t master_seed,
+                                   uint64_t trial) {
+    for (uint64_t i = 0; i < n; i++) {
+        arr[i] = (int32_t)i;
+    }
+
+    rng_state_t rng;
+    rng_seed(&rng, derive_seed(master_seed, n, trial));
+    rng_shuffle(&rng, arr, n);
+}
+
+/* ---- RNG_SCHEME_V2 ------------------------------------------------------ */
+
+/*
+ * Bounded random in [0, n) by Lemire's multiply-shift: one 64x64->128
+ * multiply, and the 2^64 mod n division only on the rare rejection path.
+ * Falls back to rng_uniform() without 128-bit integers.
+ */
+static inline uint64_t rng_uniform_lemire(rng_state_t *rng, uint64_t n) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t m = (__uint128_t)rng_next(rng) * n;
+    uint64_t l = (uint64_t)m;
+    if (l < n) {
+        uint64_t threshold = -n % n;
+        while (l < threshold) {
+            m = (__uint128_t)rng_next(rng) * n;
+            l = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+#else
+    return rng_uniform(rng, n);
+#endif
+}
+
+#define RNG_LANES 4                      /* Independent xoshiro256** streams */
+#define RNG_BATCH (RNG_LANES * 4)        /* Outputs buffered per refill */
+
+/*
+ * RNG_LANES xoshiro256** generators in struct-of-arrays form. One step
+ * advances all lanes with the same shifts and xors, which the compiler
+ * turns into vector code; outputs are consumed lane-interleaved from buf.
+ */
+typedef struct {
+    uint64_t s[4][RNG_LANES];
+    uint64_t buf[RNG_BATCH];
+    unsigned pos;
+} rng_batch_t;
+
+static inline void rng_batch_seed(rng_batch_t *rng, uint64_t seed) {
+    for (int l = 0; l < RNG_LANES; l++) {
+        for (int k = 0; k < 4; k++) {
+            rng->s[k][l] = splitmix64(&seed);
+        }
+    }
+    rng->pos = RNG_BATCH;
+}
+
+static inline void rng_batch_refill(rng_batch_t *rng) {
+    for (int step = 0; step < RNG_BATCH / RNG_LANES; step++) {
+        for (int l = 0; l < RNG_LANES; l++) {
+            uint64_t s1 = rng->s[1][l];
+            uint64_t res = s1 * 5;
+            res = ((res << 7) | (res >> 57)) * 9;
+            uint64_t t = s1 << 17;
+
+            rng->s[2][l] ^= rng->s[0][l];
+            rng->s[3][l] ^= s1;
+            rng->s[1][l] = s1 ^ rng->s[2][l];
+            rng->s[0][l] ^= rng->s[3][l];
+            rng->s[2][l] ^= t;
+            rng->s[3][l] = (rng->s[3][l] << 45) | (rng->s[3][l] >> 19);
+
+            rng->buf[step * RNG_LANES + l] = res;
+        }
+    }
+    rng->pos = 0;
+}
+
+static inline uint64_t rng_batch_next(rng_batch_t *rng) {
+    if (rng->pos == RNG_BATCH) rng_batch_refill(rng);
+    return rng->buf[rng->pos++];
+}
+
+/* rng_uniform_lemire() over the batched stream */
+static inline uint64_t rng_batch_uniform(rng_batch_t *rng, uint64_t n) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t m = (__uint128_t)rng_batch_next(rng) * n;
+    uint64_t l = (uint64_t)m;
+    if (l < n) {
+        uint64_t threshold = -n % n;
+        while (l < threshold) {
+            m = (__uint128_t)rng_batch_next(rng) * n;
+            l = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+#else
+    uint64_t threshold = -n % n;
+    for (;;) {
+        uint64_t r = rng_batch_next(rng);
+        if (r >= threshold) return r % n;
+    }
+#endif
+}
+
+/* Fisher-Yates over the batched stream with Lemire bounds */
+static inline void rng_batch_shuffle(rng_batch_t *rng, int32_t *arr, uint64_t n) {
+    for (uint64_t i = n; i > 1; i--) {
+        uint64_t j = rng_batch_uniform(rng, i);
+        int32_t tmp = arr[i - 1];
+        arr[i - 1] = arr[j];
+        arr[j] = tmp;
+    }
+}
+
+/* Elements per bucket the v2 shuffle aims for (64 KiB of int32) */
+#define RNG_BUCKET_ELEMS 16384
+#define RNG_MAX_BUCKET_BITS 12
+
+/*
+ * Uniform random permutation of 0..n-1 (Rao-Sandelius): every element gets
+ * an independent uniform bucket, buckets are laid out in order, and each
+ * bucket is Fisher-Yates shuffled on its own. A plain Fisher-Yates over
+ * 8M elements swaps with a random position each step and misses cache on
+ * nearly every one; here the scatter writes a few hundred sequential
+ * streams and each bucket shuffle stays inside L2.
+ *
+ * The input is the identity, so labels are drawn twice from the same
+ * stream (once to count, once to scatter) instead of being stored.
+ */
+static inline void rng_bucket_permutation(rng_batch_t *rng, int32_t *arr, uint64_t n) {
+    int bits = 0;
+    while (bits < RNG_MAX_BUCKET_BITS && ((uint64_t)RNG_BUCKET_ELEMS << bits) < n) bits++;
+
+    if (bits == 0) {
+        for (uint64_t i = 0; i < n; i++) arr[i] = (int32_t)i;
+        rng_batch_shuffle(rng, arr, n);
+        return;
+    }
+
+    uint64_t start[1u << RNG_MAX_BUCKET_BITS];
+    size_t buckets = (size_t)1 << bits;
+    memset(start, 0, buckets * sizeof(start[0]));
+
+    /* Pass 1: bucket sizes */
+    rng_batch_t replay = *rng;
+    for (uint64_t i = 0; i < n; i++) {
+        start[rng_batch_next(rng) >> (64 - bits)]++;
+    }
+
+    /* Exclusive prefix sum: start[b] = first slot of bucket b */
+    uint64_t sum = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        uint64_t c = start[b];
+        start[b] = sum;
+        sum += c;
+    }
+
+    /* Pass 2: same labels again, scatter the identity into place */
+    for (uint64_t i = 0; i < n; i++) {
+        arr[start[rng_batch_next(&replay) >> (64 - bits)]++] = (int32_t)i;
+    }
+
+    /* start[b] is now the end of bucket b; shuffle each bucket in cache */
+    uint64_t begin = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        rng_batch_shuffle(rng, arr + begin, start[b] - begin);
+        begin = start[b];
+    }
+}
+
+/* RNG_SCHEME_V2 trial `trial` of size n for master_seed */
+static inline void rng_permutation_v2(int32_t *arr, uint64_t n, uint64_t master_seed,
+                                      uint64_t trial) {
+    rng_batch_t rng;
+    rng_batch_seed(&rng, derive_seed(master_seed, n, trial));
+    rng_bucket_permutation(&rng, arr, n);
+}
+
+/* Trial `trial` under the given scheme (anything but V2 means V1) */
+static inline void rng_permutation_scheme(int32_t *arr, uint64_t n, uint64_t master_seed,
+                                          uint64_t trial, int scheme) {
+    if (scheme == RNG_SCHEME_V2) {
+        rng_permutation_v2(arr, n, master_seed, trial);
+    } else {
+        rng_permutation(arr, n, master_seed, trial);
+    }
+}
+
+/* "v1" / "v2" to RNG_SCHEME_*; returns -1 if unknown */
+static inline int rng_scheme_parse(const char *name) {
+    if (strcmp(name, "v1") == 0) return RNG_SCHEME_V1;
+    if (strcmp(name, "v2") == 0) return RNG_SCHEME_V2;
+    return -1;
+}
+
 #endif /* RNG_H */
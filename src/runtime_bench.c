@@ -0,0 +1,456 @@
+#define _GNU_SOURCE
+/*
+ * runtime_bench.c - Paired, pinned, cycle-timed runtime comparison of two sequences
+ *
+ * Usage: ./runtime_bench [perms_dir] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                        [--sizes n1,n2,...] [--kernel counting|fast|simd|parallel]
+ *                        [--threads T] [--cpus c1,c2,...] [--no-pin] [--warmup W] [--reps R]
+ *                        [--baseline <name>] [--candidate <name>] [--resamples B]
+ *                        [--seed <hex>] [--csv <file>]
+ *
+ * bench reports throughput: every thread sorts at once and each sort is
+ * timed with wall-clock time while the others load memory. This tool is
+ * for runtime claims instead:
+ *
+ *   - each measuring thread is pinned to its own CPU (--cpus, default
+ *     0..T-1) before its scratch buffers are touched;
+ *   - every thread first runs W untimed sorts of both sequences;
+ *   - each sort is timed in TSC cycles (timing.h) around the kernel only,
+ *     after the trial has been copied into the work buffer, and a trial's
+ *     sample is the fastest of R repetitions;
+ *   - baseline and candidate sort the same trial back to back, in
+ *     alternating order, so drift and cache state hit both alike;
+ *   - results are medians with MAD and a bootstrap 95% CI, plus a paired
+ *     t-test (paired_test_f64()) and the median per-trial ratio;
+ *   - the verdict needs both tests to agree: the bootstrap CI of the
+ *     median ratio (robust to outlier trials) and the t-test on the mean
+ *     difference (p < 0.05). When one is significant and the other is not,
+ *     the result is reported as inconclusive;
+ *   - the CPU model, governor, frequency limits and turbo state are
+ *     printed with the results, with a warning when they make cycle counts
+ *     unreliable (governor other than performance, turbo on).
+ *
+ * The default is one thread on an otherwise idle machine. --threads T > 1
+ * measures under load, T trials at a time; --kernel parallel instead
+ * times one sort at a time split across the T pinned threads.
+ *
+ * Every sorted trial is checked; --csv writes the per-trial cycles.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "shellsort.h"
+#include "gaps_baselines.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "stats.h"
+#include "timing.h"
+#include "cli.h"
+
+#define MAX_SIZES 16
+#define MAX_CPUS 256
+#define DEFAULT_WARMUP 3
+#define DEFAULT_REPS 3
+#define DEFAULT_RESAMPLES 2000
+#define DEFAULT_SEED 0xB0075EEDULL
+
+typedef enum {
+    RT_COUNTING = 0,
+    RT_FAST,
+    RT_SIMD,
+    RT_PARALLEL
+} rt_kernel_t;
+
+static const char *kernel_names[] = {"counting", "fast", "simd", "parallel"};
+
+/* Direction a test points to (-1 faster, 0 no difference, 1 slower) + 1 */
+static const char *verdict_names[] = {"faster", "no difference", "slower"};
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [perms_dir] [--generate-seed <hex> [--trials T]] [--sizes n1,...]\n"
+                    "       [--kernel counting|fast|simd|parallel] [--threads T] [--cpus c1,...]\n"
+                    "       [--no-pin] [--warmup W] [--reps R] [--baseline <name>]\n"
+                    "       [--candidate <name>] [--resamples B] [--seed <hex>] [--csv <file>]\n",
+            prog);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --sizes <list>    Sizes to time (default: 1000000)\n");
+    fprintf(stderr, "  --kernel <name>   Kernel to time (default: fast)\n");
+    fprintf(stderr, "  --threads T       Measuring threads, or sort threads for parallel (default: 1)\n");
+    fprintf(stderr, "  --cpus <list>     CPUs to pin the threads to (default: 0..T-1)\n");
+    fprintf(stderr, "  --no-pin          Leave threads unpinned\n");
+    fprintf(stderr, "  --warmup W        Untimed sorts of each sequence per thread (default: %d)\n",
+            DEFAULT_WARMUP);
+    fprintf(stderr, "  --reps R          Timed repetitions per trial, fastest kept (default: %d)\n",
+            DEFAULT_REPS);
+    fprintf(stderr, "  --baseline <name> Reference sequence (default: Ciura)\n");
+    fprintf(stderr, "  --candidate <name> Sequence under test (default: Evolved)\n");
+    fprintf(stderr, "                    Names: Ciura, Ciura-Extended, Tokuda, Lee-2021,\n");
+    fprintf(stderr, "                    Skean-2023, Sedgewick-1986, Evolved\n");
+    fprintf(stderr, "  --resamples B     Bootstrap resamples (default: %d)\n", DEFAULT_RESAMPLES);
+    fprintf(stderr, "  --seed <hex>      Bootstrap seed (default: 0x%llX)\n",
+            (unsigned long long)DEFAULT_SEED);
+    fprintf(stderr, "  --csv <file>      Write per-trial cycles (N, trial, baseline, candidate)\n");
+}
+
+/* Baseline or Evolved sequence by name (case-insensitive); -1 if unknown */
+static int sequence_by_name(const char *name, uint64_t N, gap_sequence_t *seq) {
+    gap_sequence_t all[NUM_BASELINES + 1];
+    gaps_all_baselines(all, N);
+    gaps_evolved(&all[NUM_BASELINES], N);
+    for (int i = 0; i <= NUM_BASELINES; i++) {
+        if (strcasecmp(all[i].name, name) == 0) {
+            *seq = all[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void sort_once(rt_kernel_t kernel, int32_t *arr, size_t n, const gap_sequence_t *seq,
+                      int threads) {
+    switch (kernel) {
+        case RT_COUNTING: shellsort_stats(arr, n, seq); break;
+        case RT_FAST:     shellsort_fast(arr, n, seq); break;
+        case RT_SIMD:     shellsort_simd(arr, n, seq); break;
+        case RT_PARALLEL: shellsort_parallel(arr, n, seq, threads); break;
+    }
+}
+
+/* Fastest of reps timed sorts of src, in cycles; 0 if a result was not sorted */
+static uint64_t time_sort(rt_kernel_t kernel, const int32_t *src, int32_t *arr, size_t n,
+                          const gap_sequence_t *seq, int reps, int threads) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < reps; r++) {
+        memcpy(arr, src, n * sizeof(int32_t));
+        uint64_t c0 = timing_begin();
+        sort_once(kernel, arr, n, seq, threads);
+        uint64_t c1 = timing_end();
+        if (c1 - c0 < best) best = c1 - c0;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i - 1] > arr[i]) return 0;
+    }
+    return best;
+}
+
+typedef struct {
+    double median, mad, lo, hi;
+} robust_t;
+
+static int summarize(const double *x, uint64_t n, uint64_t resamples, uint64_t seed,
+                     robust_t *r) {
+    if (stats_median(x, n, &r->median) < 0 || stats_mad(x, n, &r->mad) < 0 ||
+        stats_bootstrap_median_ci(x, n, resamples, seed, &r->lo, &r->hi) < 0) {
+        fprintf(stderr, "Error: Out of memory for statistics\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void print_cpu_state(const timing_cpu_state_t *st, int cpu) {
+    printf("CPU %d: %s\n", cpu, st->model);
+    printf("  governor %s, driver %s, turbo %s\n", st->governor[0] ? st->governor : "unknown",
+           st->driver[0] ? st->driver : "unknown",
+           st->turbo < 0 ? "unknown" : (st->turbo ? "on" : "off"));
+    if (st->cur_mhz > 0) {
+        printf("  frequency %.0f MHz (limits %.0f-%.0f MHz)\n", st->cur_mhz, st->min_mhz,
+               st->max_mhz);
+    } else {
+        printf("  frequency unknown (no cpufreq)\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *perms_dir = "results/perms";
+    uint64_t sizes[MAX_SIZES] = {1000000};
+    size_t num_sizes = 1;
+    rt_kernel_t kernel = RT_FAST;
+    int threads = 1;
+    uint64_t cpus_list[MAX_CPUS];
+    size_t num_cpus = 0;
+    int pin = 1;
+    int warmup = DEFAULT_WARMUP;
+    int reps = DEFAULT_REPS;
+    const char *baseline_name = "Ciura";
+    const char *candidate_name = "Evolved";
+    uint64_t resamples = DEFAULT_RESAMPLES;
+    uint64_t seed = DEFAULT_SEED;
+    const char *csv_path = NULL;
+
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+
+    int npos = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 2, sizes, MAX_SIZES, &num_sizes) < 0) {
+                fprintf(stderr, "Error: Invalid sizes list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc) {
+            const char *k = argv[++i];
+            if (strcmp(k, "counting") == 0) kernel = RT_COUNTING;
+            else if (strcmp(k, "fast") == 0) kernel = RT_FAST;
+            else if (strcmp(k, "simd") == 0) kernel = RT_SIMD;
+            else if (strcmp(k, "parallel") == 0) kernel = RT_PARALLEL;
+            else {
+                fprintf(stderr, "Error: Unknown kernel '%s'\n", k);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+            if (parse_uint64_list(argv[++i], 0, cpus_list, MAX_CPUS, &num_cpus) < 0) {
+                fprintf(stderr, "Error: Invalid CPU list\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-pin") == 0) {
+            pin = 0;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_name = argv[++i];
+        } else if (strcmp(argv[i], "--candidate") == 0 && i + 1 < argc) {
+            candidate_name = argv[++i];
+        } else if (strcmp(argv[i], "--resamples") == 0 && i + 1 < argc) {
+            resamples = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 16);
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            argv[npos++] = argv[i];
+        }
+    }
+    argc = npos;
+    if (argc > 1) perms_dir = argv[1];
+    source.perms_dir = perms_dir;
+
+    if (threads < 1 || threads > MAX_CPUS || warmup < 0 || reps < 1 || resamples == 0) {
+        fprintf(stderr, "Error: --threads must be 1..%d, --reps and --resamples positive\n",
+                MAX_CPUS);
+        return 1;
+    }
+    if (num_cpus > 0 && num_cpus < (size_t)threads) {
+        fprintf(stderr, "Error: --cpus lists %zu CPUs for %d threads\n", num_cpus, threads);
+        return 1;
+    }
+    if (num_cpus == 0) {
+        for (int k = 0; k < threads; k++) cpus_list[k] = (uint64_t)k;
+    }
+
+    /* Measuring threads, and the team each parallel sort uses */
+    int team = threads;
+    int sort_threads = kernel == RT_PARALLEL ? threads : 1;
+    int measure_threads = kernel == RT_PARALLEL ? 1 : threads;
+
+    /* Pin the OpenMP team once; libgomp reuses the same threads for later regions */
+    int pin_failed = 0;
+    if (pin) {
+        #pragma omp parallel num_threads(team) reduction(+:pin_failed)
+        {
+            int k = 0;
+#ifdef _OPENMP
+            k = omp_get_thread_num();
+#endif
+            if (timing_pin_cpu((int)cpus_list[k]) < 0) pin_failed++;
+        }
+        if (pin_failed) {
+            fprintf(stderr, "Error: Could not pin %d of %d threads (check --cpus)\n",
+                    pin_failed, team);
+            return 1;
+        }
+    }
+
+    gap_sequence_t probe;
+    if (sequence_by_name(baseline_name, 1000, &probe) < 0 ||
+        sequence_by_name(candidate_name, 1000, &probe) < 0) {
+        fprintf(stderr, "Error: Unknown sequence (see --help for names)\n");
+        return 1;
+    }
+
+    FILE *csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(csv, "N,trial,baseline_cycles,candidate_cycles\n");
+    }
+
+    timing_cpu_state_t cpu_state;
+    timing_cpu_state((int)cpus_list[0], &cpu_state);
+    double hz = timing_tsc_hz();
+
+    printf("Runtime Benchmark\n");
+    printf("=================\n");
+    print_cpu_state(&cpu_state, (int)cpus_list[0]);
+    printf("TSC: %.3f GHz\n", hz / 1e9);
+    printf("Kernel: %s, %d measuring thread%s x %d sort thread%s, %s\n", kernel_names[kernel],
+           measure_threads, measure_threads == 1 ? "" : "s", sort_threads,
+           sort_threads == 1 ? "" : "s", pin ? "pinned" : "unpinned");
+    printf("Warmup %d, fastest of %d reps per trial, %lu bootstrap resamples\n\n", warmup, reps,
+           (unsigned long)resamples);
+
+    if (cpu_state.governor[0] && strcmp(cpu_state.governor, "performance") != 0) {
+        fprintf(stderr, "Warning: governor is '%s'; cycle counts may include frequency "
+                "ramps (set 'performance')\n", cpu_state.governor);
+    }
+    if (cpu_state.turbo == 1) {
+        fprintf(stderr, "Warning: turbo is on; TSC cycles and core cycles differ and vary "
+                "with load and temperature\n");
+    }
+    if (!pin) fprintf(stderr, "Warning: threads are not pinned\n");
+
+    int status = 0;
+    for (size_t s = 0; s < num_sizes && status == 0; s++) {
+        uint64_t N = sizes[s];
+        gap_sequence_t seqs[2];
+        sequence_by_name(baseline_name, N, &seqs[0]);
+        sequence_by_name(candidate_name, N, &seqs[1]);
+
+        perm_dataset_t ds;
+        if (dataset_open(&source, N, ELEM_I32, &ds) < 0) {
+            printf("Failed to load N=%lu\n", (unsigned long)N);
+            status = 1;
+            break;
+        }
+        uint64_t trials = ds.trials;
+
+        /* Per thread: N elements to sort, then the trial as loaded */
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, team, 2 * N * sizeof(int32_t)) < 0) {
+            free_dataset(&ds);
+            status = 1;
+            break;
+        }
+
+        double *cycles = malloc(2 * (trials ? trials : 1) * sizeof(double));
+        double *ratios = malloc((trials ? trials : 1) * sizeof(double));
+        if (!cycles || !ratios) {
+            fprintf(stderr, "Error: Out of memory at N=%lu\n", (unsigned long)N);
+            free(cycles);
+            free(ratios);
+            scratch_pool_free(&scratch);
+            free_dataset(&ds);
+            status = 1;
+            break;
+        }
+        double *base = cycles, *cand = cycles + trials;
+        int unsorted = 0;
+
+        #pragma omp parallel num_threads(measure_threads) reduction(+:unsorted)
+        {
+            int32_t *arr = scratch_get(&scratch);
+            int32_t *src = arr + N;
+
+            dataset_copy_trial(&ds, 0, src);
+            for (int w = 0; w < warmup; w++) {
+                for (int q = 0; q < 2; q++) {
+                    memcpy(arr, src, N * sizeof(int32_t));
+                    sort_once(kernel, arr, N, &seqs[q], sort_threads);
+                }
+            }
+
+            #pragma omp for schedule(static)
+            for (uint64_t t = 0; t < trials; t++) {
+                dataset_copy_trial(&ds, t, src);
+                uint64_t c[2];
+                /* Alternate which sequence goes first */
+                for (int q = 0; q < 2; q++) {
+                    int which = (t & 1) ? 1 - q : q;
+                    c[which] = time_sort(kernel, src, arr, N, &seqs[which], reps, sort_threads);
+                }
+                if (c[0] == 0 || c[1] == 0) unsorted++;
+                base[t] = (double)c[0];
+                cand[t] = (double)c[1];
+            }
+        }
+        if (unsorted) {
+            fprintf(stderr, "Error: %d trials at N=%lu were not sorted\n", unsorted,
+                    (unsigned long)N);
+            status = 1;
+        }
+
+        robust_t rb, rc, rr;
+        for (uint64_t t = 0; t < trials; t++) ratios[t] = cand[t] / base[t];
+        if (status == 0 &&
+            (summarize(base, trials, resamples, seed, &rb) < 0 ||
+             summarize(cand, trials, resamples, seed + 1, &rc) < 0 ||
+             summarize(ratios, trials, resamples, seed + 2, &rr) < 0)) {
+            status = 1;
+        }
+
+        if (status == 0) {
+            paired_result_t pt = paired_test_f64(cand, base, trials);
+            double ns_per_cycle = 1e9 / hz;
+
+            printf("N = %lu (%lu trials)\n", (unsigned long)N, (unsigned long)trials);
+            printf("%-16s | %14s | %10s | %29s | %8s\n", "Sequence", "median cycles", "MAD",
+                   "95% CI of median", "ns/elem");
+            printf("-----------------|----------------|------------|"
+                   "-------------------------------|---------\n");
+            const robust_t *rs[2] = {&rb, &rc};
+            for (int q = 0; q < 2; q++) {
+                printf("%-16s | %14.0f | %10.0f | [%13.0f, %13.0f] | %8.3f\n", seqs[q].name,
+                       rs[q]->median, rs[q]->mad, rs[q]->lo, rs[q]->hi,
+                       rs[q]->median * ns_per_cycle / (double)N);
+            }
+            printf("%s / %s: median ratio %.4f [%.4f, %.4f], mean diff %+.0f cycles, "
+                   "t = %.2f, p = %.2e\n", seqs[1].name, seqs[0].name, rr.median, rr.lo, rr.hi,
+                   pt.mean_diff, pt.t_stat, pt.p_value);
+            int by_ci = rr.hi < 1.0 ? -1 : rr.lo > 1.0 ? 1 : 0;
+            int by_t = pt.p_value < 0.05 ? (pt.mean_diff < 0 ? -1 : 1) : 0;
+            if (by_ci != by_t) {
+                printf("  -> inconclusive: ratio CI says %s, paired t-test says %s\n",
+                       verdict_names[by_ci + 1], verdict_names[by_t + 1]);
+            } else if (by_ci < 0) {
+                printf("  -> %s is faster (ratio CI below 1, t-test p < 0.05)\n", seqs[1].name);
+            } else if (by_ci > 0) {
+                printf("  -> %s is slower (ratio CI above 1, t-test p < 0.05)\n", seqs[1].name);
+            } else {
+                printf("  -> no significant runtime difference (ratio CI contains 1, t-test p >= 0.05)\n");
+            }
+
+            timing_cpu_state_t after;
+            timing_cpu_state((int)cpus_list[0], &after);
+            if (after.cur_mhz > 0) printf("  frequency after: %.0f MHz\n", after.cur_mhz);
+            printf("\n");
+
+            if (csv) {
+                for (uint64_t t = 0; t < trials; t++) {
+                    fprintf(csv, "%lu,%lu,%.0f,%.0f\n", (unsigned long)N, (unsigned long)t,
+                            base[t], cand[t]);
+                }
+            }
+        }
+
+        free(cycles);
+        free(ratios);
+        scratch_pool_free(&scratch);
+        free_dataset(&ds);
+    }
+
+    if (csv) fclose(csv);
+    return status;
+}
@@ -0,0 +1,76 @@
+#define _GNU_SOURCE
+/*
+ * scratch.c - Per-thread, first-touch scratch buffers
+ */
+
+#include "scratch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+int scratch_pool_init(scratch_pool_t *pool, int num_threads, size_t bytes) {
+    memset(pool, 0, sizeof(*pool));
+    if (num_threads < 1) num_threads = 1;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_len = (bytes + page - 1) / page * page;
+    if (map_len == 0) map_len = page;
+
+    pool->bufs = calloc((size_t)num_threads, sizeof(void *));
+    if (!pool->bufs) {
+        fprintf(stderr, "Error: Failed to allocate scratch pool\n");
+        return -1;
+    }
+    pool->num_threads = num_threads;
+    pool->bytes = bytes;
+    pool->map_len = map_len;
+
+    int err = 0;    /* errno of a failed mmap; set by the worker that saw it */
+
+    /*
+     * Thread i maps and touches buffer i (first-touch placement). The loop
+     * form still fills every slot if the runtime grants fewer threads.
+     */
+    #pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+    for (int i = 0; i < num_threads; i++) {
+        void *buf = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED) {
+            #pragma omp atomic write
+            err = errno;
+            continue;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(buf, map_len, MADV_HUGEPAGE);
+#endif
+        /* Pre-fault every page */
+        for (size_t off = 0; off < map_len; off += page) {
+            ((volatile char *)buf)[off] = 0;
+        }
+        pool->bufs[i] = buf;
+    }
+
+    if (err) {
+        fprintf(stderr, "Error: Failed to map %zu-byte scratch buffers: %s\n",
+                map_len, strerror(err));
+        scratch_pool_free(pool);
+        return -1;
+    }
+
+    return 0;
+}
+
+void scratch_pool_free(scratch_pool_t *pool) {
+    if (pool->bufs) {
+        for (int i = 0; i < pool->num_threads; i++) {
+            if (pool->bufs[i]) munmap(pool->bufs[i], pool->map_len);
+        }
+        free(pool->bufs);
+    }
+    pool->bufs = NULL;
+    pool->num_threads = 0;
+}
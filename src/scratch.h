@@ -0,0 +1,46 @@
+/*
+ * scratch.h - Per-thread scratch buffers for the trial loops
+ *
+ * Each OpenMP thread gets one page-aligned buffer, allocated and pre-faulted
+ * by that thread so first-touch places its pages on the thread's NUMA node
+ * (when threads are pinned, e.g. OMP_PROC_BIND=close). Buffers are reused
+ * across trials, which keeps allocation and page faults out of the loop.
+ */
+
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <stddef.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct {
+    int num_threads;
+    size_t bytes;            /* Usable size of each buffer */
+    size_t map_len;          /* Size rounded up to whole pages */
+    void **bufs;             /* One buffer per thread */
+} scratch_pool_t;
+
+/*
+ * Allocate num_threads buffers of at least `bytes` each.
+ * Must be called outside a parallel region.
+ *
+ * Returns 0 on success, -1 on error (message printed to stderr).
+ */
+int scratch_pool_init(scratch_pool_t *pool, int num_threads, size_t bytes);
+
+/* Release all buffers. Safe to call twice. */
+void scratch_pool_free(scratch_pool_t *pool);
+
+/* Buffer owned by the calling thread (call inside the trial loop) */
+static inline void *scratch_get(const scratch_pool_t *pool) {
+#ifdef _OPENMP
+    return pool->bufs[omp_get_thread_num()];
+#else
+    return pool->bufs[0];
+#endif
+}
+
+#endif /* SCRATCH_H */
@@ -3,11 +3,13 @@
  */
 
 #include "shellsort.h"
+#include "shellsort_internal.h"
 #include <stdio.h>
 #include <string.h>
 
 uint64_t shellsort(int32_t *arr, size_t n, const gap_sequence_t *seq) {
-    uint64_t comparisons = 0;
+    /* Local counters: the unused move count is optimized away */
+    sort_stats_t stats = {0, 0};
 
     /* Apply gaps in descending order (seq stores them ascending) */
     for (size_t g = seq->num_gaps; g > 0; g--) {
@@ -16,30 +18,13 @@ uint64_t shellsort(int32_t *arr, size_t n, const gap_sequence_t *seq) {
         /* Skip gaps >= n */
         if (gap >= n) continue;
 
-        /* Gapped insertion sort */
+        /* Gapped insertion sort (counting rule: shellsort_internal.h) */
         for (size_t i = gap; i < n; i++) {
-            int32_t temp = arr[i];
-            size_t j = i;
-
-            /*
-             * Inner loop: count comparison each time we evaluate arr[j-gap] > temp
-             * Per CLAUDE.md 3.2: count ONE comparison per evaluation of the
-             * data comparison, regardless of outcome.
-             */
-            while (j >= gap) {
-                comparisons++;  /* Count this comparison */
-                if (arr[j - gap] > temp) {
-                    arr[j] = arr[j - gap];
-                    j -= gap;
-                } else {
-                    break;
-                }
-            }
-            arr[j] = temp;
+            shellsort_insert_counted(arr, i, gap, &stats);
         }
     }
 
-    return comparisons;
+    return stats.comparisons;
 }
 
 sort_stats_t shellsort_stats(int32_t *arr, size_t n, const gap_sequence_t *seq) {
@@ -52,29 +37,88 @@ sort_stats_t shellsort_stats(int32_t *arr, size_t n, const gap_sequence_t *seq)
         /* Skip gaps >= n */
         if (gap >= n) continue;
 
-        /* Gapped insertion sort */
+        /* Gapped insertion sort (counting rule: shellsort_internal.h) */
         for (size_t i = gap; i < n; i++) {
-            int32_t temp = arr[i];
-            size_t j = i;
-
-            while (j >= gap) {
-                stats.comparisons++;  /* Count comparison */
-                if (arr[j - gap] > temp) {
-                    arr[j] = arr[j - gap];
-                    stats.moves++;    /* Count shift */
-                    j -= gap;
-                } else {
-                    break;
-                }
-            }
-            arr[j] = temp;
-            stats.moves++;  /* Count final placement */
+            shellsort_insert_counted(arr, i, gap, &stats);
         }
     }
 
     return stats;
 }
 
+size_t shellsort_num_passes(size_t n, const gap_sequence_t *seq) {
+    size_t passes = 0;
+    for (size_t g = 0; g < seq->num_gaps; g++) {
+        if (seq->gaps[g] < n) passes++;
+    }
+    return passes;
+}
+
+sort_stats_t shellsort_stats_passes(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                    size_t first, size_t last) {
+    sort_stats_t stats = {0, 0};
+    size_t pass = 0;
+
+    for (size_t g = seq->num_gaps; g > 0 && pass < last; g--) {
+        uint64_t gap = seq->gaps[g - 1];
+        if (gap >= n) continue;
+        if (pass++ < first) continue;
+
+        for (size_t i = gap; i < n; i++) {
+            shellsort_insert_counted(arr, i, gap, &stats);
+        }
+    }
+
+    return stats;
+}
+
+sort_stats_t shellsort_stats_from(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                  size_t first) {
+    return shellsort_stats_passes(arr, n, seq, first, SIZE_MAX);
+}
+
+/*
+ * Insert arr[i] into its chain. Requires i >= gap, so the first comparison
+ * needs no bounds check; the common "already in place" case exits early.
+ */
+static inline void insert_fast(int32_t *restrict arr, size_t i, size_t gap) {
+    int32_t temp = arr[i];
+    if (arr[i - gap] <= temp) return;
+
+    size_t j = i;
+    do {
+        arr[j] = arr[j - gap];
+        j -= gap;
+    } while (j >= gap && arr[j - gap] > temp);
+    arr[j] = temp;
+}
+
+void shellsort_fast(int32_t *restrict arr, size_t n, const gap_sequence_t *seq) {
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        size_t i = gap;
+
+        /*
+         * With gap >= 4, elements i..i+3 lie on four different chains, so
+         * the unrolled insertions have no data dependency on each other and
+         * the CPU can overlap them.
+         */
+        if (gap >= 4) {
+            for (; i + 3 < n; i += 4) {
+                insert_fast(arr, i, gap);
+                insert_fast(arr, i + 1, gap);
+                insert_fast(arr, i + 2, gap);
+                insert_fast(arr, i + 3, gap);
+            }
+        }
+        for (; i < n; i++) {
+            insert_fast(arr, i, gap);
+        }
+    }
+}
+
 int gap_sequence_valid(const gap_sequence_t *seq, char *reason, size_t reason_len) {
     if (seq->num_gaps == 0) {
         if (reason) snprintf(reason, reason_len, "Empty sequence");
@@ -22,6 +22,12 @@ typedef struct {
     size_t num_gaps;         /* Number of gaps */
 } gap_sequence_t;
 
+/* Key + payload record for the AoS kernels (sorted by key) */
+typedef struct {
+    int64_t key;
+    uint64_t value;
+} kv_pair_t;
+
 /* Sort statistics structure */
 typedef struct {
     uint64_t comparisons;    /* Data comparisons (A[j-gap] > temp) */
@@ -52,6 +58,246 @@ uint64_t shellsort(int32_t *arr, size_t n, const gap_sequence_t *seq);
  */
 sort_stats_t shellsort_stats(int32_t *arr, size_t n, const gap_sequence_t *seq);
 
+/*
+ * Pass-range variants of shellsort_stats(). Passes are numbered in the
+ * order they run, counting only gaps < n: pass 0 is the largest gap < n,
+ * pass shellsort_num_passes(n, seq) - 1 is gap 1.
+ *
+ * shellsort_stats_passes() runs passes [first, last) and returns the
+ * comparisons and moves of those passes only, so an array snapshotted after
+ * pass k can be finished with shellsort_stats_from(arr, n, seq, k) and the
+ * two counts added to get exactly shellsort_stats().
+ */
+size_t shellsort_num_passes(size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_stats_passes(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                    size_t first, size_t last);
+sort_stats_t shellsort_stats_from(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                  size_t first);
+
+/* Per-pass breakdown from shellsort_pass_stats() */
+typedef struct {
+    uint64_t gap;
+    uint64_t comparisons;
+    uint64_t moves;
+    uint64_t max_displacement; /* Farthest any one insertion moved its element, in slots */
+    uint64_t cycles;           /* Timestamp-counter ticks (ns where no TSC is available) */
+    uint64_t cache_misses;     /* Hardware counters, 0 unless perf events were opened */
+    uint64_t branch_misses;
+} pass_stats_t;
+
+/*
+ * Hardware counters for the calling thread (Linux perf_event_open). Open
+ * them on the thread that sorts; either fd is -1 if the event is not
+ * available (no PMU, perf_event_paranoid, non-Linux).
+ */
+typedef struct {
+    int cache_fd;            /* PERF_COUNT_HW_CACHE_MISSES */
+    int branch_fd;           /* PERF_COUNT_HW_BRANCH_MISSES */
+} perf_counters_t;
+
+/* Returns the number of events opened (0, 1 or 2) */
+int perf_counters_open(perf_counters_t *pc);
+void perf_counters_close(perf_counters_t *pc);
+
+/*
+ * Sort like shellsort_stats(), recording one pass_stats_t per pass in
+ * the order they run (passes[0] is the largest gap < n). passes needs
+ * MAX_GAPS entries; perf may be NULL. Returns the number of passes.
+ *
+ * This is the instrumented path only: the extra bookkeeping and counter
+ * reads make it slower than shellsort_stats(), and no other kernel pays
+ * for it.
+ */
+size_t shellsort_pass_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                            pass_stats_t *passes, const perf_counters_t *perf);
+
+/*
+ * Typed kernels. Same algorithm and counting as shellsort()/shellsort_stats()
+ * for other element types; the plain variant returns comparisons.
+ *
+ * Floating-point kernels compare with '>', so NaNs never move and their
+ * position in the output is unspecified.
+ */
+uint64_t shellsort_i64(int64_t *arr, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_i64_stats(int64_t *arr, size_t n, const gap_sequence_t *seq);
+uint64_t shellsort_u32(uint32_t *arr, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_u32_stats(uint32_t *arr, size_t n, const gap_sequence_t *seq);
+uint64_t shellsort_f32(float *arr, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_f32_stats(float *arr, size_t n, const gap_sequence_t *seq);
+uint64_t shellsort_f64(double *arr, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_f64_stats(double *arr, size_t n, const gap_sequence_t *seq);
+
+/* Key + payload, array-of-structs: records move as a unit (one move each) */
+uint64_t shellsort_kv(kv_pair_t *arr, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_kv_stats(kv_pair_t *arr, size_t n, const gap_sequence_t *seq);
+
+/*
+ * Key + payload, struct-of-arrays: each insertion walks and shifts the
+ * dense keys array alone, then shifts values[] along the slots it found in
+ * one pass; an element already in place never touches values[]. A
+ * key+value move counts as one move.
+ */
+uint64_t shellsort_kv_soa(int64_t *keys, uint64_t *values, size_t n, const gap_sequence_t *seq);
+sort_stats_t shellsort_kv_soa_stats(int64_t *keys, uint64_t *values, size_t n,
+                                    const gap_sequence_t *seq);
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+/* Type-generic entry points: shellsort_typed(arr, n, seq) picks the kernel from arr's type */
+#define shellsort_typed(arr, n, seq) _Generic((arr),                \
+        int32_t *:   shellsort,                                     \
+        int64_t *:   shellsort_i64,                                 \
+        uint32_t *:  shellsort_u32,                                 \
+        float *:     shellsort_f32,                                 \
+        double *:    shellsort_f64,                                 \
+        kv_pair_t *: shellsort_kv)((arr), (n), (seq))
+
+#define shellsort_typed_stats(arr, n, seq) _Generic((arr),          \
+        int32_t *:   shellsort_stats,                               \
+        int64_t *:   shellsort_i64_stats,                           \
+        uint32_t *:  shellsort_u32_stats,                           \
+        float *:     shellsort_f32_stats,                           \
+        double *:    shellsort_f64_stats,                           \
+        kv_pair_t *: shellsort_kv_stats)((arr), (n), (seq))
+#endif
+
+/*
+ * Production Shellsort: same passes and same result as shellsort(), but
+ * with no instrumentation. Use this for wall-clock measurements.
+ */
+void shellsort_fast(int32_t *arr, size_t n, const gap_sequence_t *seq);
+
+/*
+ * Passes with gap >= SHELLSORT_SIMD_MIN_GAP use the vector multi-chain
+ * kernel in shellsort_simd.c; smaller gaps run the scalar counting loop.
+ * Override at build time with -DSHELLSORT_SIMD_MIN_GAP=<gap>.
+ */
+#ifndef SHELLSORT_SIMD_MIN_GAP
+#define SHELLSORT_SIMD_MIN_GAP 64
+#endif
+
+/*
+ * Vectorized Shellsort (AVX-512 / AVX2 / NEON, scalar fallback).
+ * Advances several adjacent chains in lock-step on large gaps.
+ * Result, comparisons and moves are identical to shellsort_stats().
+ */
+sort_stats_t shellsort_simd_stats(int32_t *arr, size_t n, const gap_sequence_t *seq);
+uint64_t shellsort_simd(int32_t *arr, size_t n, const gap_sequence_t *seq);
+
+/* Number of chains the compiled-in SIMD backend advances per step (1 = scalar) */
+int shellsort_simd_lanes(void);
+
+/*
+ * Sort count independent arrays (arrays[k] holds lengths[k] elements) with
+ * one gap sequence. Each run of shellsort_simd_lanes() consecutive arrays
+ * of equal length is interleaved so every SIMD lane sorts a different
+ * array; other arrays use the scalar loop. Passes are trimmed to the
+ * length once per run, not once per array. Result, comparisons and moves
+ * are the sum of shellsort_stats() over the arrays.
+ */
+sort_stats_t shellsort_batch_stats(int32_t *const *arrays, const size_t *lengths, size_t count,
+                                   const gap_sequence_t *seq);
+uint64_t shellsort_batch(int32_t *const *arrays, const size_t *lengths, size_t count,
+                         const gap_sequence_t *seq);
+
+/*
+ * Cache-blocked Shellsort. Passes whose gap row (gap * 4 bytes) exceeds
+ * cache_bytes are tiled into blocks of adjacent chains that are sorted to
+ * completion one block at a time. cache_bytes = 0 uses the detected L2 size.
+ * Result, comparisons and moves are identical to shellsort_stats().
+ */
+sort_stats_t shellsort_blocked_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                     size_t cache_bytes);
+
+/* Detected L2 cache size in bytes (1 MiB if unknown) */
+size_t shellsort_l2_bytes(void);
+
+/*
+ * Multithreaded Shellsort of one array (shellsort_parallel.c). Passes
+ * whose gap leaves every thread a block of at least
+ * SHELLSORT_PARALLEL_MIN_CHAINS adjacent chains are split by chain across
+ * up to `threads` OpenMP threads; smaller gaps, and arrays under
+ * SHELLSORT_PARALLEL_MIN_N elements, run serially. Result, comparisons and
+ * moves are identical to shellsort_stats() for any thread count.
+ */
+#ifndef SHELLSORT_PARALLEL_MIN_CHAINS
+#define SHELLSORT_PARALLEL_MIN_CHAINS 64
+#endif
+#ifndef SHELLSORT_PARALLEL_MIN_N
+#define SHELLSORT_PARALLEL_MIN_N 65536
+#endif
+
+sort_stats_t shellsort_parallel_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                      int threads);
+uint64_t shellsort_parallel(int32_t *arr, size_t n, const gap_sequence_t *seq, int threads);
+
+/*
+ * Pass engines (shellsort_engine.c): the algorithm each gap's pass runs.
+ * Passes with gap <= max_gap use `small`; larger gaps always use gapped
+ * insertion. The default engine (insertion, max_gap 1) is exactly
+ * shellsort_stats().
+ */
+typedef enum {
+    PASS_INSERTION = 0,      /* Gapped linear insertion */
+    PASS_BINARY,             /* Galloping binary insertion along the chain */
+    PASS_NETWORK,            /* 8-element min/max sorting network blocks, then insertion */
+    PASS_NUM_KINDS
+} pass_kind_t;
+
+typedef struct {
+    pass_kind_t small;       /* Engine for the small-gap passes */
+    uint64_t max_gap;        /* Largest gap that uses it (>= 1) */
+} pass_engine_t;
+
+/* Engine name ("insertion", "binary", "network") */
+const char *pass_kind_name(pass_kind_t kind);
+
+/* Insertion everywhere */
+pass_engine_t pass_engine_default(void);
+
+/* Parse "<kind>[:<max_gap>]", e.g. "network" or "binary:4"; returns 0, or -1 if invalid */
+int pass_engine_parse(const char *spec, pass_engine_t *engine);
+
+/* Label for output ("insertion", "network:1"); returns the length */
+size_t pass_engine_label(const pass_engine_t *engine, char *buf, size_t len);
+
+/*
+ * Sort with engine choosing each pass's algorithm. Comparisons count every
+ * probe or comparator, moves every element written, as in shellsort_stats().
+ * shellsort_engine() is the uninstrumented variant for timing.
+ */
+sort_stats_t shellsort_engine_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                    const pass_engine_t *engine);
+void shellsort_engine(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                      const pass_engine_t *engine);
+
+/*
+ * Kernels specialized at compile time for one gap sequence (see
+ * shellsort_fixed.h). shellsort_evolved(arr, n) sorts like shellsort()
+ * with gaps_evolved(&seq, n) whenever shellsort_fixed_matches() agrees;
+ * likewise for Ciura.
+ */
+void shellsort_evolved(int32_t *arr, size_t n);
+sort_stats_t shellsort_evolved_stats(int32_t *arr, size_t n);
+void shellsort_ciura(int32_t *arr, size_t n);
+sort_stats_t shellsort_ciura_stats(int32_t *arr, size_t n);
+
+typedef struct {
+    const char *name;        /* Matches gap_sequence_t.name of the generator */
+    void (*sort)(int32_t *arr, size_t n);
+    sort_stats_t (*sort_stats)(int32_t *arr, size_t n);
+    const uint64_t *gaps;    /* Compiled-in gaps, DESCENDING */
+    size_t num_gaps;
+} fixed_kernel_t;
+
+/* Specialized kernel for a sequence name, or NULL if none was generated */
+const fixed_kernel_t *shellsort_fixed_lookup(const char *name);
+
+/*
+ * Returns 1 if kernel k applies exactly the passes that shellsort() would
+ * apply for seq on n elements (same gaps below n), 0 otherwise.
+ */
+int shellsort_fixed_matches(const fixed_kernel_t *k, const gap_sequence_t *seq, size_t n);
+
 /*
  * Validate a gap sequence according to CLAUDE.md section 3.3:
  * - Strictly increasing (when stored ascending)
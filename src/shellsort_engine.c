@@ -0,0 +1,206 @@
+/*
+ * shellsort_engine.c - Per-gap pass engines (see pass_engine_t)
+ *
+ * The small-gap passes of a Shellsort, gap 1 above all, do most of their
+ * work on arrays that are already nearly sorted. Two replacements for the
+ * gapped insertion pass are provided for them:
+ *
+ *   PASS_BINARY   galloping binary insertion: probe arr[i-g] first (one
+ *                 comparison when the element is in place, like insertion),
+ *                 then 2, 4, 8, ... chain slots back, then binary search the
+ *                 bracket. Comparisons grow with log(distance moved) rather
+ *                 than the distance; the shifts are the same.
+ *   PASS_NETWORK  every run of 8 consecutive chain elements is sorted by the
+ *                 19-comparator optimal network with branch-free min/max,
+ *                 then an insertion pass finishes the chain. The network
+ *                 costs a fixed 19 comparisons per block but no mispredicted
+ *                 branches; the insertion pass that follows is short.
+ *
+ * Every comparator and probe counts as one comparison, and every element
+ * written as one move (a comparator that exchanges writes two), so the
+ * counted-comparison numbers stay comparable with shellsort_stats(). The
+ * sorted output is the same for every engine.
+ */
+
+#include "shellsort.h"
+#include "shellsort_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const pass_kind_names[PASS_NUM_KINDS] = {
+    "insertion", "binary", "network"
+};
+
+const char *pass_kind_name(pass_kind_t kind) {
+    if ((unsigned)kind >= PASS_NUM_KINDS) return "unknown";
+    return pass_kind_names[kind];
+}
+
+pass_engine_t pass_engine_default(void) {
+    pass_engine_t engine = { PASS_INSERTION, 1 };
+    return engine;
+}
+
+int pass_engine_parse(const char *spec, pass_engine_t *engine) {
+    size_t len = strcspn(spec, ":");
+    *engine = pass_engine_default();
+
+    int found = 0;
+    for (int k = 0; k < PASS_NUM_KINDS; k++) {
+        if (strlen(pass_kind_names[k]) == len && strncmp(spec, pass_kind_names[k], len) == 0) {
+            engine->small = (pass_kind_t)k;
+            found = 1;
+        }
+    }
+    if (!found) return -1;
+
+    if (spec[len] == ':') {
+        char *end;
+        engine->max_gap = strtoull(spec + len + 1, &end, 10);
+        if (end == spec + len + 1 || *end != '\0' || engine->max_gap == 0) return -1;
+    }
+    return 0;
+}
+
+size_t pass_engine_label(const pass_engine_t *engine, char *buf, size_t len) {
+    int w;
+    if (engine->small == PASS_INSERTION) {
+        w = snprintf(buf, len, "insertion");
+    } else {
+        w = snprintf(buf, len, "%s:%lu", pass_kind_name(engine->small),
+                     (unsigned long)engine->max_gap);
+    }
+    return w < 0 ? 0 : (size_t)w;
+}
+
+/*
+ * The kernels below take `counted` as a constant, so the instrumented and
+ * plain entry points each get a specialized copy with no dead bookkeeping.
+ */
+
+static inline void insertion_pass(int32_t *arr, size_t n, size_t gap, sort_stats_t *st,
+                                  const int counted) {
+    /* Plain passes count into a local the compiler drops */
+    sort_stats_t unused = {0, 0};
+    sort_stats_t *c = counted ? st : &unused;
+    for (size_t i = gap; i < n; i++) {
+        shellsort_insert_counted(arr, i, gap, c);
+    }
+}
+
+static inline void binary_pass(int32_t *arr, size_t n, size_t gap, sort_stats_t *st,
+                               const int counted) {
+    for (size_t i = gap; i < n; i++) {
+        int32_t temp = arr[i];
+
+        /* In place already: one comparison, as in insertion */
+        if (counted) st->comparisons++;
+        if (arr[i - gap] <= temp) {
+            if (counted) st->moves++;
+            continue;
+        }
+
+        /*
+         * Chain slots back from i: slot s is arr[i - s*gap], s = 1..smax.
+         * Keep arr[slot hi] > temp and arr[slot lo] <= temp (lo = smax + 1
+         * stands for "before the chain start").
+         */
+        size_t smax = i / gap;
+        size_t hi = 1, lo = smax + 1;
+        for (size_t s = 2; s <= smax; s *= 2) {
+            if (counted) st->comparisons++;
+            if (arr[i - s * gap] > temp) {
+                hi = s;
+            } else {
+                lo = s;
+                break;
+            }
+        }
+        while (lo - hi > 1) {
+            size_t mid = hi + (lo - hi) / 2;
+            if (counted) st->comparisons++;
+            if (arr[i - mid * gap] > temp) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+
+        /* Shift slots 1..hi up one and drop temp into slot hi */
+        size_t j = i;
+        for (size_t s = 0; s < hi; s++) {
+            arr[j] = arr[j - gap];
+            j -= gap;
+        }
+        arr[j] = temp;
+        if (counted) st->moves += hi + 1;
+    }
+}
+
+/* Branch-free compare-exchange of a[x * gap] and a[y * gap] */
+static inline void cmpx(int32_t *a, size_t gap, size_t x, size_t y, sort_stats_t *st,
+                        const int counted) {
+    int32_t p = a[x * gap], q = a[y * gap];
+    a[x * gap] = p < q ? p : q;
+    a[y * gap] = p < q ? q : p;
+    if (counted) {
+        st->comparisons++;
+        st->moves += 2 * (uint64_t)(p > q);
+    }
+}
+
+/* Optimal 19-comparator network on a[0], a[gap], ..., a[7 * gap] */
+static inline void network8(int32_t *a, size_t gap, sort_stats_t *st, const int counted) {
+    cmpx(a, gap, 0, 2, st, counted); cmpx(a, gap, 1, 3, st, counted);
+    cmpx(a, gap, 4, 6, st, counted); cmpx(a, gap, 5, 7, st, counted);
+    cmpx(a, gap, 0, 4, st, counted); cmpx(a, gap, 1, 5, st, counted);
+    cmpx(a, gap, 2, 6, st, counted); cmpx(a, gap, 3, 7, st, counted);
+    cmpx(a, gap, 0, 1, st, counted); cmpx(a, gap, 2, 3, st, counted);
+    cmpx(a, gap, 4, 5, st, counted); cmpx(a, gap, 6, 7, st, counted);
+    cmpx(a, gap, 2, 4, st, counted); cmpx(a, gap, 3, 5, st, counted);
+    cmpx(a, gap, 1, 4, st, counted); cmpx(a, gap, 3, 6, st, counted);
+    cmpx(a, gap, 1, 2, st, counted); cmpx(a, gap, 3, 4, st, counted);
+    cmpx(a, gap, 5, 6, st, counted);
+}
+
+static inline void network_pass(int32_t *arr, size_t n, size_t gap, sort_stats_t *st,
+                                const int counted) {
+    /* Rows of 8 * gap elements hold one 8-element block of every chain */
+    for (size_t row = 0; row + 7 * gap < n; row += 8 * gap) {
+        for (size_t c = 0; c < gap && row + c + 7 * gap < n; c++) {
+            network8(arr + row + c, gap, st, counted);
+        }
+    }
+    insertion_pass(arr, n, gap, st, counted);
+}
+
+static inline void engine_sort(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                               const pass_engine_t *engine, sort_stats_t *st,
+                               const int counted) {
+    /* Apply gaps in descending order (seq stores them ascending) */
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        pass_kind_t kind = (gap <= engine->max_gap) ? engine->small : PASS_INSERTION;
+        switch (kind) {
+            case PASS_BINARY:  binary_pass(arr, n, gap, st, counted); break;
+            case PASS_NETWORK: network_pass(arr, n, gap, st, counted); break;
+            default:           insertion_pass(arr, n, gap, st, counted); break;
+        }
+    }
+}
+
+sort_stats_t shellsort_engine_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                    const pass_engine_t *engine) {
+    sort_stats_t stats = {0, 0};
+    engine_sort(arr, n, seq, engine, &stats, 1);
+    return stats;
+}
+
+void shellsort_engine(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                      const pass_engine_t *engine) {
+    engine_sort(arr, n, seq, engine, NULL, 0);
+}
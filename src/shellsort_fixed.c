@@ -0,0 +1,37 @@
+/*
+ * shellsort_fixed.c - Specialized kernels for the shipped gap sequences
+ */
+
+#include "shellsort_fixed.h"
+#include <string.h>
+
+SHELLSORT_DEFINE_FIXED(shellsort_evolved, SHELLSORT_GAPS_EVOLVED)
+SHELLSORT_DEFINE_FIXED(shellsort_ciura, SHELLSORT_GAPS_CIURA)
+
+static const fixed_kernel_t fixed_kernels[] = {
+    {"Evolved", shellsort_evolved, shellsort_evolved_stats,
+     shellsort_evolved_gaps, sizeof(shellsort_evolved_gaps) / sizeof(uint64_t)},
+    {"Ciura",   shellsort_ciura,   shellsort_ciura_stats,
+     shellsort_ciura_gaps, sizeof(shellsort_ciura_gaps) / sizeof(uint64_t)},
+};
+
+const fixed_kernel_t *shellsort_fixed_lookup(const char *name) {
+    for (size_t i = 0; i < sizeof(fixed_kernels) / sizeof(fixed_kernels[0]); i++) {
+        if (strcmp(fixed_kernels[i].name, name) == 0) return &fixed_kernels[i];
+    }
+    return NULL;
+}
+
+int shellsort_fixed_matches(const fixed_kernel_t *k, const gap_sequence_t *seq, size_t n) {
+    /* Walk both lists from the largest gap below n downwards */
+    size_t a = 0;
+    while (a < k->num_gaps && k->gaps[a] >= n) a++;
+
+    size_t b = seq->num_gaps;
+    while (b > 0 && seq->gaps[b - 1] >= n) b--;
+
+    for (; a < k->num_gaps && b > 0; a++, b--) {
+        if (k->gaps[a] != seq->gaps[b - 1]) return 0;
+    }
+    return a == k->num_gaps && b == 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * shellsort_fixed.h - Generator for sorts specialized to a fixed gap sequence
+ *
+ * A gap list is an X-macro that applies X(gap) to each gap, LARGEST FIRST:
+ *
+ *   #define MY_GAPS(X) X(701) X(301) X(132) X(57) X(23) X(10) X(4) X(1)
+ *   SHELLSORT_DEFINE_FIXED(shellsort_mine, MY_GAPS)
+ *
+ * defines
+ *
+ *   void shellsort_mine(int32_t *arr, size_t n);
+ *   sort_stats_t shellsort_mine_stats(int32_t *arr, size_t n);
+ *   static const uint64_t shellsort_mine_gaps[];   (descending)
+ *
+ * Every pass is expanded inline with its gap as a compile-time constant, so
+ * the compiler can strength-reduce the strides and the loop over passes
+ * disappears. Gaps >= n are skipped, exactly as in shellsort(); the _stats
+ * variant counts the same way as shellsort_stats().
+ */
+
+#ifndef SHELLSORT_FIXED_H
+#define SHELLSORT_FIXED_H
+
+#include "shellsort.h"
+
+#if defined(__GNUC__)
+#define SHELLSORT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SHELLSORT_ALWAYS_INLINE inline
+#endif
+
+/* One uninstrumented pass (same loop shape as shellsort_fast) */
+static SHELLSORT_ALWAYS_INLINE void shellsort_fixed_pass(int32_t *restrict arr, size_t n,
+                                                         const size_t gap) {
+    if (gap >= n) return;
+
+    for (size_t i = gap; i < n; i++) {
+        int32_t temp = arr[i];
+        if (arr[i - gap] <= temp) continue;
+
+        size_t j = i;
+        do {
+            arr[j] = arr[j - gap];
+            j -= gap;
+        } while (j >= gap && arr[j - gap] > temp);
+        arr[j] = temp;
+    }
+}
+
+/* One counted pass (same counting as shellsort_stats) */
+static SHELLSORT_ALWAYS_INLINE void shellsort_fixed_pass_stats(int32_t *restrict arr, size_t n,
+                                                               const size_t gap,
+                                                               sort_stats_t *stats) {
+    if (gap >= n) return;
+
+    for (size_t i = gap; i < n; i++) {
+        int32_t temp = arr[i];
+        size_t j = i;
+
+        while (j >= gap) {
+            stats->comparisons++;
+            if (arr[j - gap] > temp) {
+                arr[j] = arr[j - gap];
+                stats->moves++;
+                j -= gap;
+            } else {
+                break;
+            }
+        }
+        arr[j] = temp;
+        stats->moves++;
+    }
+}
+
+#define SHELLSORT_FIXED_PASS_(gap) shellsort_fixed_pass(arr, n, (size_t)(gap));
+#define SHELLSORT_FIXED_PASS_STATS_(gap) shellsort_fixed_pass_stats(arr, n, (size_t)(gap), &stats);
+
+#define SHELLSORT_FIXED_GAP_(gap) (uint64_t)(gap),
+
+#define SHELLSORT_DEFINE_FIXED(name, GAPS)                          \
+    static const uint64_t name##_gaps[] = {                         \
+        GAPS(SHELLSORT_FIXED_GAP_)                                  \
+    };                                                              \
+    void name(int32_t *restrict arr, size_t n) {                    \
+        GAPS(SHELLSORT_FIXED_PASS_)                                 \
+    }                                                               \
+    sort_stats_t name##_stats(int32_t *restrict arr, size_t n) {    \
+        sort_stats_t stats = {0, 0};                                \
+        GAPS(SHELLSORT_FIXED_PASS_STATS_)                           \
+        return stats;                                               \
+    }
+
+/*
+ * Evolved and Ciura gap lists: the published table followed by the 2.25x
+ * extension (h = (uint64_t)(h * 2.25)) up to 2^32.
+ *
+ * gaps_evolved(&seq, max_gap) extends from the last table entry <= max_gap,
+ * so for some n it inserts an extra gap between two table entries (e.g.
+ * 2330349 when 2330350 <= n <= 3236462). Outside those windows sorting n
+ * elements with these lists is identical to shellsort() with
+ * gaps_evolved(&seq, n); shellsort_fixed_matches() checks a given n.
+ */
+#define SHELLSORT_GAPS_EVOLVED(X)                                               \
+    X(2125840108) X(944817826) X(419919034) X(186630682) X(82946970)            \
+    X(36865320) X(16384587) X(7282039)                                          \
+    X(3236462) X(1035711) X(460316) X(199137) X(94681) X(40056) X(17961)        \
+    X(7705) X(3524) X(1577) X(701) X(301) X(132) X(57) X(23) X(10) X(4) X(1)
+
+#define SHELLSORT_GAPS_CIURA(X)                                                 \
+    X(3444003501u) X(1530668223) X(680296988) X(302354217) X(134379652)         \
+    X(59724290) X(26544129) X(11797391) X(5243285) X(2330349) X(1035711)        \
+    X(460316) X(204585) X(90927) X(40412) X(17961) X(7983) X(3548) X(1577)      \
+    X(701) X(301) X(132) X(57) X(23) X(10) X(4) X(1)
+
+#endif /* SHELLSORT_FIXED_H */
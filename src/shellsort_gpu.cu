@@ -0,0 +1,300 @@
+/*
+ * shellsort_gpu.cu - CUDA / HIP backend for gpu_evaluate() (shellsort_gpu.h)
+ *
+ *   nvcc  -O3 -c shellsort_gpu.cu                    (CUDA)
+ *   hipcc -O3 -c -x hip shellsort_gpu.cu             (ROCm)
+ *
+ * Each block takes (sequence, trial) tasks in turn. A task copies its trial
+ * from the resident dataset into the block's work array (shared memory
+ * when N fits, else a per-block slice of global memory), then runs the
+ * passes from the largest gap down. Thread k of the block owns chains
+ * k, k + blockDim, ... of each pass, so neighbouring threads walk
+ * neighbouring chains and their loads coalesce; a barrier separates
+ * passes. Each thread counts the comparisons of its chains exactly as
+ * shellsort() does and the block adds them up, so the per-trial totals
+ * equal shellsort()'s whatever the block size or scheduling.
+ *
+ * Small gaps leave most of a block idle (gap 1 is a single chain, one
+ * thread), so throughput comes from many trials in flight at once rather
+ * than from within one sort.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__HIPCC__)
+#include <hip/hip_runtime.h>
+#define GPU(name) hip##name
+#define GPU_ATTR_SM_COUNT hipDeviceAttributeMultiprocessorCount
+#define GPU_DEVICE_PROP hipDeviceProp_t
+#else
+#include <cuda_runtime.h>
+#define GPU(name) cuda##name
+#define GPU_ATTR_SM_COUNT cudaDevAttrMultiProcessorCount
+#define GPU_DEVICE_PROP cudaDeviceProp
+#endif
+
+extern "C" {
+#include "shellsort_gpu.h"
+}
+
+/* Threads per block: chains of one pass handed out per thread */
+#define GPU_BLOCK_THREADS 256
+
+/* Default per-block shared memory limit; trials that fit below it sort in shared memory */
+#define GPU_SHARED_BYTES (48 * 1024)
+
+/*
+ * Kept free for the kernel's static __shared__ variables (block_comps and
+ * whatever the compiler adds), so n * 4 bytes plus those stay under the
+ * limit; without it the launch fails at exactly GPU_SHARED_BYTES / 4.
+ */
+#define GPU_STATIC_SHARED_RESERVE 1024
+
+/* Resident blocks per multiprocessor to aim for */
+#define GPU_BLOCKS_PER_SM 4
+
+struct gpu_dataset {
+    uint64_t n;
+    uint64_t trials;
+    int32_t *perms;          /* trials * n elements, device */
+    int32_t *work;           /* slots * n elements, device (unused for shared-memory N) */
+    size_t slots;            /* Blocks launched per gpu_evaluate() */
+    int shared;              /* 1: trials fit in shared memory */
+    char device[256];
+};
+
+/* Print err and return 1 if it is not success */
+static int gpu_failed(GPU(Error_t) err, const char *what) {
+    if (err == GPU(Success)) return 0;
+    fprintf(stderr, "Error: GPU %s: %s\n", what, GPU(GetErrorString)(err));
+    return 1;
+}
+
+__global__ void evaluate_kernel(const int32_t *perms, uint64_t n, uint64_t trials,
+                                const uint64_t *gaps, const uint32_t *num_gaps, uint64_t tasks,
+                                int32_t *work, int shared, unsigned long long *comps,
+                                unsigned int *unsorted) {
+    extern __shared__ int32_t shared_arr[];
+    __shared__ unsigned long long block_comps;
+
+    int32_t *arr = shared ? shared_arr : work + (size_t)blockIdx.x * n;
+
+    for (uint64_t task = blockIdx.x; task < tasks; task += gridDim.x) {
+        uint64_t s = task / trials;
+        uint64_t t = task % trials;
+        const int32_t *src = perms + t * n;
+
+        for (uint64_t i = threadIdx.x; i < n; i += blockDim.x) arr[i] = src[i];
+        if (threadIdx.x == 0) block_comps = 0;
+        __syncthreads();
+
+        /* Gaps stored ascending, applied descending, as in shellsort() */
+        unsigned long long local = 0;
+        const uint64_t *seq_gaps = gaps + s * MAX_GAPS;
+        for (uint32_t g = num_gaps[s]; g > 0; g--) {
+            uint64_t gap = seq_gaps[g - 1];
+            if (gap >= n) continue;
+
+            for (uint64_t c = threadIdx.x; c < gap; c += blockDim.x) {
+                for (uint64_t i = c + gap; i < n; i += gap) {
+                    int32_t temp = arr[i];
+                    uint64_t j = i;
+                    while (j >= gap) {
+                        local++;
+                        if (arr[j - gap] > temp) {
+                            arr[j] = arr[j - gap];
+                            j -= gap;
+                        } else {
+                            break;
+                        }
+                    }
+                    arr[j] = temp;
+                }
+            }
+            __syncthreads();
+        }
+        atomicAdd(&block_comps, local);
+
+        for (uint64_t i = threadIdx.x + 1; i < n; i += blockDim.x) {
+            if (arr[i - 1] > arr[i]) {
+                atomicAdd(unsorted, 1u);
+                break;
+            }
+        }
+        __syncthreads();
+
+        if (threadIdx.x == 0) comps[task] = block_comps;
+        __syncthreads();
+    }
+}
+
+extern "C" int gpu_device_count(void) {
+    int count = 0;
+    if (GPU(GetDeviceCount)(&count) != GPU(Success)) return 0;
+    return count;
+}
+
+extern "C" gpu_dataset_t *gpu_dataset_upload(const perm_dataset_t *ds) {
+    if (ds->elem_type != ELEM_I32) {
+        fprintf(stderr, "Error: GPU backend only supports i32 datasets\n");
+        return NULL;
+    }
+    if (gpu_device_count() == 0) {
+        fprintf(stderr, "Error: No GPU device available\n");
+        return NULL;
+    }
+
+    gpu_dataset_t *g = (gpu_dataset_t *)calloc(1, sizeof(*g));
+    int32_t *staging = (int32_t *)malloc(ds->N * sizeof(int32_t));
+    if (!g || !staging) {
+        fprintf(stderr, "Error: Out of memory staging the GPU dataset\n");
+        free(g);
+        free(staging);
+        return NULL;
+    }
+    g->n = ds->N;
+    g->trials = ds->trials;
+    g->shared = ds->N * sizeof(int32_t) + GPU_STATIC_SHARED_RESERVE <= GPU_SHARED_BYTES;
+
+    GPU_DEVICE_PROP prop;
+    int sms = 1;
+    if (gpu_failed(GPU(SetDevice)(0), "select device") ||
+        gpu_failed(GPU(GetDeviceProperties)(&prop, 0), "query device") ||
+        gpu_failed(GPU(DeviceGetAttribute)(&sms, GPU_ATTR_SM_COUNT, 0), "query device")) {
+        free(g);
+        free(staging);
+        return NULL;
+    }
+    strncpy(g->device, prop.name, sizeof(g->device) - 1);
+
+    size_t trial_bytes = ds->N * sizeof(int32_t);
+    if (gpu_failed(GPU(Malloc)((void **)&g->perms, trial_bytes * ds->trials),
+                   "allocate dataset")) {
+        free(g);
+        free(staging);
+        return NULL;
+    }
+    for (uint64_t t = 0; t < ds->trials; t++) {
+        dataset_copy_trial(ds, t, staging);
+        if (gpu_failed(GPU(Memcpy)(g->perms + t * ds->N, staging, trial_bytes,
+                                   GPU(MemcpyHostToDevice)), "upload dataset")) {
+            gpu_dataset_free(g);
+            free(staging);
+            return NULL;
+        }
+    }
+    free(staging);
+
+    /* Enough blocks to fill the device; large N is capped by free memory */
+    g->slots = (size_t)sms * GPU_BLOCKS_PER_SM;
+    if (!g->shared) {
+        size_t free_bytes = 0, total_bytes = 0;
+        if (gpu_failed(GPU(MemGetInfo)(&free_bytes, &total_bytes), "query memory")) {
+            gpu_dataset_free(g);
+            return NULL;
+        }
+        size_t fit = free_bytes / 2 / trial_bytes;
+        if (fit < g->slots) g->slots = fit;
+        if (g->slots == 0) {
+            fprintf(stderr, "Error: GPU has no room for a work buffer at N=%lu\n",
+                    (unsigned long)ds->N);
+            gpu_dataset_free(g);
+            return NULL;
+        }
+        if (gpu_failed(GPU(Malloc)((void **)&g->work, trial_bytes * g->slots),
+                       "allocate work buffers")) {
+            gpu_dataset_free(g);
+            return NULL;
+        }
+    }
+    return g;
+}
+
+extern "C" void gpu_dataset_free(gpu_dataset_t *g) {
+    if (!g) return;
+    if (g->perms) GPU(Free)(g->perms);
+    if (g->work) GPU(Free)(g->work);
+    free(g);
+}
+
+extern "C" const char *gpu_dataset_device(const gpu_dataset_t *g) {
+    return g ? g->device : "";
+}
+
+extern "C" int gpu_evaluate(gpu_dataset_t *g, const gap_sequence_t *seqs, size_t count,
+                            uint64_t *comps) {
+    if (count == 0 || g->trials == 0) return 0;
+
+    uint64_t tasks = (uint64_t)count * g->trials;
+    uint64_t *host_gaps = (uint64_t *)calloc(count * MAX_GAPS, sizeof(uint64_t));
+    uint32_t *host_num = (uint32_t *)malloc(count * sizeof(uint32_t));
+    if (!host_gaps || !host_num) {
+        fprintf(stderr, "Error: Out of memory for GPU gap tables\n");
+        free(host_gaps);
+        free(host_num);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        memcpy(host_gaps + i * MAX_GAPS, seqs[i].gaps, seqs[i].num_gaps * sizeof(uint64_t));
+        host_num[i] = (uint32_t)seqs[i].num_gaps;
+    }
+
+    uint64_t *dev_gaps = NULL;
+    uint32_t *dev_num = NULL;
+    unsigned long long *dev_comps = NULL;
+    unsigned int *dev_unsorted = NULL;
+    unsigned int unsorted = 0;
+    int rc = -1;
+
+    if (gpu_failed(GPU(Malloc)((void **)&dev_gaps, count * MAX_GAPS * sizeof(uint64_t)),
+                   "allocate gaps") ||
+        gpu_failed(GPU(Malloc)((void **)&dev_num, count * sizeof(uint32_t)), "allocate gaps") ||
+        gpu_failed(GPU(Malloc)((void **)&dev_comps, tasks * sizeof(unsigned long long)),
+                   "allocate counts") ||
+        gpu_failed(GPU(Malloc)((void **)&dev_unsorted, sizeof(unsigned int)),
+                   "allocate counts") ||
+        gpu_failed(GPU(Memcpy)(dev_gaps, host_gaps, count * MAX_GAPS * sizeof(uint64_t),
+                               GPU(MemcpyHostToDevice)), "upload gaps") ||
+        gpu_failed(GPU(Memcpy)(dev_num, host_num, count * sizeof(uint32_t),
+                               GPU(MemcpyHostToDevice)), "upload gaps") ||
+        gpu_failed(GPU(Memset)(dev_unsorted, 0, sizeof(unsigned int)), "clear counts")) {
+        goto done;
+    }
+
+    {
+        size_t blocks = g->slots < tasks ? g->slots : (size_t)tasks;
+        size_t shared_bytes = g->shared ? g->n * sizeof(int32_t) : 0;
+        evaluate_kernel<<<(unsigned int)blocks, GPU_BLOCK_THREADS, shared_bytes>>>(
+            g->perms, g->n, g->trials, dev_gaps, dev_num, tasks, g->work, g->shared, dev_comps,
+            dev_unsorted);
+    }
+    if (gpu_failed(GPU(GetLastError)(), "launch") ||
+        gpu_failed(GPU(DeviceSynchronize)(), "evaluate")) {
+        goto done;
+    }
+
+    /* unsigned long long and uint64_t are both 64 bits on every target */
+    if (gpu_failed(GPU(Memcpy)(comps, dev_comps, tasks * sizeof(uint64_t),
+                               GPU(MemcpyDeviceToHost)), "download counts") ||
+        gpu_failed(GPU(Memcpy)(&unsorted, dev_unsorted, sizeof(unsigned int),
+                               GPU(MemcpyDeviceToHost)), "download counts")) {
+        goto done;
+    }
+    if (unsorted) {
+        fprintf(stderr, "Error: GPU output failed the sorted check (%u threads saw an "
+                "out-of-order pair)\n", unsorted);
+        goto done;
+    }
+    rc = 0;
+
+done:
+    if (dev_gaps) GPU(Free)(dev_gaps);
+    if (dev_num) GPU(Free)(dev_num);
+    if (dev_comps) GPU(Free)(dev_comps);
+    if (dev_unsorted) GPU(Free)(dev_unsorted);
+    free(host_gaps);
+    free(host_num);
+    return rc;
+}
@@ -0,0 +1,61 @@
+/*
+ * shellsort_gpu.h - Optional GPU backend for scoring gap sequences
+ *
+ * Built only when a CUDA or HIP toolchain is available (see README):
+ * shellsort_gpu.cu goes into its own libshellsort_gpu.a, linked ahead of
+ * libshellsort.a, and tools compiled with -DSHELLSORT_GPU (the README
+ * builds all_baselines_bench_gpu) gain a --gpu option. Nothing in
+ * libshellsort.a depends on it.
+ *
+ * A dataset is uploaded once and stays resident in device memory; each
+ * gpu_evaluate() call then sorts every (sequence, trial) pair on the
+ * device, one trial per thread block with the chains of each pass split
+ * across the block's threads. Chains are independent within a pass, so
+ * every chain sees the same insertions as in shellsort() and the counts
+ * are identical to it, not approximations.
+ *
+ * UNVERIFIED: shellsort_gpu.cu has not been compiled by nvcc or hipcc or
+ * run on a device yet. Before trusting its numbers, run the same dataset
+ * through all_baselines_bench with and without --gpu and compare counts.
+ */
+
+#ifndef SHELLSORT_GPU_H
+#define SHELLSORT_GPU_H
+
+#include "shellsort.h"
+#include "dataset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Dataset resident on the device (opaque) */
+typedef struct gpu_dataset gpu_dataset_t;
+
+/* Number of usable devices (0 without a GPU or driver) */
+int gpu_device_count(void);
+
+/*
+ * Copy every trial of ds (ELEM_I32; files, .pg2 or generated) to device 0.
+ * Returns NULL with a message on stderr if there is no device or it does
+ * not have room for the dataset plus one work buffer.
+ */
+gpu_dataset_t *gpu_dataset_upload(const perm_dataset_t *ds);
+void gpu_dataset_free(gpu_dataset_t *g);
+
+/* Device name for output ("" once freed) */
+const char *gpu_dataset_device(const gpu_dataset_t *g);
+
+/*
+ * Sort every trial with each of seqs[0..count) on the device and store the
+ * comparisons of seqs[i] on trial t in comps[i * trials + t], exactly as
+ * shellsort() would count them. Every sorted trial is also checked on the
+ * device; returns 0, or -1 on a device error or an unsorted result.
+ */
+int gpu_evaluate(gpu_dataset_t *g, const gap_sequence_t *seqs, size_t count, uint64_t *comps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHELLSORT_GPU_H */
@@ -0,0 +1,43 @@
+/*
+ * shellsort_internal.h - The counted insertion step shared by the kernels
+ *
+ * Internal to the library sources; tools use shellsort.h. Every int32
+ * kernel that reports sort_stats_t inserts through shellsort_insert_counted(),
+ * so the counting rule below exists once and the kernels cannot drift
+ * apart. Loops that cannot share it apply the same rule in their own way:
+ * the vector lanes of shellsort_simd.c, the compile-time-gap passes of
+ * shellsort_fixed.h (a public header) and the non-int32 typed kernels.
+ */
+
+#ifndef SHELLSORT_INTERNAL_H
+#define SHELLSORT_INTERNAL_H
+
+#include "shellsort.h"
+
+/*
+ * Insert arr[i] into its gap chain (i >= gap). Per CLAUDE.md 3.2, count
+ * ONE comparison per evaluation of arr[j-gap] > temp, regardless of
+ * outcome; count one move per shift and one for the final placement.
+ * Returns the slot arr[i] landed in.
+ */
+static inline size_t shellsort_insert_counted(int32_t *arr, size_t i, size_t gap,
+                                              sort_stats_t *st) {
+    int32_t temp = arr[i];
+    size_t j = i;
+
+    while (j >= gap) {
+        st->comparisons++;
+        if (arr[j - gap] > temp) {
+            arr[j] = arr[j - gap];
+            st->moves++;
+            j -= gap;
+        } else {
+            break;
+        }
+    }
+    arr[j] = temp;
+    st->moves++;
+    return j;
+}
+
+#endif /* SHELLSORT_INTERNAL_H */
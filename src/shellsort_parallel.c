@@ -0,0 +1,96 @@
+/*
+ * shellsort_parallel.c - Multithreaded Shellsort of a single array
+ *
+ * A pass with gap g is g independent chains (c, c+g, c+2g, ...), so a
+ * large-gap pass can be split by chain with no synchronization inside the
+ * pass. Each task is a block of adjacent chains sorted to completion row
+ * by row, as in shellsort_blocked.c, so a thread streams through
+ * contiguous runs of its block instead of striding across the whole row.
+ * Blocks are whole multiples of a cache line of int32, so two threads only
+ * share a line where a row's alignment splits one.
+ *
+ * Once the gap is too small to give every thread a block of at least
+ * SHELLSORT_PARALLEL_MIN_CHAINS chains (and for arrays under
+ * SHELLSORT_PARALLEL_MIN_N) the pass runs serially on the calling thread.
+ * There is no merge-based finish: every pass is still the gapped insertion
+ * pass, and each chain sees its insertions in the same order, so the
+ * sorted result, comparisons and moves equal shellsort_stats().
+ */
+
+#include "shellsort.h"
+#include "shellsort_internal.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Block sizes are rounded to one 64-byte cache line of int32 */
+#define LINE_CHAINS 16
+
+/* Aim for this many blocks per thread so uneven chains balance out */
+#define TASKS_PER_THREAD 4
+
+/* Chains c0..c1-1 of one pass, rows top to bottom */
+static void sort_chains(int32_t *arr, size_t n, size_t gap, size_t c0, size_t c1,
+                        sort_stats_t *st) {
+    for (size_t base = gap; base + c0 < n; base += gap) {
+        size_t end = base + c1 < n ? base + c1 : n;
+        for (size_t i = base + c0; i < end; i++) {
+            shellsort_insert_counted(arr, i, gap, st);
+        }
+    }
+}
+
+/* Chains per block for a pass of gap on threads threads (0 = run serially) */
+static size_t block_chains(size_t gap, int threads) {
+    if (threads < 2 || gap < 2 * (size_t)SHELLSORT_PARALLEL_MIN_CHAINS) return 0;
+
+    size_t block = gap / ((size_t)threads * TASKS_PER_THREAD);
+    if (block < SHELLSORT_PARALLEL_MIN_CHAINS) block = SHELLSORT_PARALLEL_MIN_CHAINS;
+    block = (block + LINE_CHAINS - 1) / LINE_CHAINS * LINE_CHAINS;
+    return block < gap ? block : 0;
+}
+
+sort_stats_t shellsort_parallel_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                                      int threads) {
+    sort_stats_t stats = {0, 0};
+#ifndef _OPENMP
+    threads = 1;
+#endif
+    if (n < SHELLSORT_PARALLEL_MIN_N) threads = 1;
+
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        size_t block = block_chains(gap, threads);
+        if (block == 0) {
+            sort_chains(arr, n, gap, 0, gap, &stats);
+            continue;
+        }
+
+        size_t tasks = (gap + block - 1) / block;
+        int team = tasks < (size_t)threads ? (int)tasks : threads;
+        uint64_t comparisons = 0, moves = 0;
+
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(team) \
+            reduction(+:comparisons, moves)
+        for (size_t k = 0; k < tasks; k++) {
+            size_t c0 = k * block;
+            size_t c1 = c0 + block < gap ? c0 + block : gap;
+            sort_stats_t st = {0, 0};
+            sort_chains(arr, n, gap, c0, c1, &st);
+            comparisons += st.comparisons;
+            moves += st.moves;
+        }
+
+        stats.comparisons += comparisons;
+        stats.moves += moves;
+    }
+
+    return stats;
+}
+
+uint64_t shellsort_parallel(int32_t *arr, size_t n, const gap_sequence_t *seq, int threads) {
+    return shellsort_parallel_stats(arr, n, seq, threads).comparisons;
+}
@@ -0,0 +1,101 @@
+#define _GNU_SOURCE
+/*
+ * shellsort_passes.c - Per-pass instrumentation (comparisons, moves, time,
+ * hardware counters) for explaining where a gap sequence spends its work
+ */
+
+#include "shellsort.h"
+#include "shellsort_internal.h"
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t pass_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#ifdef __linux__
+static int perf_open(uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+int perf_counters_open(perf_counters_t *pc) {
+    pc->cache_fd = -1;
+    pc->branch_fd = -1;
+#ifdef __linux__
+    pc->cache_fd = perf_open(PERF_COUNT_HW_CACHE_MISSES);
+    pc->branch_fd = perf_open(PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    return (pc->cache_fd >= 0) + (pc->branch_fd >= 0);
+}
+
+void perf_counters_close(perf_counters_t *pc) {
+    if (pc->cache_fd >= 0) close(pc->cache_fd);
+    if (pc->branch_fd >= 0) close(pc->branch_fd);
+    pc->cache_fd = -1;
+    pc->branch_fd = -1;
+}
+
+static uint64_t perf_read(int fd) {
+    uint64_t v = 0;
+    if (fd >= 0 && read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) v = 0;
+    return v;
+}
+
+size_t shellsort_pass_stats(int32_t *arr, size_t n, const gap_sequence_t *seq,
+                            pass_stats_t *passes, const perf_counters_t *perf) {
+    size_t num = 0;
+
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        uint64_t gap = seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        pass_stats_t *p = &passes[num++];
+        memset(p, 0, sizeof(*p));
+        p->gap = gap;
+
+        uint64_t cache0 = perf ? perf_read(perf->cache_fd) : 0;
+        uint64_t branch0 = perf ? perf_read(perf->branch_fd) : 0;
+        uint64_t t0 = pass_clock();
+
+        sort_stats_t st = {0, 0};
+        for (size_t i = gap; i < n; i++) {
+            size_t j = shellsort_insert_counted(arr, i, gap, &st);
+            if (i - j > p->max_displacement) p->max_displacement = i - j;
+        }
+
+        p->cycles = pass_clock() - t0;
+        p->comparisons = st.comparisons;
+        p->moves = st.moves;
+        if (perf) {
+            p->cache_misses = perf_read(perf->cache_fd) - cache0;
+            p->branch_misses = perf_read(perf->branch_fd) - branch0;
+        }
+    }
+
+    return num;
+}
@@ -0,0 +1,283 @@
+/*
+ * shellsort_simd.c - Vectorized multi-chain kernel for large gap passes
+ *
+ * For gap >= W, elements i..i+W-1 belong to W different chains. One vector
+ * holds those W values and walks them down their chains in lock-step: every
+ * step loads arr[j-gap..j-gap+W-1], compares against the W values, shifts
+ * lanes that are still moving and places lanes that stopped. Per-lane
+ * branches become masks.
+ *
+ * Counting stays exact: each step adds popcount(active lanes) comparisons,
+ * which is what the scalar loop would count for those W insertions, so the
+ * totals match shellsort_stats() bit for bit.
+ *
+ * shellsort_batch_stats() reuses the same step for many short arrays: a
+ * group of equal-length arrays is interleaved so each lane sorts a
+ * different array (see batch_lanes()).
+ *
+ * Backends: AVX-512F (16 lanes), AVX2 (8 lanes), AArch64 NEON (4 lanes),
+ * otherwise the scalar counting loop. Selection is at compile time
+ * (-march=native picks the widest available).
+ */
+
+#include "shellsort.h"
+#include "shellsort_internal.h"
+#include <stdlib.h>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define SIMD_LANES 16
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_LANES 8
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD_LANES 4
+#else
+#define SIMD_LANES 1
+#endif
+
+#if SIMD_LANES > 1
+
+/*
+ * Finish lanes that are still moving once lane 0 has reached the bottom of
+ * its chain (j < gap). Lane l sits at j + l and may still have room, so it
+ * continues with the scalar loop; this runs at most once per vector.
+ */
+static inline void finish_lanes(int32_t *arr, size_t j, size_t gap, unsigned active,
+                                const int32_t *vals, sort_stats_t *st) {
+    for (int l = 0; l < SIMD_LANES; l++) {
+        if (!(active & (1u << l))) continue;
+
+        int32_t temp = vals[l];
+        size_t p = j + (size_t)l;
+        while (p >= gap) {
+            st->comparisons++;
+            if (arr[p - gap] > temp) {
+                arr[p] = arr[p - gap];
+                st->moves++;
+                p -= gap;
+            } else {
+                break;
+            }
+        }
+        arr[p] = temp;
+    }
+}
+
+/* Insert arr[i..i+SIMD_LANES-1] into their chains in lock-step. Requires i >= gap. */
+static inline void insert_lanes(int32_t *arr, size_t i, size_t gap, sort_stats_t *st) {
+    size_t j = i;
+    int32_t vals[SIMD_LANES];
+
+#if defined(__AVX512F__)
+    __m512i v = _mm512_loadu_si512((const void *)(arr + i));
+    __mmask16 active = 0xFFFF;
+    for (;;) {
+        __m512i prev = _mm512_loadu_si512((const void *)(arr + j - gap));
+        __mmask16 gt = _mm512_mask_cmpgt_epi32_mask(active, prev, v);
+        st->comparisons += (uint64_t)__builtin_popcount(active);
+        st->moves += (uint64_t)__builtin_popcount(gt);
+        _mm512_mask_storeu_epi32(arr + j, gt, prev);
+        _mm512_mask_storeu_epi32(arr + j, active & ~gt, v);
+        active = gt;
+        if (!active) break;
+        j -= gap;
+        if (j < gap) {
+            _mm512_storeu_si512((void *)vals, v);
+            finish_lanes(arr, j, gap, (unsigned)active, vals, st);
+            break;
+        }
+    }
+#elif defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i *)(arr + i));
+    __m256i active = _mm256_set1_epi32(-1);
+    unsigned bits = 0xFF;
+    for (;;) {
+        __m256i prev = _mm256_loadu_si256((const __m256i *)(arr + j - gap));
+        __m256i gt = _mm256_and_si256(_mm256_cmpgt_epi32(prev, v), active);
+        __m256i done = _mm256_andnot_si256(gt, active);
+        unsigned gt_bits = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(gt));
+        st->comparisons += (uint64_t)__builtin_popcount(bits);
+        st->moves += (uint64_t)__builtin_popcount(gt_bits);
+        _mm256_maskstore_epi32(arr + j, gt, prev);
+        _mm256_maskstore_epi32(arr + j, done, v);
+        active = gt;
+        bits = gt_bits;
+        if (!bits) break;
+        j -= gap;
+        if (j < gap) {
+            _mm256_storeu_si256((__m256i *)vals, v);
+            finish_lanes(arr, j, gap, bits, vals, st);
+            break;
+        }
+    }
+#else /* AArch64 NEON */
+    int32x4_t v = vld1q_s32(arr + i);
+    uint32x4_t active = vdupq_n_u32(0xFFFFFFFFu);
+    for (;;) {
+        int32x4_t prev = vld1q_s32(arr + j - gap);
+        uint32x4_t gt = vandq_u32(vcgtq_s32(prev, v), active);
+        uint32x4_t done = vbicq_u32(active, gt);
+        st->comparisons += vaddvq_u32(vshrq_n_u32(active, 31));
+        st->moves += vaddvq_u32(vshrq_n_u32(gt, 31));
+        /* Lanes are this call's own chains, so rewriting inactive lanes is safe */
+        int32x4_t cur = vld1q_s32(arr + j);
+        cur = vbslq_s32(gt, prev, cur);
+        cur = vbslq_s32(done, v, cur);
+        vst1q_s32(arr + j, cur);
+        active = gt;
+        if (vmaxvq_u32(active) == 0) break;
+        j -= gap;
+        if (j < gap) {
+            uint32_t mask[SIMD_LANES];
+            unsigned bits = 0;
+            vst1q_s32(vals, v);
+            vst1q_u32(mask, active);
+            for (int l = 0; l < SIMD_LANES; l++) {
+                if (mask[l]) bits |= 1u << l;
+            }
+            finish_lanes(arr, j, gap, bits, vals, st);
+            break;
+        }
+    }
+#endif
+
+    /* Each lane ends with one placement (shifts were counted as they happened) */
+    st->moves += SIMD_LANES;
+}
+
+#endif /* SIMD_LANES > 1 */
+
+sort_stats_t shellsort_simd_stats(int32_t *arr, size_t n, const gap_sequence_t *seq) {
+    sort_stats_t stats = {0, 0};
+
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        size_t i = gap;
+#if SIMD_LANES > 1
+        if (gap >= SHELLSORT_SIMD_MIN_GAP && gap >= SIMD_LANES) {
+            for (; i + SIMD_LANES <= n; i += SIMD_LANES) {
+                insert_lanes(arr, i, gap, &stats);
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            shellsort_insert_counted(arr, i, gap, &stats);
+        }
+    }
+
+    return stats;
+}
+
+uint64_t shellsort_simd(int32_t *arr, size_t n, const gap_sequence_t *seq) {
+    return shellsort_simd_stats(arr, n, seq).comparisons;
+}
+
+/* Number of passes of seq that apply to n elements (gaps < n) */
+static inline size_t active_gaps(size_t n, const gap_sequence_t *seq) {
+    size_t top = seq->num_gaps;
+    while (top > 0 && seq->gaps[top - 1] >= n) top--;
+    return top;
+}
+
+/* One array of a batch with the scalar counting loop */
+static void batch_scalar(int32_t *arr, size_t n, const gap_sequence_t *seq, size_t top,
+                         sort_stats_t *st) {
+    for (size_t g = top; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        for (size_t i = gap; i < n; i++) {
+            shellsort_insert_counted(arr, i, gap, st);
+        }
+    }
+}
+
+#if SIMD_LANES > 1
+/*
+ * SIMD_LANES arrays of length n, interleaved in buf (element i of array l
+ * at buf[i * SIMD_LANES + l]). A gap-g pass over every array is a pass of
+ * gap g * SIMD_LANES over buf that only visits rows i * SIMD_LANES, so
+ * insert_lanes() moves one element of each array per step. Every lane
+ * reaches the bottom of its chain on the same step, so finish_lanes()
+ * never has work left.
+ */
+static void batch_lanes(int32_t *const *arrays, size_t n, const gap_sequence_t *seq,
+                        size_t top, int32_t *buf, sort_stats_t *st) {
+    for (size_t i = 0; i < n; i++) {
+        for (int l = 0; l < SIMD_LANES; l++) buf[i * SIMD_LANES + l] = arrays[l][i];
+    }
+
+    for (size_t g = top; g > 0; g--) {
+        size_t gap = (size_t)seq->gaps[g - 1];
+        for (size_t i = gap; i < n; i++) {
+            insert_lanes(buf, i * SIMD_LANES, gap * SIMD_LANES, st);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        for (int l = 0; l < SIMD_LANES; l++) arrays[l][i] = buf[i * SIMD_LANES + l];
+    }
+}
+
+/* 1 if arrays k..k+SIMD_LANES-1 exist and share one length */
+static int lane_group(const size_t *lengths, size_t count, size_t k) {
+    if (count - k < SIMD_LANES) return 0;
+    for (int l = 1; l < SIMD_LANES; l++) {
+        if (lengths[k + l] != lengths[k]) return 0;
+    }
+    return 1;
+}
+#endif
+
+sort_stats_t shellsort_batch_stats(int32_t *const *arrays, const size_t *lengths, size_t count,
+                                   const gap_sequence_t *seq) {
+    sort_stats_t stats = {0, 0};
+    size_t k = 0;
+
+#if SIMD_LANES > 1
+    size_t max_len = 0;
+    for (size_t a = 0; a < count; a++) {
+        if (lengths[a] > max_len) max_len = lengths[a];
+    }
+
+    /* Without the interleave buffer every array takes the scalar path */
+    int32_t *buf = NULL;
+    if (count >= SIMD_LANES && max_len > 1) {
+        buf = malloc(max_len * SIMD_LANES * sizeof(int32_t));
+    }
+    size_t top = 0, top_len = 0;
+
+    while (k < count) {
+        size_t n = lengths[k];
+        if (n != top_len) {
+            top = active_gaps(n, seq);
+            top_len = n;
+        }
+        if (buf && n > 1 && lane_group(lengths, count, k)) {
+            batch_lanes(arrays + k, n, seq, top, buf, &stats);
+            k += SIMD_LANES;
+        } else {
+            batch_scalar(arrays[k], n, seq, top, &stats);
+            k++;
+        }
+    }
+    free(buf);
+#else
+    for (; k < count; k++) {
+        batch_scalar(arrays[k], lengths[k], seq, active_gaps(lengths[k], seq), &stats);
+    }
+#endif
+
+    return stats;
+}
+
+uint64_t shellsort_batch(int32_t *const *arrays, const size_t *lengths, size_t count,
+                         const gap_sequence_t *seq) {
+    return shellsort_batch_stats(arrays, lengths, count, seq).comparisons;
+}
+
+int shellsort_simd_lanes(void) {
+    return SIMD_LANES;
+}
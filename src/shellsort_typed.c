@@ -0,0 +1,89 @@
+/*
+ * shellsort_typed.c - Shellsort kernels for non-int32 element types
+ *
+ * Each kernel is stamped out from the same counted loop as shellsort_stats();
+ * KEY(x) names the value that is compared.
+ */
+
+#include "shellsort.h"
+
+#define KEY_SELF(x) (x)
+#define KEY_KV(x) ((x).key)
+
+#define DEFINE_TYPED_SHELLSORT(suffix, T, KEY)                                  \
+    sort_stats_t shellsort_##suffix##_stats(T *arr, size_t n,                   \
+                                            const gap_sequence_t *seq) {        \
+        sort_stats_t stats = {0, 0};                                            \
+        for (size_t g = seq->num_gaps; g > 0; g--) {                            \
+            uint64_t gap = seq->gaps[g - 1];                                    \
+            if (gap >= n) continue;                                             \
+            for (size_t i = gap; i < n; i++) {                                  \
+                T temp = arr[i];                                                \
+                size_t j = i;                                                   \
+                while (j >= gap) {                                              \
+                    stats.comparisons++;                                        \
+                    if (KEY(arr[j - gap]) > KEY(temp)) {                        \
+                        arr[j] = arr[j - gap];                                  \
+                        stats.moves++;                                          \
+                        j -= gap;                                               \
+                    } else {                                                    \
+                        break;                                                  \
+                    }                                                           \
+                }                                                               \
+                arr[j] = temp;                                                  \
+                stats.moves++;                                                  \
+            }                                                                   \
+        }                                                                       \
+        return stats;                                                           \
+    }                                                                           \
+    uint64_t shellsort_##suffix(T *arr, size_t n, const gap_sequence_t *seq) {  \
+        return shellsort_##suffix##_stats(arr, n, seq).comparisons;             \
+    }
+
+DEFINE_TYPED_SHELLSORT(i64, int64_t, KEY_SELF)
+DEFINE_TYPED_SHELLSORT(u32, uint32_t, KEY_SELF)
+DEFINE_TYPED_SHELLSORT(f32, float, KEY_SELF)
+DEFINE_TYPED_SHELLSORT(f64, double, KEY_SELF)
+DEFINE_TYPED_SHELLSORT(kv, kv_pair_t, KEY_KV)
+
+sort_stats_t shellsort_kv_soa_stats(int64_t *keys, uint64_t *values, size_t n,
+                                    const gap_sequence_t *seq) {
+    sort_stats_t stats = {0, 0};
+
+    for (size_t g = seq->num_gaps; g > 0; g--) {
+        uint64_t gap = seq->gaps[g - 1];
+        if (gap >= n) continue;
+
+        for (size_t i = gap; i < n; i++) {
+            int64_t key = keys[i];
+            size_t j = i;
+
+            /* Walk and shift the keys only */
+            while (j >= gap) {
+                stats.comparisons++;
+                if (keys[j - gap] > key) {
+                    keys[j] = keys[j - gap];
+                    stats.moves++;
+                    j -= gap;
+                } else {
+                    break;
+                }
+            }
+            keys[j] = key;
+            stats.moves++;
+
+            /* Then move the values along the same slots, once, if it moved at all */
+            if (j != i) {
+                uint64_t value = values[i];
+                for (size_t k = i; k != j; k -= gap) values[k] = values[k - gap];
+                values[j] = value;
+            }
+        }
+    }
+
+    return stats;
+}
+
+uint64_t shellsort_kv_soa(int64_t *keys, uint64_t *values, size_t n, const gap_sequence_t *seq) {
+    return shellsort_kv_soa_stats(keys, values, n, seq).comparisons;
+}
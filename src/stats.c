@@ -0,0 +1,178 @@
+/*
+ * stats.c - Welford accumulator, paired t-test and robust summaries
+ */
+
+#include "stats.h"
+#include "rng.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void welford_init(welford_t *w) {
+    w->n = 0;
+    w->mean = 0.0;
+    w->m2 = 0.0;
+    w->min = 0.0;
+    w->max = 0.0;
+}
+
+void welford_add(welford_t *w, double x) {
+    w->n++;
+    if (w->n == 1) {
+        w->min = x;
+        w->max = x;
+    } else {
+        if (x < w->min) w->min = x;
+        if (x > w->max) w->max = x;
+    }
+
+    double delta = x - w->mean;
+    w->mean += delta / (double)w->n;
+    w->m2 += delta * (x - w->mean);
+}
+
+void welford_merge(welford_t *a, const welford_t *b) {
+    if (b->n == 0) return;
+    if (a->n == 0) {
+        *a = *b;
+        return;
+    }
+
+    uint64_t n = a->n + b->n;
+    double delta = b->mean - a->mean;
+    a->m2 += b->m2 + delta * delta * ((double)a->n * (double)b->n / (double)n);
+    a->mean += delta * ((double)b->n / (double)n);
+    if (b->min < a->min) a->min = b->min;
+    if (b->max > a->max) a->max = b->max;
+    a->n = n;
+}
+
+double welford_variance(const welford_t *w) {
+    if (w->n < 2) return 0.0;
+    return w->m2 / (double)(w->n - 1);
+}
+
+double welford_stddev(const welford_t *w) {
+    return sqrt(welford_variance(w));
+}
+
+double welford_stderr(const welford_t *w) {
+    if (w->n == 0) return 0.0;
+    return welford_stddev(w) / sqrt((double)w->n);
+}
+
+double stats_t95(uint64_t df) {
+    static const double table[] = {
+        0.0,    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+        2.228,  2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+        2.086,  2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+        2.042
+    };
+    if (df == 0) return INFINITY;
+    if (df <= 30) return table[df];
+    return 1.96;
+}
+
+paired_result_t paired_test_welford(const welford_t *diffs) {
+    paired_result_t r;
+    r.n = diffs->n;
+    r.mean_diff = diffs->mean;
+    r.stddev_diff = welford_stddev(diffs);
+
+    double se = welford_stderr(diffs);
+    if (se > 0.0) {
+        r.t_stat = r.mean_diff / se;
+    } else {
+        /* Identical pairs give t = 0; a constant nonzero shift is infinitely significant */
+        r.t_stat = (r.mean_diff == 0.0) ? 0.0 : copysign(INFINITY, r.mean_diff);
+    }
+
+    /* Approximate p-value using normal approximation for large n */
+    double z = fabs(r.t_stat);
+    r.p_value = isinf(z) ? 0.0 : erfc(z / sqrt(2.0));
+    return r;
+}
+
+paired_result_t paired_test_u64(const uint64_t *a, const uint64_t *b, uint64_t n) {
+    welford_t w;
+    welford_init(&w);
+    for (uint64_t i = 0; i < n; i++) {
+        welford_add(&w, (double)a[i] - (double)b[i]);
+    }
+    return paired_test_welford(&w);
+}
+
+paired_result_t paired_test_f64(const double *a, const double *b, uint64_t n) {
+    welford_t w;
+    welford_init(&w);
+    for (uint64_t i = 0; i < n; i++) {
+        welford_add(&w, a[i] - b[i]);
+    }
+    return paired_test_welford(&w);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Median of a sorted array */
+static double sorted_median(const double *s, uint64_t n) {
+    return (n & 1) ? s[n / 2] : 0.5 * (s[n / 2 - 1] + s[n / 2]);
+}
+
+int stats_median(const double *x, uint64_t n, double *median) {
+    *median = 0.0;
+    if (n == 0) return 0;
+    double *s = malloc(n * sizeof(double));
+    if (!s) return -1;
+    memcpy(s, x, n * sizeof(double));
+    qsort(s, n, sizeof(double), compare_double);
+    *median = sorted_median(s, n);
+    free(s);
+    return 0;
+}
+
+int stats_mad(const double *x, uint64_t n, double *mad) {
+    *mad = 0.0;
+    if (n == 0) return 0;
+    double med;
+    double *dev = malloc(n * sizeof(double));
+    if (!dev || stats_median(x, n, &med) < 0) {
+        free(dev);
+        return -1;
+    }
+    for (uint64_t i = 0; i < n; i++) dev[i] = fabs(x[i] - med);
+    int rc = stats_median(dev, n, mad);
+    free(dev);
+    return rc;
+}
+
+int stats_bootstrap_median_ci(const double *x, uint64_t n, uint64_t resamples, uint64_t seed,
+                              double *lo, double *hi) {
+    *lo = *hi = 0.0;
+    if (n == 0 || resamples == 0) return 0;
+    double *sample = malloc(n * sizeof(double));
+    double *medians = malloc(resamples * sizeof(double));
+    if (!sample || !medians) {
+        free(sample);
+        free(medians);
+        return -1;
+    }
+
+    rng_state_t rng;
+    rng_seed(&rng, seed);
+    for (uint64_t r = 0; r < resamples; r++) {
+        for (uint64_t i = 0; i < n; i++) sample[i] = x[rng_uniform(&rng, n)];
+        qsort(sample, n, sizeof(double), compare_double);
+        medians[r] = sorted_median(sample, n);
+    }
+    qsort(medians, resamples, sizeof(double), compare_double);
+
+    /* 2.5th and 97.5th percentiles of the bootstrap medians */
+    *lo = medians[(uint64_t)(0.025 * (double)(resamples - 1) + 0.5)];
+    *hi = medians[(uint64_t)(0.975 * (double)(resamples - 1) + 0.5)];
+    free(sample);
+    free(medians);
+    return 0;
+}
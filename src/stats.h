@@ -0,0 +1,76 @@
+/*
+ * stats.h - Shared statistics for the benchmark tools
+ *
+ * Variance convention: all stddev/stderr values are SAMPLE statistics
+ * (divide by n-1), matching the paired t-test. With n < 2 they are 0.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+
+/* Streaming mean/variance accumulator (Welford's algorithm) */
+typedef struct {
+    uint64_t n;
+    double mean;
+    double m2;               /* Sum of squared deviations from the mean */
+    double min;
+    double max;
+} welford_t;
+
+void welford_init(welford_t *w);
+void welford_add(welford_t *w, double x);
+
+/* Merge accumulator b into a (Chan et al. parallel update) */
+void welford_merge(welford_t *a, const welford_t *b);
+
+double welford_variance(const welford_t *w);
+double welford_stddev(const welford_t *w);
+double welford_stderr(const welford_t *w);
+
+/*
+ * Two-sided critical t value for a 95% confidence interval with df degrees
+ * of freedom (table for small df, 1.96 above 30).
+ */
+double stats_t95(uint64_t df);
+
+/* Result of a paired t-test on a - b */
+typedef struct {
+    uint64_t n;              /* Number of pairs */
+    double mean_diff;        /* Mean of (a - b) */
+    double stddev_diff;      /* Sample stddev of (a - b) */
+    double t_stat;           /* mean_diff / stderr */
+    double p_value;          /* Two-sided, normal approximation */
+} paired_result_t;
+
+/*
+ * Paired t-test from an accumulator fed with per-pair differences.
+ * Lets callers run the test incrementally as pairs arrive.
+ */
+paired_result_t paired_test_welford(const welford_t *diffs);
+
+/* Paired t-test on the first n entries of a and b */
+paired_result_t paired_test_u64(const uint64_t *a, const uint64_t *b, uint64_t n);
+paired_result_t paired_test_f64(const double *a, const double *b, uint64_t n);
+
+/*
+ * Outlier-robust summaries for runtime samples. None of them modify x;
+ * they return 0 for n == 0 and return -1 only on allocation failure.
+ */
+
+/* Median of x[0..n) (mean of the middle two for even n) */
+int stats_median(const double *x, uint64_t n, double *median);
+
+/* Median absolute deviation from the median, unscaled */
+int stats_mad(const double *x, uint64_t n, double *mad);
+
+/*
+ * Percentile bootstrap 95% confidence interval of the median: `resamples`
+ * resamples of size n drawn with replacement from a generator seeded with
+ * seed (same inputs, same interval).
+ */
+int stats_bootstrap_median_ci(const double *x, uint64_t n, uint64_t resamples, uint64_t seed,
+                              double *lo, double *hi);
+
+#endif /* STATS_H */
@@ -0,0 +1,346 @@
+#define _GNU_SOURCE
+/*
+ * telemetry.c - Background publisher for the telemetry.h counters
+ */
+
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+struct telemetry {
+    telemetry_slot_t *slots;
+    int threads;
+    double interval;
+    char path[1024];
+    char tool[64];
+    int prometheus;              /* 1: path ends in .prom */
+    atomic_uint_fast64_t expected;
+    atomic_uint_fast64_t expected_work;
+
+    pthread_t publisher;
+    pthread_mutex_t lock;        /* Guards the phase fields and stopping, and wakes the publisher */
+    pthread_cond_t wake;
+    int stopping;
+    char phase[128];
+    uint64_t phase_ns;           /* When the phase was set, and the work done by then */
+    uint64_t phase_work;
+
+    /* Publisher-only state: the previous sample */
+    uint64_t start_ns;
+    uint64_t prev_ns;
+    uint64_t prev_sorts, prev_comparisons, prev_bytes;
+    uint64_t *prev_busy;
+};
+
+typedef struct {
+    uint64_t trials, sorts, comparisons, bytes, work;
+} totals_t;
+
+/* Work finished over all slots */
+static uint64_t total_work(telemetry_t *t) {
+    uint64_t work = 0;
+    for (int k = 0; k < t->threads; k++) {
+        work += atomic_load_explicit(&t->slots[k].work, memory_order_relaxed);
+    }
+    return work;
+}
+
+/* Busy time of a slot up to now, including a task still open */
+static uint64_t slot_busy(telemetry_slot_t *s, uint64_t now) {
+    uint64_t busy = atomic_load_explicit(&s->busy_ns, memory_order_relaxed);
+    uint64_t start = atomic_load_explicit(&s->started_ns, memory_order_relaxed);
+    if (start && start < now) busy += now - start;
+    return busy;
+}
+
+static void format_duration(double seconds, char *buf, size_t len) {
+    if (seconds < 0) {
+        snprintf(buf, len, "unknown");
+        return;
+    }
+    uint64_t s = (uint64_t)(seconds + 0.5);
+    snprintf(buf, len, "%luh%02lum%02lus", (unsigned long)(s / 3600),
+             (unsigned long)(s / 60 % 60), (unsigned long)(s % 60));
+}
+
+static void publish(telemetry_t *t) {
+    uint64_t now = telemetry_now_ns();
+    totals_t tot = {0, 0, 0, 0, 0};
+    uint64_t *busy = malloc((size_t)t->threads * sizeof(uint64_t));
+    uint64_t *trials = malloc((size_t)t->threads * sizeof(uint64_t));
+    double *util = malloc((size_t)t->threads * sizeof(double));
+    if (!busy || !trials || !util) {
+        free(busy);
+        free(trials);
+        free(util);
+        return;  /* Status is best effort */
+    }
+
+    for (int k = 0; k < t->threads; k++) {
+        telemetry_slot_t *s = &t->slots[k];
+        trials[k] = atomic_load_explicit(&s->trials, memory_order_relaxed);
+        tot.trials += trials[k];
+        tot.sorts += atomic_load_explicit(&s->sorts, memory_order_relaxed);
+        tot.comparisons += atomic_load_explicit(&s->comparisons, memory_order_relaxed);
+        tot.bytes += atomic_load_explicit(&s->bytes, memory_order_relaxed);
+        tot.work += atomic_load_explicit(&s->work, memory_order_relaxed);
+        busy[k] = slot_busy(s, now);
+    }
+
+    double dt = (double)(now - t->prev_ns) * 1e-9;
+    double elapsed = (double)(now - t->start_ns) * 1e-9;
+    double sort_rate = dt > 0 ? (double)(tot.sorts - t->prev_sorts) / dt : 0;
+    double comp_rate = dt > 0 ? (double)(tot.comparisons - t->prev_comparisons) / dt : 0;
+    double byte_rate = dt > 0 ? (double)(tot.bytes - t->prev_bytes) / dt : 0;
+
+    double util_min = 1, util_max = 0, util_sum = 0;
+    for (int k = 0; k < t->threads; k++) {
+        /* Reads race with telemetry_end(), so one sample can be off by a task */
+        double u = dt > 0 && busy[k] > t->prev_busy[k]
+                       ? (double)(busy[k] - t->prev_busy[k]) * 1e-9 / dt : 0;
+        if (u > 1) u = 1;
+        util[k] = u;
+        util_sum += u;
+        if (u < util_min) util_min = u;
+        if (u > util_max) util_max = u;
+    }
+    double util_mean = t->threads > 0 ? util_sum / t->threads : 0;
+
+    char phase[128];
+    pthread_mutex_lock(&t->lock);
+    memcpy(phase, t->phase, sizeof(phase));
+    uint64_t phase_ns = t->phase_ns, phase_work = t->phase_work;
+    pthread_mutex_unlock(&t->lock);
+
+    /* Work rate of the current phase, or of the whole run until the phase has some */
+    uint64_t expected = atomic_load_explicit(&t->expected, memory_order_relaxed);
+    uint64_t expected_work = atomic_load_explicit(&t->expected_work, memory_order_relaxed);
+    double phase_dt = phase_ns && now > phase_ns ? (double)(now - phase_ns) * 1e-9 : 0;
+    double work_rate = 0;
+    if (phase_dt > 0 && tot.work > phase_work) {
+        work_rate = (double)(tot.work - phase_work) / phase_dt;
+    } else if (elapsed > 0) {
+        work_rate = (double)tot.work / elapsed;
+    }
+    double eta = -1;
+    if (expected_work > 0 && work_rate > 0) {
+        uint64_t left = expected_work > tot.work ? expected_work - tot.work : 0;
+        eta = (double)left / work_rate;
+    }
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", t->path);
+    FILE *f = fopen(tmp, "w");
+    if (f && t->prometheus) {
+        const char *l = t->tool;
+        fprintf(f, "# HELP shellsort_sorts_total Sorts finished\n");
+        fprintf(f, "# TYPE shellsort_sorts_total counter\n");
+        fprintf(f, "shellsort_sorts_total{tool=\"%s\"} %lu\n", l, (unsigned long)tot.sorts);
+        fprintf(f, "# HELP shellsort_sorts_expected Sorts announced so far\n");
+        fprintf(f, "# TYPE shellsort_sorts_expected gauge\n");
+        fprintf(f, "shellsort_sorts_expected{tool=\"%s\"} %lu\n", l, (unsigned long)expected);
+        fprintf(f, "# HELP shellsort_trials_total Distinct trials loaded\n");
+        fprintf(f, "# TYPE shellsort_trials_total counter\n");
+        fprintf(f, "shellsort_trials_total{tool=\"%s\"} %lu\n", l, (unsigned long)tot.trials);
+        fprintf(f, "# HELP shellsort_comparisons_total Comparisons counted\n");
+        fprintf(f, "# TYPE shellsort_comparisons_total counter\n");
+        fprintf(f, "shellsort_comparisons_total{tool=\"%s\"} %lu\n", l,
+                (unsigned long)tot.comparisons);
+        fprintf(f, "# HELP shellsort_read_bytes_total Dataset file bytes read (0 for generated trials)\n");
+        fprintf(f, "# TYPE shellsort_read_bytes_total counter\n");
+        fprintf(f, "shellsort_read_bytes_total{tool=\"%s\"} %lu\n", l, (unsigned long)tot.bytes);
+        fprintf(f, "# HELP shellsort_sorts_per_second Sort rate over the last interval\n");
+        fprintf(f, "# TYPE shellsort_sorts_per_second gauge\n");
+        fprintf(f, "shellsort_sorts_per_second{tool=\"%s\"} %.3f\n", l, sort_rate);
+        fprintf(f, "# HELP shellsort_comparisons_per_second Comparison rate over the last interval\n");
+        fprintf(f, "# TYPE shellsort_comparisons_per_second gauge\n");
+        fprintf(f, "shellsort_comparisons_per_second{tool=\"%s\"} %.0f\n", l, comp_rate);
+        fprintf(f, "# HELP shellsort_elapsed_seconds Time since the run started\n");
+        fprintf(f, "# TYPE shellsort_elapsed_seconds gauge\n");
+        fprintf(f, "shellsort_elapsed_seconds{tool=\"%s\"} %.1f\n", l, elapsed);
+        fprintf(f, "# HELP shellsort_eta_seconds Estimated time to finish announced work (-1 unknown)\n");
+        fprintf(f, "# TYPE shellsort_eta_seconds gauge\n");
+        fprintf(f, "shellsort_eta_seconds{tool=\"%s\"} %.1f\n", l, eta);
+        fprintf(f, "# HELP shellsort_thread_trials_total Trials loaded per worker thread\n");
+        fprintf(f, "# TYPE shellsort_thread_trials_total counter\n");
+        for (int k = 0; k < t->threads; k++) {
+            fprintf(f, "shellsort_thread_trials_total{tool=\"%s\",thread=\"%d\"} %lu\n", l, k,
+                    (unsigned long)trials[k]);
+        }
+        fprintf(f, "# HELP shellsort_thread_utilization Busy share of the last interval\n");
+        fprintf(f, "# TYPE shellsort_thread_utilization gauge\n");
+        for (int k = 0; k < t->threads; k++) {
+            fprintf(f, "shellsort_thread_utilization{tool=\"%s\",thread=\"%d\"} %.3f\n", l, k,
+                    util[k]);
+        }
+    } else if (f) {
+        char el[32], et[32];
+        format_duration(elapsed, el, sizeof(el));
+        format_duration(eta, et, sizeof(et));
+        fprintf(f, "tool:         %s%s%s\n", t->tool, phase[0] ? "  " : "", phase);
+        fprintf(f, "elapsed:      %s   ETA: %s\n", el, et);
+        if (expected > 0) {
+            fprintf(f, "sorts:        %lu / %lu (%.1f%%, %.2f/s)\n", (unsigned long)tot.sorts,
+                    (unsigned long)expected, 100.0 * (double)tot.sorts / (double)expected,
+                    sort_rate);
+        } else {
+            fprintf(f, "sorts:        %lu (%.2f/s)\n", (unsigned long)tot.sorts, sort_rate);
+        }
+        fprintf(f, "trials:       %lu loaded\n", (unsigned long)tot.trials);
+        fprintf(f, "comparisons:  %.4g (%.4g/s)\n", (double)tot.comparisons, comp_rate);
+        fprintf(f, "read:         %.2f GiB (%.1f MiB/s)\n", (double)tot.bytes / 1073741824.0,
+                byte_rate / 1048576.0);
+        fprintf(f, "utilization:  min %.0f%%  mean %.0f%%  max %.0f%% over %d threads\n",
+                util_min * 100, util_mean * 100, util_max * 100, t->threads);
+        fprintf(f, "thread   trials    util\n");
+        for (int k = 0; k < t->threads; k++) {
+            fprintf(f, "%6d %8lu %6.0f%%%s\n", k, (unsigned long)trials[k], util[k] * 100,
+                    util[k] < 0.5 * util_mean ? "  <- idle" : "");
+        }
+    }
+    if (f) {
+        fclose(f);
+        rename(tmp, t->path);
+    }
+
+    t->prev_ns = now;
+    t->prev_sorts = tot.sorts;
+    t->prev_comparisons = tot.comparisons;
+    t->prev_bytes = tot.bytes;
+    memcpy(t->prev_busy, busy, (size_t)t->threads * sizeof(uint64_t));
+    free(busy);
+    free(trials);
+    free(util);
+}
+
+static void *publisher_main(void *arg) {
+    telemetry_t *t = arg;
+    pthread_mutex_lock(&t->lock);
+    while (!t->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)(t->interval * 1e9);
+        deadline.tv_sec += (time_t)(ns / 1000000000ULL);
+        deadline.tv_nsec = (long)(ns % 1000000000ULL);
+
+        int rc = 0;
+        while (!t->stopping && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&t->wake, &t->lock, &deadline);
+        }
+        if (t->stopping) break;
+
+        pthread_mutex_unlock(&t->lock);
+        publish(t);
+        pthread_mutex_lock(&t->lock);
+    }
+    pthread_mutex_unlock(&t->lock);
+    return NULL;
+}
+
+telemetry_t *telemetry_start(const char *path, const char *tool, int threads, double interval) {
+    if (threads < 1) threads = 1;
+    telemetry_t *t = calloc(1, sizeof(*t));
+    if (!t) {
+        fprintf(stderr, "Error: Out of memory for telemetry\n");
+        return NULL;
+    }
+    t->slots = aligned_alloc(64, (size_t)threads * sizeof(telemetry_slot_t));
+    t->prev_busy = calloc((size_t)threads, sizeof(uint64_t));
+    if (!t->slots || !t->prev_busy) {
+        fprintf(stderr, "Error: Out of memory for telemetry\n");
+        free(t->slots);
+        free(t->prev_busy);
+        free(t);
+        return NULL;
+    }
+    for (int k = 0; k < threads; k++) {
+        telemetry_slot_t *s = &t->slots[k];
+        atomic_init(&s->trials, 0);
+        atomic_init(&s->sorts, 0);
+        atomic_init(&s->comparisons, 0);
+        atomic_init(&s->bytes, 0);
+        atomic_init(&s->work, 0);
+        atomic_init(&s->busy_ns, 0);
+        atomic_init(&s->started_ns, 0);
+    }
+    atomic_init(&t->expected, 0);
+    atomic_init(&t->expected_work, 0);
+
+    t->threads = threads;
+    t->interval = interval > 0 ? interval : TELEMETRY_DEFAULT_INTERVAL;
+    strncpy(t->path, path, sizeof(t->path) - 1);
+    strncpy(t->tool, tool, sizeof(t->tool) - 1);
+    size_t len = strlen(t->path);
+    t->prometheus = len >= 5 && strcmp(t->path + len - 5, ".prom") == 0;
+    t->start_ns = t->prev_ns = telemetry_now_ns();
+
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->wake, NULL);
+    if (pthread_create(&t->publisher, NULL, publisher_main, t) != 0) {
+        fprintf(stderr, "Error: Could not start the telemetry thread\n");
+        pthread_mutex_destroy(&t->lock);
+        pthread_cond_destroy(&t->wake);
+        free(t->slots);
+        free(t->prev_busy);
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void telemetry_stop(telemetry_t *t) {
+    if (!t) return;
+    pthread_mutex_lock(&t->lock);
+    t->stopping = 1;
+    pthread_cond_signal(&t->wake);
+    pthread_mutex_unlock(&t->lock);
+    pthread_join(t->publisher, NULL);
+
+    telemetry_set_phase(t, "done");
+    publish(t);
+
+    pthread_mutex_destroy(&t->lock);
+    pthread_cond_destroy(&t->wake);
+    free(t->slots);
+    free(t->prev_busy);
+    free(t);
+}
+
+void telemetry_expect(telemetry_t *t, uint64_t sorts, uint64_t n) {
+    if (!t) return;
+    atomic_fetch_add_explicit(&t->expected, sorts, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->expected_work, sorts * telemetry_sort_cost(n),
+                              memory_order_relaxed);
+}
+
+void telemetry_revise(telemetry_t *t, uint64_t announced, uint64_t actual, uint64_t n) {
+    if (!t) return;
+    if (actual >= announced) {
+        telemetry_expect(t, actual - announced, n);
+        return;
+    }
+    uint64_t fewer = announced - actual;
+    atomic_fetch_sub_explicit(&t->expected, fewer, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&t->expected_work, fewer * telemetry_sort_cost(n),
+                              memory_order_relaxed);
+}
+
+void telemetry_set_phase(telemetry_t *t, const char *phase) {
+    if (!t) return;
+    uint64_t work = total_work(t);
+    pthread_mutex_lock(&t->lock);
+    snprintf(t->phase, sizeof(t->phase), "%s", phase);
+    t->phase_ns = telemetry_now_ns();
+    t->phase_work = work;
+    pthread_mutex_unlock(&t->lock);
+}
+
+telemetry_slot_t *telemetry_slot(telemetry_t *t, int thread) {
+    if (!t) return NULL;
+    if (thread < 0) thread = 0;
+    return &t->slots[thread % t->threads];
+}
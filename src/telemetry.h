@@ -0,0 +1,128 @@
+/*
+ * telemetry.h - Live progress counters for long benchmark runs
+ *
+ * Every worker thread owns one cache-line-sized slot of counters (trials
+ * loaded, sorts, comparisons, bytes read, work, busy time) and bumps them
+ * with relaxed atomic adds after each task, so workers never take a lock or
+ * share a line, and the cost is a few uncontended adds per sort of
+ * millions of comparisons. A background thread wakes every interval,
+ * reads the slots and rewrites the status file atomically (tmp + rename,
+ * like evolve_live's status.txt):
+ *
+ *   - a one-screen text summary for `watch cat`, or
+ *   - Prometheus text exposition when the path ends in ".prom", for the
+ *     node_exporter textfile collector or any scraper that reads a file.
+ *
+ * Rates cover the last interval. For the ETA every sort of n elements
+ * counts as telemetry_sort_cost(n) ~ n log2 n units of work; the ETA is
+ * the remaining announced work (telemetry_expect()) at the work rate since
+ * the current phase began (telemetry_set_phase()), or since the start
+ * while the phase has finished nothing. Announcing every size up front
+ * thus covers the whole run, and a large-N phase is not extrapolated from
+ * the pace of earlier small-N sorts.
+ * Utilization is the share of the interval each thread spent between
+ * telemetry_begin() and telemetry_end(), counting a task still open at the
+ * sample; a thread far below the others is a straggler or starved. Every
+ * function accepts a NULL telemetry_t or slot and does nothing, so callers
+ * need no branches.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Default seconds between status writes */
+#define TELEMETRY_DEFAULT_INTERVAL 2.0
+
+typedef struct {
+    _Alignas(64) atomic_uint_fast64_t trials;
+    atomic_uint_fast64_t sorts;
+    atomic_uint_fast64_t comparisons;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t work;        /* telemetry_sort_cost() units */
+    atomic_uint_fast64_t busy_ns;     /* Closed tasks */
+    atomic_uint_fast64_t started_ns;  /* Start of the open task, 0 when idle */
+} telemetry_slot_t;
+
+/* Opaque; slots are public so telemetry_begin()/telemetry_end() inline */
+typedef struct telemetry telemetry_t;
+
+/*
+ * Start publishing to path every interval seconds for `threads` worker
+ * slots; tool names the run in the output. Returns NULL (message on
+ * stderr) if the publisher thread or the slots cannot be set up.
+ */
+telemetry_t *telemetry_start(const char *path, const char *tool, int threads, double interval);
+
+/* Write a final status and stop the publisher. Safe with NULL */
+void telemetry_stop(telemetry_t *t);
+
+/* Announce `sorts` more sorts of n elements of upcoming work, for the ETA */
+void telemetry_expect(telemetry_t *t, uint64_t sorts, uint64_t n);
+
+/*
+ * Correct an earlier telemetry_expect() of `announced` sorts of n elements
+ * to `actual` once the real count is known (0 for a size that failed)
+ */
+void telemetry_revise(telemetry_t *t, uint64_t announced, uint64_t actual, uint64_t n);
+
+/* What the run is doing now ("N=8000000 dist=uniform"); copied. Starts the ETA's rate window */
+void telemetry_set_phase(telemetry_t *t, const char *phase);
+
+/* Slot of worker thread `thread` (taken modulo the slot count) */
+telemetry_slot_t *telemetry_slot(telemetry_t *t, int thread);
+
+/* Slot of the calling OpenMP thread (call inside the trial loop) */
+static inline telemetry_slot_t *telemetry_thread_slot(telemetry_t *t) {
+#ifdef _OPENMP
+    return telemetry_slot(t, omp_get_thread_num());
+#else
+    return telemetry_slot(t, 0);
+#endif
+}
+
+/* Work of one sort of n elements: n times the bit length of n (~ n log2 n) */
+static inline uint64_t telemetry_sort_cost(uint64_t n) {
+    return n * (uint64_t)(64 - __builtin_clzll(n | 1));
+}
+
+/* Monotonic nanoseconds, for busy-time stamps around a task */
+static inline uint64_t telemetry_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Mark the start of a task on a slot (NULL slot: no-op) */
+static inline void telemetry_begin(telemetry_slot_t *s) {
+    if (!s) return;
+    atomic_store_explicit(&s->started_ns, telemetry_now_ns(), memory_order_relaxed);
+}
+
+/*
+ * Close the task opened by telemetry_begin() and add its work: `trials`
+ * distinct trials loaded, `sorts` sorts of n elements, and the file bytes
+ * read (dataset_trial_bytes())
+ */
+static inline void telemetry_end(telemetry_slot_t *s, uint64_t trials, uint64_t sorts,
+                                 uint64_t n, uint64_t comparisons, uint64_t bytes) {
+    if (!s) return;
+    uint64_t start = atomic_load_explicit(&s->started_ns, memory_order_relaxed);
+    uint64_t busy = start ? telemetry_now_ns() - start : 0;
+    atomic_store_explicit(&s->started_ns, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->trials, trials, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->sorts, sorts, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->comparisons, comparisons, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->work, sorts * telemetry_sort_cost(n), memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->busy_ns, busy, memory_order_relaxed);
+}
+
+#endif /* TELEMETRY_H */
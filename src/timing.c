@@ -0,0 +1,119 @@
+#define _GNU_SOURCE
+/*
+ * timing.c - TSC calibration, CPU pinning and cpufreq state (timing.h)
+ */
+
+#include "timing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+double timing_wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+double timing_tsc_hz(void) {
+    static double hz = 0.0;
+    if (hz > 0.0) return hz;
+#if defined(__x86_64__) || defined(__i386__)
+    /* Best of three 50 ms windows; a preempted window only reads low */
+    for (int r = 0; r < 3; r++) {
+        double w0 = timing_wall_seconds();
+        uint64_t c0 = timing_begin();
+        while (timing_wall_seconds() - w0 < 0.05) {
+        }
+        uint64_t c1 = timing_end();
+        double w1 = timing_wall_seconds();
+        double est = (double)(c1 - c0) / (w1 - w0);
+        if (est > hz) hz = est;
+    }
+#else
+    hz = 1e9;
+#endif
+    return hz;
+}
+
+int timing_pin_cpu(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+int timing_current_cpu(void) {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+/* First line of a sysfs file into buf, newline stripped; 0 or -1 */
+static int read_line(const char *path, char *buf, size_t len) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fgets(buf, (int)len, f) != NULL;
+    fclose(f);
+    if (!ok) return -1;
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static double read_khz_as_mhz(int cpu, const char *field) {
+    char path[128], buf[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/%s", cpu, field);
+    if (read_line(path, buf, sizeof(buf)) < 0) return 0.0;
+    return strtod(buf, NULL) / 1000.0;
+}
+
+void timing_cpu_state(int cpu, timing_cpu_state_t *st) {
+    memset(st, 0, sizeof(*st));
+    st->turbo = -1;
+    if (cpu < 0) cpu = 0;
+
+    char path[128], buf[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    if (read_line(path, st->governor, sizeof(st->governor)) < 0) st->governor[0] = '\0';
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_driver", cpu);
+    if (read_line(path, st->driver, sizeof(st->driver)) < 0) st->driver[0] = '\0';
+    st->cur_mhz = read_khz_as_mhz(cpu, "scaling_cur_freq");
+    st->min_mhz = read_khz_as_mhz(cpu, "scaling_min_freq");
+    st->max_mhz = read_khz_as_mhz(cpu, "scaling_max_freq");
+
+    if (read_line("/sys/devices/system/cpu/intel_pstate/no_turbo", buf, sizeof(buf)) == 0) {
+        st->turbo = atoi(buf) ? 0 : 1;
+    } else if (read_line("/sys/devices/system/cpu/cpufreq/boost", buf, sizeof(buf)) == 0) {
+        st->turbo = atoi(buf) ? 1 : 0;
+    }
+
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f) {
+        while (fgets(buf, sizeof(buf), f)) {
+            if (strncmp(buf, "model name", 10) == 0) {
+                char *colon = strchr(buf, ':');
+                if (colon) {
+                    colon += strspn(colon + 1, " \t") + 1;
+                    colon[strcspn(colon, "\n")] = '\0';
+                    snprintf(st->model, sizeof(st->model), "%s", colon);
+                }
+                break;
+            }
+        }
+        fclose(f);
+    }
+    if (st->model[0] == '\0') snprintf(st->model, sizeof(st->model), "unknown");
+}
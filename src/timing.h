@@ -0,0 +1,79 @@
+/*
+ * timing.h - Cycle-accurate timing, CPU pinning and CPU state for runtime_bench
+ *
+ * timing_begin()/timing_end() read the timestamp counter with the fences
+ * Intel recommends for short intervals (lfence; rdtsc before, rdtscp;
+ * lfence after), so the sort cannot drift outside the timed window. On
+ * CPUs with an invariant TSC the counter ticks at a constant rate across
+ * frequency changes; timing_tsc_hz() measures that rate against
+ * CLOCK_MONOTONIC to turn ticks into seconds. Without a TSC both read
+ * CLOCK_MONOTONIC in nanoseconds and timing_tsc_hz() returns 1e9.
+ *
+ * The frequency governor and turbo state decide whether the numbers mean
+ * anything, so timing_cpu_state() reads them from sysfs and the tool puts
+ * them in its output; fields that do not exist on a system are left empty
+ * or 0.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+static inline uint64_t timing_begin(void) {
+    _mm_lfence();
+    return __rdtsc();
+}
+
+static inline uint64_t timing_end(void) {
+    unsigned int aux;
+    uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+}
+#else
+#include <time.h>
+
+static inline uint64_t timing_begin(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t timing_end(void) {
+    return timing_begin();
+}
+#endif
+
+/* CLOCK_MONOTONIC in seconds, for wall-clock spans of whole runs */
+double timing_wall_seconds(void);
+
+/* Counter ticks per second of timing_begin()/timing_end(), measured once and cached */
+double timing_tsc_hz(void);
+
+/*
+ * Pin the calling thread to one CPU. Returns 0, or -1 where affinity is
+ * not supported or the CPU is not in the process's allowed set.
+ */
+int timing_pin_cpu(int cpu);
+
+/* CPU the calling thread is running on, or -1 */
+int timing_current_cpu(void);
+
+typedef struct {
+    char model[128];         /* /proc/cpuinfo model name */
+    char governor[32];       /* cpufreq scaling_governor */
+    char driver[32];         /* cpufreq scaling_driver */
+    double cur_mhz;          /* scaling_cur_freq */
+    double min_mhz;          /* scaling_min_freq */
+    double max_mhz;          /* scaling_max_freq */
+    int turbo;               /* 1 on, 0 off, -1 unknown (intel_pstate/no_turbo or cpufreq/boost) */
+} timing_cpu_state_t;
+
+/* Read the state of one CPU; missing fields stay empty / 0 / -1 */
+void timing_cpu_state(int cpu, timing_cpu_state_t *st);
+
+#endif /* TIMING_H */
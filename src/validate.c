@@ -1,6 +1,12 @@
 #define _GNU_SOURCE
 /*
  * validate.c - Validate evolved sequence on holdout sizes
+ *
+ * Usage: ./validate [perms_dir] [threads] [--generate-seed <hex> [--trials T] [--rng-scheme v1|v2]]
+ *                   [--race] [--verify]
+ *
+ * --race runs Evolved against Ciura in paired batches (race.h) and stops each
+ * size as soon as the difference is significant, reporting trials used.
  */
 
 #include <stdio.h>
@@ -17,50 +23,21 @@
 #include "rng.h"
 #include "shellsort.h"
 #include "gaps_baselines.h"
+#include "dataset.h"
+#include "scratch.h"
+#include "race.h"
 
-#define MAGIC 0x5045524D47454E31ULL
-
-typedef struct {
-    uint64_t N;
-    uint64_t trials;
-    int32_t *data;
-} perm_dataset_t;
-
-static int load_dataset(const char *dir, uint64_t N, perm_dataset_t *ds) {
-    char path[1024];
-    snprintf(path, sizeof(path), "%s/perm_%lu.bin", dir, (unsigned long)N);
-    FILE *f = fopen(path, "rb");
-    if (!f) return -1;
-
-    uint64_t magic;
-    fread(&magic, sizeof(magic), 1, f);
-    if (magic != MAGIC) { fclose(f); return -1; }
-
-    fread(&ds->N, sizeof(ds->N), 1, f);
-    fread(&ds->trials, sizeof(ds->trials), 1, f);
-    uint64_t seed;
-    fread(&seed, sizeof(seed), 1, f);
-
-    size_t total = ds->trials * ds->N;
-    ds->data = malloc(total * sizeof(int32_t));
-    if (!ds->data) { fclose(f); return -1; }
-    fread(ds->data, sizeof(int32_t), total, f);
-    fclose(f);
-    return 0;
-}
-
-static double evaluate(const perm_dataset_t *ds, const gap_sequence_t *seq, int threads) {
+static double evaluate(const perm_dataset_t *ds, const gap_sequence_t *seq,
+                       const scratch_pool_t *scratch, int threads) {
     uint64_t N = ds->N;
     uint64_t trials = ds->trials;
     uint64_t total = 0;
 
     #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:total)
     for (uint64_t t = 0; t < trials; t++) {
-        int32_t *arr = malloc(N * sizeof(int32_t));
-        if (!arr) continue;
-        memcpy(arr, &ds->data[t * N], N * sizeof(int32_t));
+        int32_t *arr = scratch_get(scratch);
+        dataset_copy_trial(ds, t, arr);
         total += shellsort(arr, N, seq);
-        free(arr);
     }
     return (double)total / (double)trials;
 }
@@ -69,8 +46,23 @@ int main(int argc, char **argv) {
     const char *perms_dir = "results/perms";
     int threads = 16;
 
+    dataset_source_t source;
+    if (dataset_source_args(&source, &argc, argv) < 0) return 1;
+
+    int race = 0;
+    int npos = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--race") == 0) {
+            race = 1;
+        } else {
+            argv[npos++] = argv[i];
+        }
+    }
+    argc = npos;
+
     if (argc > 1) perms_dir = argv[1];
     if (argc > 2) threads = atoi(argv[2]);
+    source.perms_dir = perms_dir;
 
 #ifdef _OPENMP
     omp_set_num_threads(threads);
@@ -80,8 +72,13 @@ int main(int argc, char **argv) {
     uint64_t sizes[] = {1000000, 2000000, 4000000, 8000000};
     int num_sizes = 4;
 
-    printf("Validating Evolved Sequence on All Sizes (Full Trials)\n");
-    printf("=======================================================\n\n");
+    if (race) {
+        printf("Validating Evolved Sequence on All Sizes (Racing vs Ciura)\n");
+        printf("==========================================================\n\n");
+    } else {
+        printf("Validating Evolved Sequence on All Sizes (Full Trials)\n");
+        printf("=======================================================\n\n");
+    }
 
     printf("%-12s | %-16s | %-16s | %-10s\n", "N", "Ciura", "Evolved", "Diff %");
     printf("-------------|------------------|------------------|------------\n");
@@ -92,28 +89,59 @@ int main(int argc, char **argv) {
         uint64_t N = sizes[i];
 
         perm_dataset_t ds;
-        if (load_dataset(perms_dir, N, &ds) < 0) {
+        if (dataset_open(&source, N, ELEM_I32, &ds) < 0) {
             printf("Failed to load N=%lu\n", (unsigned long)N);
             continue;
         }
 
+        scratch_pool_t scratch;
+        if (scratch_pool_init(&scratch, threads, N * sizeof(int32_t)) < 0) {
+            free_dataset(&ds);
+            continue;
+        }
+
         /* Generate sequences for this N */
         gap_sequence_t ciura, evolved;
         gaps_ciura(&ciura, N);
         gaps_evolved(&evolved, N);
 
-        double ciura_mean = evaluate(&ds, &ciura, threads);
-        double evolved_mean = evaluate(&ds, &evolved, threads);
+        double ciura_mean, evolved_mean;
+        race_result_t rr;
+        if (race) {
+            race_config_t rc;
+            race_reference_t ref;
+            race_config_default(&rc);
+            if (race_reference_init(&ref, &ciura, &ds) < 0 ||
+                race_evaluate(&ref, &evolved, &scratch, &rc, threads, &rr) < 0) {
+                fprintf(stderr, "Error: Out of memory racing N=%lu\n", (unsigned long)N);
+                race_reference_free(&ref);
+                scratch_pool_free(&scratch);
+                free_dataset(&ds);
+                continue;
+            }
+            race_reference_free(&ref);
+            ciura_mean = rr.mean_reference;
+            evolved_mean = rr.mean_candidate;
+        } else {
+            ciura_mean = evaluate(&ds, &ciura, &scratch, threads);
+            evolved_mean = evaluate(&ds, &evolved, &scratch, threads);
+        }
 
         double diff_pct = (ciura_mean - evolved_mean) / ciura_mean * 100.0;
 
         printf("%-12lu | %16.2f | %16.2f | %+9.4f%%\n",
                (unsigned long)N, ciura_mean, evolved_mean, diff_pct);
+        if (race) {
+            printf("%-12s   %s after %lu/%lu trials (p = %.2e)\n", "",
+                   race_verdict_name(rr.verdict), (unsigned long)rr.trials_used,
+                   (unsigned long)ds.trials, rr.test.p_value);
+        }
 
         ciura_total += ciura_mean;
         evolved_total += evolved_mean;
 
-        free(ds.data);
+        scratch_pool_free(&scratch);
+        free_dataset(&ds);
     }
 
     printf("-------------|------------------|------------------|------------\n");